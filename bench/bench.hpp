@@ -0,0 +1,216 @@
+#pragma once
+
+#include <bits/stdc++.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define UTILS_BENCH_RDTSC 1
+#endif
+
+/**
+ * @brief Минимальный харнесс микробенчмарков без внешних зависимостей
+ * @details Бенчмарк объявляется макросом BENCH(Suite, Name) с телом, которое выполняет iterations операций.
+ * Прогон: подбор числа итераций, чтобы замер длился не меньше min_time, несколько прогонов на прогрев,
+ * затем samples замеров. В отчёт идут медиана, p99 и минимум наносекунд на операцию и медиана тактов
+ * на операцию по rdtsc (0, если rdtsc нет). Отчёт - JSON, чтобы прогоны можно было сравнивать diff-ом.
+ */
+namespace bench
+{
+	/**
+	 * @brief Не даём компилятору выбросить вычисление значения
+	 */
+	template<typename T>
+	inline void do_not_optimize(const T& value) noexcept
+	{
+		asm volatile("" : : "r,m"(value) : "memory");
+	}
+
+	template<typename T>
+	inline void do_not_optimize(T& value) noexcept
+	{
+		asm volatile("" : "+m"(value) : : "memory");
+	}
+
+	/**
+	 * @brief Барьер для компилятора: все записи в память считаются наблюдаемыми
+	 */
+	inline void clobber_memory() noexcept
+	{
+		asm volatile("" : : : "memory");
+	}
+
+	/**
+	 * @brief Счётчик тактов процессора или 0, если он недоступен
+	 */
+	inline std::uint64_t cycles() noexcept
+	{
+#if defined(UTILS_BENCH_RDTSC)
+		return __rdtsc();
+#else
+		return 0;
+#endif
+	}
+
+	struct Benchmark
+	{
+		std::string suite;
+		std::string name;
+		void (*body)(std::size_t iterations);
+	};
+
+	struct Result
+	{
+		std::string suite;
+		std::string name;
+		std::size_t iterations;
+		std::size_t samples;
+		double median_ns;
+		double p99_ns;
+		double min_ns;
+		double median_cycles;
+	};
+
+	struct Options
+	{
+		std::string filter;
+		std::size_t samples = 31;
+		std::size_t warmup = 3;
+		std::chrono::nanoseconds min_time = std::chrono::milliseconds(2);
+		std::string out;
+	};
+
+	inline std::vector<Benchmark>& registry()
+	{
+		static std::vector<Benchmark> benchmarks;
+		return benchmarks;
+	}
+
+	struct Registrar
+	{
+		Registrar(const char* suite, const char* name, void (*body)(std::size_t)) noexcept
+		{
+			registry().push_back({suite, name, body});
+		}
+	};
+
+	/**
+	 * @brief Значение по перцентилю (ближайший ранг) в отсортированном массиве
+	 */
+	inline double percentile(const std::vector<double>& sorted, double p) noexcept
+	{
+		const auto rank = static_cast<std::size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+		return sorted[std::min(std::max<std::size_t>(rank, 1), sorted.size()) - 1];
+	}
+
+	inline Result run(const Benchmark& benchmark, const Options& options)
+	{
+		using clock = std::chrono::steady_clock;
+
+		//подбираем число итераций, чтобы замер был заметно длиннее разрешения часов
+		std::size_t iterations = 1;
+		for(;;)
+		{
+			const auto start = clock::now();
+			benchmark.body(iterations);
+			if(clock::now() - start >= options.min_time || iterations >= (std::size_t(1) << 40)) break;
+			iterations *= 2;
+		}
+
+		for(std::size_t i = 0; i < options.warmup; ++i)
+			benchmark.body(iterations);
+
+		std::vector<double> ns(options.samples);
+		std::vector<double> cycles_per_op(options.samples);
+		for(std::size_t i = 0; i < options.samples; ++i)
+		{
+			const std::uint64_t c0 = cycles();
+			const auto start = clock::now();
+			benchmark.body(iterations);
+			const auto finish = clock::now();
+			const std::uint64_t c1 = cycles();
+
+			ns[i] = std::chrono::duration<double, std::nano>(finish - start).count() / static_cast<double>(iterations);
+			cycles_per_op[i] = static_cast<double>(c1 - c0) / static_cast<double>(iterations);
+		}
+		std::sort(ns.begin(), ns.end());
+		std::sort(cycles_per_op.begin(), cycles_per_op.end());
+
+		return {benchmark.suite, benchmark.name, iterations, options.samples,
+				percentile(ns, 0.5), percentile(ns, 0.99), ns.front(), percentile(cycles_per_op, 0.5)};
+	}
+
+	inline void write_json(std::ostream& out, const std::vector<Result>& results)
+	{
+		out << "{\n  \"benchmarks\": [";
+		for(std::size_t i = 0; i < results.size(); ++i)
+		{
+			const Result& r = results[i];
+			out << (i ? ",\n" : "\n") << std::fixed << std::setprecision(3)
+				<< "    {\"suite\": \"" << r.suite << "\", \"name\": \"" << r.name << "\""
+				<< ", \"iterations\": " << r.iterations << ", \"samples\": " << r.samples
+				<< ", \"median_ns\": " << r.median_ns << ", \"p99_ns\": " << r.p99_ns << ", \"min_ns\": " << r.min_ns
+				<< ", \"median_cycles\": " << r.median_cycles << "}";
+		}
+		out << "\n  ]\n}\n";
+	}
+
+	/**
+	 * @brief Разбираем аргументы и запускаем бенчмарки
+	 * @details --filter=<подстрока "Suite/Name">, --samples=<N>, --warmup=<N>, --min-time-ms=<N>, --out=<файл>
+	 */
+	inline int main(int argc, char** argv)
+	{
+		Options options;
+		for(int i = 1; i < argc; ++i)
+		{
+			const std::string arg = argv[i];
+			const auto value = [&arg](const char* key) -> const char*
+			{
+				const std::size_t length = std::strlen(key);
+				return arg.compare(0, length, key) == 0 ? arg.c_str() + length : nullptr;
+			};
+
+			if(const char* v = value("--filter=")) options.filter = v;
+			else if(const char* v = value("--samples=")) options.samples = std::max<std::size_t>(std::stoul(v), 1);
+			else if(const char* v = value("--warmup=")) options.warmup = std::stoul(v);
+			else if(const char* v = value("--min-time-ms=")) options.min_time = std::chrono::milliseconds(std::stoul(v));
+			else if(const char* v = value("--out=")) options.out = v;
+			else
+			{
+				std::cerr << "usage: " << argv[0] << " [--filter=SUBSTR] [--samples=N] [--warmup=N] [--min-time-ms=N] [--out=FILE]\n";
+				return 1;
+			}
+		}
+
+		//порядок регистрации между единицами трансляции не определён: сортируем, чтобы отчёты сравнивались построчно
+		std::vector<Benchmark> benchmarks = registry();
+		std::stable_sort(benchmarks.begin(), benchmarks.end(), [](const Benchmark& a, const Benchmark& b) { return a.suite < b.suite; });
+
+		std::vector<Result> results;
+		for(const Benchmark& benchmark : benchmarks)
+		{
+			if((benchmark.suite + "/" + benchmark.name).find(options.filter) == std::string::npos) continue;
+
+			results.push_back(run(benchmark, options));
+			std::cerr << benchmark.suite << "/" << benchmark.name << ": " << results.back().median_ns << " ns/op\n";
+		}
+
+		if(options.out.empty())
+		{
+			write_json(std::cout, results);
+			return 0;
+		}
+
+		std::ofstream file(options.out);
+		write_json(file, results);
+		return file ? 0 : 1;
+	}
+}
+
+/**
+ * @brief Объявляем бенчмарк. Тело выполняет операцию iterations раз.
+ */
+#define BENCH(Suite, Name) \
+	static void bench_##Suite##_##Name(std::size_t iterations); \
+	static const ::bench::Registrar bench_registrar_##Suite##_##Name(#Suite, #Name, &bench_##Suite##_##Name); \
+	static void bench_##Suite##_##Name(std::size_t iterations)
@@ -0,0 +1,290 @@
+#include "bench.hpp"
+#include "bitmask.hpp"
+#include "bitmask_dispatch.hpp"
+#include "packed_bitmask_array.hpp"
+
+namespace
+{
+    enum Flag : unsigned char
+    {
+        Read,
+        Write,
+        Execute,
+        Append,
+        Truncate,
+        Create,
+        MaxFlag
+    };
+
+    //то же самое на обычных флагах-степенях двойки
+    enum RawFlag : unsigned char
+    {
+        RawRead = 1 << Read,
+        RawWrite = 1 << Write,
+        RawExecute = 1 << Execute,
+        RawAppend = 1 << Append,
+        RawTruncate = 1 << Truncate,
+        RawCreate = 1 << Create,
+    };
+
+    const std::vector<Flag>& flags()
+    {
+        static const std::vector<Flag> values = []
+        {
+            std::vector<Flag> result(1024);
+            std::mt19937 random(42);
+            for(auto& value : result)
+                value = static_cast<Flag>(random() % MaxFlag);
+            return result;
+        }();
+        return values;
+    }
+}
+
+BENCH(BitMask, SetResetHas)
+{
+    const auto& flag = flags();
+    BitMask<Flag, MaxFlag> mask;
+    std::size_t hits = 0;
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        const Flag f = flag[i % flag.size()];
+        if(mask.has(f)) ++hits;
+        if(i & 1) mask.set(f);
+        else mask.reset(f);
+    }
+    bench::do_not_optimize(hits);
+    bench::do_not_optimize(mask);
+}
+
+BENCH(BitMask, RawSetResetHas)
+{
+    const auto& flag = flags();
+    unsigned char mask = 0;
+    std::size_t hits = 0;
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        const auto f = static_cast<unsigned char>(1u << flag[i % flag.size()]);
+        if(mask & f) ++hits;
+        if(i & 1) mask |= f;
+        else mask &= static_cast<unsigned char>(~f);
+    }
+    bench::do_not_optimize(hits);
+    bench::do_not_optimize(mask);
+}
+
+BENCH(BitMask, HasMany)
+{
+    BitMask<Flag, MaxFlag> mask(Read, Write, Create);
+    std::size_t hits = 0;
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(mask);
+        hits += mask.has(Read, Write, Create);
+    }
+    bench::do_not_optimize(hits);
+}
+
+BENCH(BitMask, RawHasMany)
+{
+    unsigned char mask = RawRead | RawWrite | RawCreate;
+    std::size_t hits = 0;
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(mask);
+        constexpr unsigned char wanted = RawRead | RawWrite | RawCreate;
+        hits += (mask & wanted) == wanted;
+    }
+    bench::do_not_optimize(hits);
+}
+
+BENCH(BitMask, Count)
+{
+    BitMask<Flag, MaxFlag> mask(Read, Execute, Truncate);
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(mask);
+        bench::do_not_optimize(mask.count());
+    }
+}
+
+BENCH(BitMask, RawCount)
+{
+    unsigned char mask = RawRead | RawExecute | RawTruncate;
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(mask);
+        bench::do_not_optimize(__builtin_popcount(mask));
+    }
+}
+
+namespace
+{
+    //имена как у флагов возможностей протокола: длинные и с общим префиксом
+#define CAPABILITIES(X) \
+    X(0) X(1) X(2) X(3) X(4) X(5) X(6) X(7) X(8) X(9) X(10) X(11) X(12) X(13) X(14) X(15) \
+    X(16) X(17) X(18) X(19) X(20) X(21) X(22) X(23) X(24) X(25) X(26) X(27) X(28) X(29) X(30) X(31) \
+    X(32) X(33) X(34) X(35) X(36) X(37) X(38) X(39) X(40) X(41) X(42) X(43) X(44) X(45) X(46) X(47)
+
+#define CAPABILITY_VALUE(n) CapabilityFeature##n,
+#define CAPABILITY_NAME(n) "CapabilityFeature" #n,
+
+    enum Capability : std::uint64_t
+    {
+        CAPABILITIES(CAPABILITY_VALUE)
+    };
+
+    const char* const capability_names[] = {CAPABILITIES(CAPABILITY_NAME)};
+
+    const std::vector<std::string>& capability_inputs()
+    {
+        static const std::vector<std::string> values = []
+        {
+            std::vector<std::string> result(64);
+            std::mt19937 random(42);
+            for(auto& value : result)
+            {
+                for(std::size_t i = 0, n = 1 + random() % 4; i < n; ++i)
+                    value += (i ? "|" : "") + std::string(capability_names[random() % 48]);
+            }
+            return result;
+        }();
+        return values;
+    }
+}
+
+BENCH(BitMask, ParseNames)
+{
+    const auto& inputs = capability_inputs();
+    std::uint64_t bits = 0;
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        const std::string& input = inputs[i % inputs.size()];
+        BitMask<Capability> mask;
+        mask.from_names(input.data(), input.data() + input.size());
+        bits += mask.value();
+    }
+    bench::do_not_optimize(bits);
+}
+
+BENCH(BitMask, ParseNamesStrcmp)
+{
+    const auto& inputs = capability_inputs();
+    std::uint64_t bits = 0;
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        const std::string_view input = inputs[i % inputs.size()];
+        std::uint64_t mask = 0;
+        for(std::size_t first = 0; first <= input.size();)
+        {
+            const std::size_t last = std::min(input.find('|', first), input.size());
+            const std::string_view token = input.substr(first, last - first);
+            for(std::size_t n = 0; n < 48; ++n)
+            {
+                if(token == capability_names[n])
+                {
+                    mask |= std::uint64_t(1) << n;
+                    break;
+                }
+            }
+            first = last + 1;
+        }
+        bits += mask;
+    }
+    bench::do_not_optimize(bits);
+}
+
+namespace
+{
+    const std::vector<BitMask<Capability>>& capability_masks()
+    {
+        static const std::vector<BitMask<Capability>> values = []
+        {
+            std::vector<BitMask<Capability>> result(64);
+            std::mt19937 random(7);
+            for(auto& value : result)
+            {
+                for(std::size_t i = 0, n = 1 + random() % 4; i < n; ++i)
+                    value.set(static_cast<Capability>(random() % 48));
+            }
+            return result;
+        }();
+        return values;
+    }
+}
+
+BENCH(BitMask, DispatchTable)
+{
+    const auto& masks = capability_masks();
+    std::array<std::uint64_t, 48> counters{};
+    auto dispatcher = make_dispatcher<BitMask<Capability>>([&counters](auto flag)
+    {
+        counters[decltype(flag)::value] += decltype(flag)::value + 1;
+    });
+    for(std::size_t i = 0; i < iterations; ++i)
+        dispatcher(masks[i % masks.size()]);
+    bench::do_not_optimize(counters);
+}
+
+BENCH(BitMask, DispatchHasFunction)
+{
+    const auto& masks = capability_masks();
+    std::array<std::uint64_t, 48> counters{};
+    std::array<std::function<void()>, 48> handlers;
+    for(std::size_t n = 0; n < 48; ++n)
+        handlers[n] = [&counters, n] { counters[n] += n + 1; };
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        const auto& mask = masks[i % masks.size()];
+        for(std::size_t n = 0; n < 48; ++n)
+        {
+            if(mask.has(static_cast<Capability>(n))) handlers[n]();
+        }
+    }
+    bench::do_not_optimize(counters);
+}
+
+namespace
+{
+    enum class Color : unsigned char
+    {
+        Red,
+        Green,
+        Blue,
+    };
+
+    //1 << 20 масок: 1 МБ по байту на маску, 400 КБ упакованными
+    const std::vector<BitMask<Color>>& color_masks()
+    {
+        static const std::vector<BitMask<Color>> values = []
+        {
+            std::vector<BitMask<Color>> result(1 << 20);
+            std::mt19937 random(3);
+            for(auto& value : result)
+                value = BitMask<Color>(static_cast<unsigned char>(random() % 8));
+            return result;
+        }();
+        return values;
+    }
+}
+
+BENCH(BitMask, PackedCountWhere)
+{
+    static const PackedBitMaskArray<Color> packed(color_masks().begin(), color_masks().end());
+    std::size_t hits = 0;
+    for(std::size_t i = 0; i < iterations; ++i)
+        hits += packed.count_where(BitMask<Color>(Color::Blue), BitMask<Color>(Color::Red));
+    bench::do_not_optimize(hits);
+}
+
+BENCH(BitMask, VectorCountWhere)
+{
+    const auto& masks = color_masks();
+    std::size_t hits = 0;
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        for(const auto& mask : masks)
+            hits += mask.has(Color::Blue) && !mask.has(Color::Red);
+    }
+    bench::do_not_optimize(hits);
+}
@@ -0,0 +1,137 @@
+#include "bench.hpp"
+#include "bitset.hpp"
+
+namespace
+{
+    constexpr std::size_t bits = 1024;
+
+    //номера бит заранее, чтобы компилятор не свернул цикл в константу
+    const std::vector<std::size_t>& indexes()
+    {
+        static const std::vector<std::size_t> values = []
+        {
+            std::vector<std::size_t> result(4096);
+            std::mt19937 random(42);
+            for(auto& value : result)
+                value = random() % bits;
+            return result;
+        }();
+        return values;
+    }
+
+    BitSet<uint64_t, bits> filled_bitset(unsigned seed)
+    {
+        BitSet<uint64_t, bits> set;
+        std::mt19937 random(seed);
+        for(std::size_t i = 0; i < bits / 2; ++i)
+            set.set(static_cast<std::size_t>(random() % bits));
+        return set;
+    }
+
+    std::bitset<bits> filled_std_bitset(unsigned seed)
+    {
+        std::bitset<bits> set;
+        std::mt19937 random(seed);
+        for(std::size_t i = 0; i < bits / 2; ++i)
+            set.set(random() % bits);
+        return set;
+    }
+}
+
+BENCH(BitSet, SetTest)
+{
+    const auto& index = indexes();
+    BitSet<uint64_t, bits> set;
+    std::size_t hits = 0;
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        const std::size_t bit = index[i % index.size()];
+        hits += set[bit];
+        set.set(static_cast<std::size_t>(bit));
+    }
+    bench::do_not_optimize(hits);
+    bench::do_not_optimize(set);
+}
+
+BENCH(BitSet, StdSetTest)
+{
+    const auto& index = indexes();
+    std::bitset<bits> set;
+    std::size_t hits = 0;
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        const std::size_t bit = index[i % index.size()];
+        hits += set.test(bit);
+        set.set(bit);
+    }
+    bench::do_not_optimize(hits);
+    bench::do_not_optimize(set);
+}
+
+BENCH(BitSet, Count)
+{
+    auto set = filled_bitset(1);
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(set);
+        bench::do_not_optimize(set.count());
+    }
+}
+
+BENCH(BitSet, StdCount)
+{
+    auto set = filled_std_bitset(1);
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(set);
+        bench::do_not_optimize(set.count());
+    }
+}
+
+BENCH(BitSet, AndOr)
+{
+    auto a = filled_bitset(1), b = filled_bitset(2), c = filled_bitset(3);
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(a);
+        BitSet<uint64_t, bits> result = (a & b) | c;
+        bench::do_not_optimize(result);
+    }
+}
+
+BENCH(BitSet, StdAndOr)
+{
+    auto a = filled_std_bitset(1), b = filled_std_bitset(2), c = filled_std_bitset(3);
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(a);
+        std::bitset<bits> result = (a & b) | c;
+        bench::do_not_optimize(result);
+    }
+}
+
+BENCH(BitSet, Iterate)
+{
+    auto set = filled_bitset(1);
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(set);
+        std::size_t sum = 0;
+        for(std::size_t bit : set)
+            sum += bit;
+        bench::do_not_optimize(sum);
+    }
+}
+
+BENCH(BitSet, StdIterate)
+{
+    auto set = filled_std_bitset(1);
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(set);
+        std::size_t sum = 0;
+        for(std::size_t bit = 0; bit < bits; ++bit)
+            if(set.test(bit)) sum += bit;
+        bench::do_not_optimize(sum);
+    }
+}
@@ -0,0 +1,74 @@
+#include "bench.hpp"
+#include "my_exception.hpp"
+
+namespace
+{
+    //noinline, чтобы throw и catch были в разных кадрах, как в реальном коде
+    __attribute__((noinline)) void throw_my_exception(int code)
+    {
+        throw MyException(code);
+    }
+
+    __attribute__((noinline)) void throw_runtime_error(int code)
+    {
+        bench::do_not_optimize(code);
+        throw std::runtime_error("error");
+    }
+
+    __attribute__((noinline)) int return_error_code(int code)
+    {
+        bench::do_not_optimize(code);
+        return code;
+    }
+}
+
+BENCH(Exception, MyExceptionThrowCatch)
+{
+    std::size_t caught = 0;
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        try
+        {
+            throw_my_exception(static_cast<int>(i));
+        }
+        catch(const std::exception& e)
+        {
+            caught += e.what()[0] != '\0';
+        }
+    }
+    bench::do_not_optimize(caught);
+}
+
+BENCH(Exception, RuntimeErrorThrowCatch)
+{
+    std::size_t caught = 0;
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        try
+        {
+            throw_runtime_error(static_cast<int>(i));
+        }
+        catch(const std::exception& e)
+        {
+            caught += e.what()[0] != '\0';
+        }
+    }
+    bench::do_not_optimize(caught);
+}
+
+BENCH(Exception, MyExceptionConstruct)
+{
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        MyException e(static_cast<int>(i));
+        bench::do_not_optimize(e);
+    }
+}
+
+BENCH(Exception, ErrorCode)
+{
+    std::size_t failed = 0;
+    for(std::size_t i = 0; i < iterations; ++i)
+        failed += return_error_code(static_cast<int>(i)) != 0;
+    bench::do_not_optimize(failed);
+}
@@ -0,0 +1,199 @@
+#include "bench.hpp"
+#include "optional.hpp"
+#include "compact_optional.hpp"
+#include "small_vector.hpp"
+#include "nullable_vector.hpp"
+
+namespace
+{
+    struct Payload
+    {
+        int a{0};
+        int b{1};
+        int c{2};
+    };
+}
+
+BENCH(Optional, EmplaceValue)
+{
+    optional<Payload> opt;
+    long sum = 0;
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        opt.emplace(Payload{static_cast<int>(i), 1, 2});
+        bench::do_not_optimize(opt);
+        if(opt.has_value()) sum += opt->a;
+        opt = nullopt;
+    }
+    bench::do_not_optimize(sum);
+}
+
+BENCH(Optional, StdEmplaceValue)
+{
+    std::optional<Payload> opt;
+    long sum = 0;
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        opt.emplace(Payload{static_cast<int>(i), 1, 2});
+        bench::do_not_optimize(opt);
+        if(opt.has_value()) sum += opt->a;
+        opt = std::nullopt;
+    }
+    bench::do_not_optimize(sum);
+}
+
+BENCH(Optional, Copy)
+{
+    optional<Payload> source;
+    source.emplace(Payload{3, 4, 5});
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(source);
+        optional<Payload> copy(source);
+        bench::do_not_optimize(copy);
+    }
+}
+
+BENCH(Optional, StdCopy)
+{
+    std::optional<Payload> source(Payload{3, 4, 5});
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(source);
+        std::optional<Payload> copy(source);
+        bench::do_not_optimize(copy);
+    }
+}
+
+BENCH(Optional, ValueOr)
+{
+    optional<int> engaged, empty;
+    engaged.emplace(7);
+    long sum = 0;
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(engaged);
+        bench::do_not_optimize(empty);
+        sum += engaged.value_or(1) + empty.value_or(2);
+    }
+    bench::do_not_optimize(sum);
+}
+
+BENCH(Optional, StdValueOr)
+{
+    std::optional<int> engaged(7), empty;
+    long sum = 0;
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(engaged);
+        bench::do_not_optimize(empty);
+        sum += engaged.value_or(1) + empty.value_or(2);
+    }
+    bench::do_not_optimize(sum);
+}
+
+namespace
+{
+    //столбец необязательных значений больше кэша (32 МБ против 64 МБ): каждое четвёртое отсутствует
+    template<typename Optional>
+    const std::vector<Optional>& optional_column()
+    {
+        static const std::vector<Optional> values = []
+        {
+            std::vector<Optional> result(1 << 22);
+            for(std::size_t i = 0; i < result.size(); ++i)
+                if(i % 4) result[i] = static_cast<double>(i);
+            return result;
+        }();
+        return values;
+    }
+
+    template<typename Optional>
+    void count_column(std::size_t iterations)
+    {
+        const auto& column = optional_column<Optional>();
+        std::size_t present = 0;
+        for(std::size_t i = 0; i < iterations; ++i)
+        {
+            for(const auto& value : column)
+                present += value.has_value();
+        }
+        bench::do_not_optimize(present);
+    }
+}
+
+BENCH(Optional, CompactColumnCount)
+{
+    count_column<compact_optional<double>>(iterations);
+}
+
+BENCH(Optional, StdColumnCount)
+{
+    count_column<std::optional<double>>(iterations);
+}
+
+namespace
+{
+    //рост буфера необязательных владеющих указателей: перенос элементов при каждом удвоении
+    template<typename Vector>
+    void grow_owners(std::size_t iterations)
+    {
+        for(std::size_t i = 0; i < iterations; ++i)
+        {
+            Vector values;
+            for(int n = 0; n < 4096; ++n)
+                values.emplace_back(nullptr);
+            bench::do_not_optimize(values);
+        }
+    }
+}
+
+BENCH(Optional, SmallVectorGrowth)
+{
+    grow_owners<small_vector<optional<std::unique_ptr<int>>, 8>>(iterations);
+}
+
+BENCH(Optional, StdVectorGrowth)
+{
+    grow_owners<std::vector<optional<std::unique_ptr<int>>>>(iterations);
+}
+
+namespace
+{
+    //сумма столбца из optional_column, но в раскладке "значения + маска присутствия"
+    const nullable_vector<double>& nullable_column()
+    {
+        static const nullable_vector<double> values = []
+        {
+            nullable_vector<double> result(1 << 22);
+            for(std::size_t i = 0; i < result.size(); ++i)
+                if(i % 4) result[i] = static_cast<double>(i);
+            return result;
+        }();
+        return values;
+    }
+}
+
+BENCH(Optional, NullableColumnSum)
+{
+    const auto& column = nullable_column();
+    double sum = 0;
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(column);
+        sum += column.sum();
+    }
+    bench::do_not_optimize(sum);
+}
+
+BENCH(Optional, StdColumnSum)
+{
+    const auto& column = optional_column<std::optional<double>>();
+    double sum = 0;
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        for(const auto& value : column)
+            if(value) sum += *value;
+    }
+    bench::do_not_optimize(sum);
+}
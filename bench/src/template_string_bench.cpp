@@ -0,0 +1,38 @@
+#include "bench.hpp"
+#include "template_string.hpp"
+
+namespace
+{
+    using First = Derived<1, str_to_literal("First")>;
+    using Second = Derived<2, str_to_literal("Second")>;
+    using Third = Base<3, str_to_literal("Third")>;
+}
+
+BENCH(TemplateString, VirtualToString)
+{
+    First first;
+    Second second;
+    Third third;
+    SuperBase* objects[] = {&first, &second, &third};
+
+    std::size_t length = 0;
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        SuperBase* object = objects[i % 3];
+        bench::do_not_optimize(object);
+        length += object->to_string()[0];
+    }
+    bench::do_not_optimize(length);
+}
+
+BENCH(TemplateString, DirectToString)
+{
+    First first;
+    std::size_t length = 0;
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(first);
+        length += first.to_string()[0];
+    }
+    bench::do_not_optimize(length);
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+/**
+ * @brief Аллокатор, выравнивающий выделенную память по границе Alignment байт (по умолчанию по кэш-линии)
+ * @tparam T Тип элементов
+ * @tparam Alignment Выравнивание в байтах. Должно быть степенью двойки и не меньше alignof(T).
+ */
+template<typename T, std::size_t Alignment = 64>
+struct aligned_allocator
+{
+	using value_type = T;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using propagate_on_container_move_assignment = std::true_type;
+	using is_always_equal = std::true_type;
+
+	static_assert((Alignment & (Alignment - 1)) == 0, "alignment must be a power of two");
+	static_assert(Alignment >= alignof(T), "alignment must not be weaker than alignof(T)");
+
+	template<typename U>
+	struct rebind
+	{
+		using other = aligned_allocator<U, Alignment>;
+	};
+
+	constexpr aligned_allocator() noexcept = default;
+
+	template<typename U>
+	constexpr aligned_allocator(const aligned_allocator<U, Alignment>&) noexcept {}
+
+	/**
+	 * @brief Выделяем память под n элементов с выравниванием Alignment
+	 * @param n Количество элементов
+	 */
+	T* allocate(std::size_t n)
+	{
+		if(n > std::numeric_limits<std::size_t>::max() / sizeof(T)) throw std::bad_array_new_length();
+		return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+	}
+
+	/**
+	 * @brief Освобождаем память, выделенную allocate
+	 */
+	void deallocate(T* p, std::size_t) noexcept
+	{
+		::operator delete(p, std::align_val_t(Alignment));
+	}
+
+	template<typename U>
+	constexpr bool operator==(const aligned_allocator<U, Alignment>&) const noexcept
+	{
+		return true;
+	}
+
+	template<typename U>
+	constexpr bool operator!=(const aligned_allocator<U, Alignment>&) const noexcept
+	{
+		return false;
+	}
+};
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <bits/stdc++.h>
+#include "bitset.hpp"
+
+
+namespace detail
+{
+	/**
+	 * @brief Слово атомарного набора
+	 * @tparam Padded Если true, каждое слово занимает собственную кэш-линию, чтобы потоки, меняющие разные слова, не мешали друг другу (false sharing)
+	 */
+	template<typename T, bool Padded>
+	struct atomic_word
+	{
+		std::atomic<T> value{0};
+	};
+
+	template<typename T>
+	struct alignas(64) atomic_word<T, true>
+	{
+		std::atomic<T> value{0};
+	};
+}
+
+/**
+ * @brief Набор битов, биты которого можно менять из нескольких потоков без блокировок
+ * @details set/reset/flip выполняются одной атомарной операцией (fetch_or/fetch_and/fetch_xor) над словом,
+ * в котором лежит бит, и возвращают предыдущее значение бита. Порядок памяти задаёт вызывающий.
+ * Операции над всем набором (count, any, load) читают слова по одному и не являются атомарным снимком всего набора.
+ * @tparam Integral Тип слова. Должен быть беззнаковым и lock-free для std::atomic.
+ * @tparam N Количество битов в наборе
+ * @tparam Padded Размещать каждое слово на отдельной кэш-линии
+ */
+template<typename Integral = uint64_t, std::size_t N = sizeof(Integral) * 8, bool Padded = false>
+struct AtomicBitSet
+{
+	using type_t = Integral;
+
+	static_assert(std::is_unsigned<Integral>::value, "AtomicBitSet type cannot be signed");
+	static_assert(std::atomic<Integral>::is_always_lock_free, "AtomicBitSet word type must be lock-free");
+
+	/**
+	 * @brief Количество бит в одном слове
+	 */
+	static constexpr std::size_t word_bits = sizeof(type_t) * 8;
+
+	/**
+	 * @brief Количество слов, в которых хранится набор
+	 */
+	static constexpr std::size_t word_count = (N + word_bits - 1) / word_bits;
+
+	/**
+	 * @brief Конструктор по умолчанию. Создает пустой набор.
+	 */
+	AtomicBitSet() = default;
+
+	/**
+	 * @brief Создаём набор из обычного BitSet того же размера
+	 */
+	explicit AtomicBitSet(const BitSet<Integral, N>& bits) noexcept
+	{
+		store(bits, std::memory_order_relaxed);
+	}
+
+	AtomicBitSet(const AtomicBitSet&) = delete;
+
+	AtomicBitSet& operator=(const AtomicBitSet&) = delete;
+
+	/**
+	 * @brief Выставляем бит
+	 * @param index Номер бита
+	 * @param order Порядок памяти для операции
+	 * @return Предыдущее значение бита
+	 */
+	inline bool set(std::size_t index, std::memory_order order = std::memory_order_seq_cst) noexcept
+	{
+		const type_t mask = bit_mask(index);
+		return word_at(index).fetch_or(mask, order) & mask;
+	}
+
+	/**
+	 * @brief Сбрасываем бит
+	 * @param index Номер бита
+	 * @param order Порядок памяти для операции
+	 * @return Предыдущее значение бита
+	 */
+	inline bool reset(std::size_t index, std::memory_order order = std::memory_order_seq_cst) noexcept
+	{
+		const type_t mask = bit_mask(index);
+		return word_at(index).fetch_and(static_cast<type_t>(~mask), order) & mask;
+	}
+
+	/**
+	 * @brief Инвертируем бит
+	 * @param index Номер бита
+	 * @param order Порядок памяти для операции
+	 * @return Предыдущее значение бита
+	 */
+	inline bool flip(std::size_t index, std::memory_order order = std::memory_order_seq_cst) noexcept
+	{
+		const type_t mask = bit_mask(index);
+		return word_at(index).fetch_xor(mask, order) & mask;
+	}
+
+	/**
+	 * @brief Выставляем бит, если он ещё не выставлен
+	 * @details Сначала бит читается обычной загрузкой, и только если он сброшен, выполняется fetch_or.
+	 * Так уже выставленный флаг не заставляет кэш-линию переходить в эксклюзивное владение.
+	 * @param index Номер бита
+	 * @param order Порядок памяти для операции
+	 * @return Предыдущее значение бита: false означает, что бит выставил именно этот вызов
+	 */
+	inline bool test_and_set(std::size_t index, std::memory_order order = std::memory_order_seq_cst) noexcept
+	{
+		const type_t mask = bit_mask(index);
+		if(word_at(index).load(load_order(order)) & mask) return true;
+		return word_at(index).fetch_or(mask, order) & mask;
+	}
+
+	/**
+	 * @brief Проверяем значение бита
+	 * @param index Номер бита
+	 * @param order Порядок памяти для загрузки
+	 */
+	inline bool test(std::size_t index, std::memory_order order = std::memory_order_seq_cst) const noexcept
+	{
+		return word_at(index).load(order) & bit_mask(index);
+	}
+
+	inline bool operator[](std::size_t index) const noexcept
+	{
+		return test(index);
+	}
+
+	/**
+	 * @brief Сбрасываем все биты набора
+	 */
+	inline void reset_all(std::memory_order order = std::memory_order_seq_cst) noexcept
+	{
+		for(auto& word : _words)
+			word.value.store(0, order);
+	}
+
+	/**
+	 * @brief Проверяем, выставлен ли хотя бы один бит
+	 */
+	inline bool any(std::memory_order order = std::memory_order_seq_cst) const noexcept
+	{
+		for(const auto& word : _words)
+			if(word.value.load(order)) return true;
+		return false;
+	}
+
+	inline bool empty(std::memory_order order = std::memory_order_seq_cst) const noexcept
+	{
+		return !any(order);
+	}
+
+	/**
+	 * @brief Считаем количество выставленных бит
+	 */
+	inline std::size_t count(std::memory_order order = std::memory_order_seq_cst) const noexcept
+	{
+		std::size_t result = 0;
+		for(const auto& word : _words)
+			result += detail::word_popcount(word.value.load(order));
+		return result;
+	}
+
+	/**
+	 * @brief Копируем набор в обычный BitSet
+	 */
+	BitSet<Integral, N> load(std::memory_order order = std::memory_order_seq_cst) const noexcept
+	{
+		BitSet<Integral, N> result;
+		for(std::size_t i = 0; i < word_count; ++i)
+			result.data()[i] = _words[i].value.load(order);
+		return result;
+	}
+
+	/**
+	 * @brief Записываем значения всех слов из обычного BitSet
+	 */
+	void store(const BitSet<Integral, N>& bits, std::memory_order order = std::memory_order_seq_cst) noexcept
+	{
+		for(std::size_t i = 0; i < word_count; ++i)
+			_words[i].value.store(bits.word(i), order);
+	}
+
+	/**
+	 * @brief Возвращаем размер набора в битах
+	 */
+	inline constexpr std::size_t size() const noexcept
+	{
+		return N;
+	}
+
+	/**
+	 * @brief Атомарное слово по его номеру, для операций, которых нет в API набора
+	 */
+	inline std::atomic<type_t>& word(std::size_t index) noexcept
+	{
+		return _words[index].value;
+	}
+
+	inline const std::atomic<type_t>& word(std::size_t index) const noexcept
+	{
+		return _words[index].value;
+	}
+
+private:
+
+	detail::atomic_word<type_t, Padded> _words[word_count];
+
+	static constexpr type_t bit_mask(std::size_t index) noexcept
+	{
+		return static_cast<type_t>(static_cast<type_t>(1) << (index % word_bits));
+	}
+
+	inline std::atomic<type_t>& word_at(std::size_t index) noexcept
+	{
+		return _words[index / word_bits].value;
+	}
+
+	inline const std::atomic<type_t>& word_at(std::size_t index) const noexcept
+	{
+		return _words[index / word_bits].value;
+	}
+
+	/**
+	 * @brief Порядок памяти, допустимый для загрузки (release и acq_rel для load запрещены)
+	 */
+	static constexpr std::memory_order load_order(std::memory_order order) noexcept
+	{
+		return order == std::memory_order_release ? std::memory_order_relaxed :
+			   order == std::memory_order_acq_rel ? std::memory_order_acquire : order;
+	}
+};
@@ -0,0 +1,393 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include "bitwords.hpp"
+
+/**
+ * @brief Ленивые логические выражения над наборами битов фиксированного размера (BitSet, BitMask)
+ * @details Операторы &, |, ^ и ~ над наборами не создают временных наборов, а возвращают узел выражения,
+ * который хранит ссылки на операнды. Всё выражение вычисляется за один проход по словам
+ * (векторами AVX2/SSE2, хвост по одному слову) только в момент присваивания в набор, а также при вызове
+ * count(), any(), all(), has() и сравнении. Промежуточных буферов при этом не создаётся.
+ *
+ * Узел хранит ссылки на наборы-операнды, поэтому выражение нельзя сохранять в auto дольше, чем живут операнды:
+ * результат нужно присвоить в набор нужного типа.
+ */
+namespace detail
+{
+	/**
+	 * @brief Признак набора, который может быть листом выражения. Специализируется рядом с самим набором.
+	 * @details Набор должен предоставлять type_t, bit_count, word_count и data().
+	 */
+	template<typename T>
+	struct is_bit_leaf : std::false_type {};
+
+	template<typename Derived>
+	struct bit_expression;
+
+	template<typename T>
+	struct is_bit_expression : std::is_base_of<bit_expression<T>, T> {};
+
+	/**
+	 * @brief Признак операнда логического выражения: набор или узел выражения
+	 */
+	template<typename T>
+	struct is_bit_operand : std::integral_constant<bool, is_bit_leaf<T>::value || is_bit_expression<T>::value> {};
+
+#if defined(__AVX2__)
+	using bit_vec_t = __m256i;
+
+	inline bit_vec_t bit_vec_load(const void* p) noexcept { return _mm256_loadu_si256(static_cast<const __m256i*>(p)); }
+	inline void bit_vec_store(void* p, bit_vec_t v) noexcept { _mm256_storeu_si256(static_cast<__m256i*>(p), v); }
+	inline bit_vec_t bit_vec_ones() noexcept { return _mm256_set1_epi32(-1); }
+	inline bool bit_vec_is_zero(bit_vec_t v) noexcept { return _mm256_testz_si256(v, v); }
+#elif defined(__SSE2__)
+	using bit_vec_t = __m128i;
+
+	inline bit_vec_t bit_vec_load(const void* p) noexcept { return _mm_loadu_si128(static_cast<const __m128i*>(p)); }
+	inline void bit_vec_store(void* p, bit_vec_t v) noexcept { _mm_storeu_si128(static_cast<__m128i*>(p), v); }
+	inline bit_vec_t bit_vec_ones() noexcept { return _mm_set1_epi32(-1); }
+	inline bool bit_vec_is_zero(bit_vec_t v) noexcept { return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) == 0xFFFF; }
+#endif
+
+	/**
+	 * @brief Лист выражения - ссылка на набор
+	 */
+	template<typename Set>
+	struct bit_leaf : bit_expression<bit_leaf<Set>>
+	{
+		using set_t = Set;
+		using type_t = typename Set::type_t;
+
+		explicit bit_leaf(const Set& set) noexcept : _set(set) {}
+
+		inline type_t word(std::size_t index) const noexcept
+		{
+			return _set.data()[index];
+		}
+
+#if defined(__AVX2__) || defined(__SSE2__)
+		inline bit_vec_t vec(std::size_t index) const noexcept
+		{
+			return bit_vec_load(_set.data() + index);
+		}
+#endif
+
+	private:
+		const Set& _set;
+	};
+
+	/**
+	 * @brief Узел выражения для операции Op (and_op, or_op, xor_op, andnot_op) над двумя подвыражениями
+	 */
+	template<typename Op, typename L, typename R>
+	struct bit_binary : bit_expression<bit_binary<Op, L, R>>
+	{
+		using set_t = typename L::set_t;
+		using type_t = typename set_t::type_t;
+
+		static_assert(std::is_same<set_t, typename R::set_t>::value, "bit expression operands must have the same set type");
+
+		bit_binary(const L& lhs, const R& rhs) noexcept : _lhs(lhs), _rhs(rhs) {}
+
+		inline type_t word(std::size_t index) const noexcept
+		{
+			return Op::apply(_lhs.word(index), _rhs.word(index));
+		}
+
+#if defined(__AVX2__) || defined(__SSE2__)
+		inline bit_vec_t vec(std::size_t index) const noexcept
+		{
+			return Op::apply(_lhs.vec(index), _rhs.vec(index));
+		}
+#endif
+
+	private:
+		L _lhs;
+		R _rhs;
+	};
+
+	/**
+	 * @brief Узел выражения для дополнения. Биты за пределами набора отбрасываются при вычислении.
+	 */
+	template<typename E>
+	struct bit_not : bit_expression<bit_not<E>>
+	{
+		using set_t = typename E::set_t;
+		using type_t = typename set_t::type_t;
+
+		explicit bit_not(const E& expr) noexcept : _expr(expr) {}
+
+		inline type_t word(std::size_t index) const noexcept
+		{
+			return static_cast<type_t>(~_expr.word(index));
+		}
+
+#if defined(__AVX2__) || defined(__SSE2__)
+		inline bit_vec_t vec(std::size_t index) const noexcept
+		{
+			return xor_op::apply(_expr.vec(index), bit_vec_ones());
+		}
+#endif
+
+	private:
+		E _expr;
+	};
+
+	/**
+	 * @brief Операнд выражения в виде узла: набор превращается в лист, выражение остаётся как есть
+	 */
+	template<typename T, typename = void>
+	struct bit_node
+	{
+		using type = T;
+		static const T& make(const T& expr) noexcept { return expr; }
+	};
+
+	template<typename T>
+	struct bit_node<T, typename std::enable_if<is_bit_leaf<T>::value>::type>
+	{
+		using type = bit_leaf<T>;
+		static bit_leaf<T> make(const T& set) noexcept { return bit_leaf<T>(set); }
+	};
+
+	template<typename T>
+	using bit_node_t = typename bit_node<T>::type;
+
+	template<typename T>
+	inline auto make_bit_node(const T& operand) noexcept
+	{
+		return bit_node<T>::make(operand);
+	}
+
+	/**
+	 * @brief Тип набора, в который вычисляется операнд
+	 */
+	template<typename T>
+	using bit_set_t = typename bit_node_t<T>::set_t;
+
+	/**
+	 * @brief Параметры раскладки набора по словам
+	 */
+	template<typename Set>
+	struct bit_layout
+	{
+		using type_t = typename Set::type_t;
+
+		static constexpr std::size_t word_bits = sizeof(type_t) * 8;
+		static constexpr std::size_t word_count = Set::word_count;
+		static constexpr std::size_t full_words = Set::bit_count / word_bits;
+
+		/**
+		 * @brief Количество слов, обрабатываемых векторами
+		 */
+#if defined(__AVX2__) || defined(__SSE2__)
+		static constexpr std::size_t vec_step = sizeof(bit_vec_t) / sizeof(type_t);
+		static constexpr std::size_t vec_words = word_count / vec_step * vec_step;
+
+		/**
+		 * @brief Количество полных слов (без частичного последнего), обрабатываемых векторами
+		 */
+		static constexpr std::size_t vec_full_words = full_words / vec_step * vec_step;
+#else
+		static constexpr std::size_t vec_words = 0;
+		static constexpr std::size_t vec_full_words = 0;
+#endif
+
+		/**
+		 * @brief Маска значащих бит последнего слова
+		 */
+		static constexpr type_t tail_mask() noexcept
+		{
+			type_t mask = ~static_cast<type_t>(0);
+			mask >>= word_count * word_bits - Set::bit_count;
+			return mask;
+		}
+	};
+
+	/**
+	 * @brief Вычисляем выражение в массив слов набора за один проход
+	 * @details Каждое слово результата зависит только от слов операндов с тем же номером,
+	 * поэтому приёмник может сам входить в выражение (a = (a | b) & ~c)
+	 */
+	template<typename E>
+	inline void bit_expression_assign(typename E::type_t* dst, const E& expr) noexcept
+	{
+		using layout = bit_layout<typename E::set_t>;
+
+		std::size_t i = 0;
+#if defined(__AVX2__) || defined(__SSE2__)
+		for(; i < layout::vec_words; i += layout::vec_step)
+			bit_vec_store(dst + i, expr.vec(i));
+#endif
+		for(; i < layout::word_count; ++i)
+			dst[i] = expr.word(i);
+		dst[layout::word_count - 1] &= layout::tail_mask();
+	}
+
+	/**
+	 * @brief Базовый класс узлов выражения с операциями, вычисляющими выражение без сохранения результата
+	 */
+	template<typename Derived>
+	struct bit_expression
+	{
+		/**
+		 * @brief Считаем количество выставленных бит результата выражения
+		 */
+		inline std::size_t count() const noexcept
+		{
+			using layout = bit_layout<typename Derived::set_t>;
+
+			std::size_t result = 0;
+			std::size_t i = 0;
+#if defined(__AVX2__)
+			__m256i acc = _mm256_setzero_si256();
+			for(; i < layout::vec_full_words; i += layout::vec_step)
+				acc = _mm256_add_epi64(acc, popcount256(self().vec(i)));
+			result += static_cast<std::size_t>(_mm256_extract_epi64(acc, 0)) + static_cast<std::size_t>(_mm256_extract_epi64(acc, 1)) +
+					  static_cast<std::size_t>(_mm256_extract_epi64(acc, 2)) + static_cast<std::size_t>(_mm256_extract_epi64(acc, 3));
+#endif
+			for(; i < layout::full_words; ++i)
+				result += word_popcount(self().word(i));
+			if(layout::full_words != layout::word_count)
+				result += word_popcount(static_cast<typename layout::type_t>(self().word(layout::word_count - 1) & layout::tail_mask()));
+			return result;
+		}
+
+		/**
+		 * @brief Проверяем, есть ли в результате выражения хотя бы один выставленный бит
+		 */
+		inline bool any() const noexcept
+		{
+			using layout = bit_layout<typename Derived::set_t>;
+
+			std::size_t i = 0;
+#if defined(__AVX2__) || defined(__SSE2__)
+			for(; i < layout::vec_full_words; i += layout::vec_step)
+				if(!bit_vec_is_zero(self().vec(i))) return true;
+#endif
+			for(; i < layout::word_count; ++i)
+			{
+				const auto mask = i + 1 == layout::word_count ? layout::tail_mask() : static_cast<typename layout::type_t>(~0ull);
+				if(self().word(i) & mask) return true;
+			}
+			return false;
+		}
+
+		inline bool empty() const noexcept
+		{
+			return !any();
+		}
+
+		/**
+		 * @brief Проверяем, что в результате выражения выставлены все биты
+		 */
+		inline bool all() const noexcept
+		{
+			using layout = bit_layout<typename Derived::set_t>;
+			using type_t = typename layout::type_t;
+
+			std::size_t i = 0;
+#if defined(__AVX2__) || defined(__SSE2__)
+			for(; i < layout::vec_full_words; i += layout::vec_step)
+				if(!bit_vec_is_zero(xor_op::apply(self().vec(i), bit_vec_ones()))) return false;
+#endif
+			for(; i < layout::full_words; ++i)
+				if(self().word(i) != static_cast<type_t>(~static_cast<type_t>(0))) return false;
+			if(layout::full_words != layout::word_count)
+				return (self().word(layout::word_count - 1) & layout::tail_mask()) == layout::tail_mask();
+			return true;
+		}
+
+		/**
+		 * @brief Проверяем бит результата выражения. Вычисляется только слово, в котором лежит бит.
+		 * @param index Номер бита
+		 */
+		inline bool test(std::size_t index) const noexcept
+		{
+			using layout = bit_layout<typename Derived::set_t>;
+			return self().word(index / layout::word_bits) & (static_cast<typename layout::type_t>(1) << (index % layout::word_bits));
+		}
+
+		/**
+		 * @brief Значение результата выражения для наборов из одного слова
+		 */
+		template<typename D = Derived, typename S = typename D::set_t, typename = typename std::enable_if<S::word_count == 1>::type>
+		inline operator typename S::type_t() const noexcept
+		{
+			return static_cast<typename S::type_t>(self().word(0) & bit_layout<S>::tail_mask());
+		}
+
+	private:
+		inline const Derived& self() const noexcept
+		{
+			return static_cast<const Derived&>(*this);
+		}
+	};
+
+	/**
+	 * @brief Проверяем, что все биты rhs выставлены в lhs, то есть (rhs & ~lhs) пусто
+	 */
+	template<typename L, typename R>
+	inline bool bit_expression_contains(const L& lhs, const R& rhs) noexcept
+	{
+		return bit_binary<andnot_op, bit_node_t<R>, bit_node_t<L>>(make_bit_node(rhs), make_bit_node(lhs)).empty();
+	}
+
+	template<typename L, typename R>
+	using enable_bit_operands = typename std::enable_if<is_bit_operand<L>::value && is_bit_operand<R>::value &&
+														std::is_same<bit_set_t<L>, bit_set_t<R>>::value>::type;
+
+	/**
+	 * @brief Ограничение для членов набора Set: E - сам набор или выражение над наборами типа Set.
+	 * Не требует полноты Set, поэтому его можно использовать внутри определения класса.
+	 */
+	template<typename Set, typename E>
+	using enable_bit_operand_of = typename std::enable_if<is_bit_operand<E>::value && std::is_same<bit_set_t<E>, Set>::value>::type;
+}
+
+template<typename L, typename R, typename = detail::enable_bit_operands<L, R>>
+inline detail::bit_binary<detail::and_op, detail::bit_node_t<L>, detail::bit_node_t<R>> operator&(const L& lhs, const R& rhs) noexcept
+{
+	return {detail::make_bit_node(lhs), detail::make_bit_node(rhs)};
+}
+
+template<typename L, typename R, typename = detail::enable_bit_operands<L, R>>
+inline detail::bit_binary<detail::or_op, detail::bit_node_t<L>, detail::bit_node_t<R>> operator|(const L& lhs, const R& rhs) noexcept
+{
+	return {detail::make_bit_node(lhs), detail::make_bit_node(rhs)};
+}
+
+template<typename L, typename R, typename = detail::enable_bit_operands<L, R>>
+inline detail::bit_binary<detail::xor_op, detail::bit_node_t<L>, detail::bit_node_t<R>> operator^(const L& lhs, const R& rhs) noexcept
+{
+	return {detail::make_bit_node(lhs), detail::make_bit_node(rhs)};
+}
+
+/**
+ * @brief Разность lhs & ~rhs одним узлом
+ */
+template<typename L, typename R, typename = detail::enable_bit_operands<L, R>>
+inline detail::bit_binary<detail::andnot_op, detail::bit_node_t<L>, detail::bit_node_t<R>> and_not(const L& lhs, const R& rhs) noexcept
+{
+	return {detail::make_bit_node(lhs), detail::make_bit_node(rhs)};
+}
+
+template<typename E, typename = typename std::enable_if<detail::is_bit_operand<E>::value>::type>
+inline detail::bit_not<detail::bit_node_t<E>> operator~(const E& expr) noexcept
+{
+	return detail::bit_not<detail::bit_node_t<E>>(detail::make_bit_node(expr));
+}
+
+template<typename L, typename R, typename = detail::enable_bit_operands<L, R>>
+inline bool operator==(const L& lhs, const R& rhs) noexcept
+{
+	return (lhs ^ rhs).empty();
+}
+
+template<typename L, typename R, typename = detail::enable_bit_operands<L, R>>
+inline bool operator!=(const L& lhs, const R& rhs) noexcept
+{
+	return !(lhs == rhs);
+}
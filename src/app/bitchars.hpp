@@ -0,0 +1,192 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(__AVX2__) || defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Перевод наборов битов в строки из '0'/'1' и обратно без выделения памяти.
+ * @details Порядок общий для всех наборов: старший бит первым, как у std::bitset. Символ с номером k
+ * соответствует биту bits - 1 - k, последний символ строки - биту 0.
+ * Биты читаются и пишутся байтами памяти набора, что предполагает little-endian (x86, ARM).
+ * За шаг обрабатывается 32 (AVX2), 16 (SSE2) или 8 бит (PDEP/PEXT при BMI2, иначе умножение).
+ */
+namespace detail
+{
+	constexpr std::uint64_t chars_zeros = 0x3030303030303030ull;
+	constexpr std::uint64_t chars_lsb = 0x0101010101010101ull;
+
+	/**
+	 * @brief Раскладываем байт в 8 символов, старший бит первым
+	 */
+	inline std::uint64_t byte_to_chars(unsigned char byte) noexcept
+	{
+#if defined(__BMI2__)
+		const std::uint64_t spread = _pdep_u64(byte, chars_lsb);
+#else
+		//байт j произведения содержит бит j, после сложения с 0x7f ненулевые байты получают старший бит
+		const std::uint64_t picked = (byte * chars_lsb) & 0x8040201008040201ull;
+		const std::uint64_t spread = ((picked + 0x7F7F7F7F7F7F7F7Full) & 0x8080808080808080ull) >> 7;
+#endif
+		return __builtin_bswap64(spread) | chars_zeros;
+	}
+
+	/**
+	 * @brief Собираем байт из 8 символов '0'/'1', старший бит первым
+	 * @return false, если среди символов есть другие
+	 */
+	inline bool chars_to_byte(const char* chars, unsigned char& byte) noexcept
+	{
+		std::uint64_t value;
+		std::memcpy(&value, chars, sizeof(value));
+		value ^= chars_zeros;
+		if(value & ~chars_lsb) return false;
+
+		value = __builtin_bswap64(value);
+#if defined(__BMI2__)
+		byte = static_cast<unsigned char>(_pext_u64(value, chars_lsb));
+#else
+		byte = static_cast<unsigned char>((value * 0x0102040810204080ull) >> 56);
+#endif
+		return true;
+	}
+
+#if defined(__AVX2__)
+	/**
+	 * @brief Переставляем 32 байта вектора в обратном порядке
+	 */
+	inline __m256i reverse_bytes(__m256i v) noexcept
+	{
+		const __m256i reverse = _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+												 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+		return _mm256_permute4x64_epi64(_mm256_shuffle_epi8(v, reverse), 0x4E);
+	}
+#elif defined(__SSE2__)
+	/**
+	 * @brief Переставляем 16 байт вектора в обратном порядке (без pshufb, только SSE2)
+	 */
+	inline __m128i reverse_bytes(__m128i v) noexcept
+	{
+		v = _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3));
+		v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+		v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+		return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+	}
+#endif
+
+	/**
+	 * @brief Записываем младшие bits бит массива в out, старший бит первым. Пишется ровно bits символов.
+	 * @param data Слова набора
+	 * @param bits Количество бит
+	 * @param out Буфер не меньше bits символов
+	 */
+	inline void bits_to_chars(const void* data, std::size_t bits, char* out) noexcept
+	{
+		const auto* bytes = static_cast<const unsigned char*>(data);
+		std::size_t pos = bits;
+
+		//неполный старший байт
+		while(pos % 8)
+		{
+			--pos;
+			*out++ = (bytes[pos / 8] >> (pos % 8)) & 1 ? '1' : '0';
+		}
+
+#if defined(__AVX2__)
+		const __m256i select = _mm256_set1_epi64x(0x0102040810204080ll);
+		for(; pos >= 32; pos -= 32, out += 32)
+		{
+			const unsigned char* src = bytes + pos / 8 - 4;
+			const __m256i spread = _mm256_set_epi64x(static_cast<long long>(src[0] * chars_lsb), static_cast<long long>(src[1] * chars_lsb),
+													 static_cast<long long>(src[2] * chars_lsb), static_cast<long long>(src[3] * chars_lsb));
+			const __m256i set = _mm256_cmpeq_epi8(_mm256_and_si256(spread, select), select);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_sub_epi8(_mm256_set1_epi8('0'), set));
+		}
+#elif defined(__SSE2__)
+		const __m128i select = _mm_set1_epi64x(0x0102040810204080ll);
+		for(; pos >= 16; pos -= 16, out += 16)
+		{
+			const unsigned char* src = bytes + pos / 8 - 2;
+			const __m128i spread = _mm_set_epi64x(static_cast<long long>(src[0] * chars_lsb), static_cast<long long>(src[1] * chars_lsb));
+			const __m128i set = _mm_cmpeq_epi8(_mm_and_si128(spread, select), select);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_sub_epi8(_mm_set1_epi8('0'), set));
+		}
+#endif
+		for(; pos >= 8; pos -= 8, out += 8)
+		{
+			const std::uint64_t chars = byte_to_chars(bytes[pos / 8 - 1]);
+			std::memcpy(out, &chars, sizeof(chars));
+		}
+	}
+
+	/**
+	 * @brief Разбираем строку из '0'/'1' (старший бит первым) в массив.
+	 * Массив должен быть обнулён и вмещать не меньше length бит.
+	 * @return false, если в строке есть символы кроме '0' и '1'
+	 */
+	inline bool chars_to_bits(const char* chars, std::size_t length, void* data) noexcept
+	{
+		auto* bytes = static_cast<unsigned char*>(data);
+		std::size_t pos = 0;
+
+#if defined(__AVX2__)
+		const __m256i invalid = _mm256_set1_epi8(static_cast<char>(0xFE));
+		for(; length - pos >= 32; pos += 32)
+		{
+			const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(chars + length - pos - 32));
+			const __m256i digits = _mm256_xor_si256(v, _mm256_set1_epi8('0'));
+			if(!_mm256_testz_si256(digits, invalid)) return false;
+
+			const auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_slli_epi16(reverse_bytes(digits), 7)));
+			std::memcpy(bytes + pos / 8, &mask, sizeof(mask));
+		}
+#elif defined(__SSE2__)
+		const __m128i invalid = _mm_set1_epi8(static_cast<char>(0xFE));
+		for(; length - pos >= 16; pos += 16)
+		{
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(chars + length - pos - 16));
+			const __m128i digits = _mm_xor_si128(v, _mm_set1_epi8('0'));
+			if(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(digits, invalid), _mm_setzero_si128())) != 0xFFFF) return false;
+
+			const auto mask = static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_slli_epi16(reverse_bytes(digits), 7)));
+			std::memcpy(bytes + pos / 8, &mask, sizeof(mask));
+		}
+#endif
+		for(; length - pos >= 8; pos += 8)
+			if(!chars_to_byte(chars + length - pos - 8, bytes[pos / 8])) return false;
+
+		for(; pos < length; ++pos)
+		{
+			const char c = chars[length - pos - 1];
+			if(c != '0' && c != '1') return false;
+			if(c == '1') bytes[pos / 8] |= static_cast<unsigned char>(1u << (pos % 8));
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Общая часть from_chars наборов: проверяем длину и символы и разбираем строку в обнулённый массив
+	 * @param width Наибольшая длина строки
+	 * @return ec == errc::invalid_argument и ptr на первый неверный символ (или на first для пустой строки),
+	 * ec == errc::result_out_of_range, если строка длиннее width
+	 */
+	inline std::from_chars_result bits_from_chars(const char* first, const char* last, void* data, std::size_t width) noexcept
+	{
+		const auto length = static_cast<std::size_t>(last - first);
+		if(length == 0) return {first, std::errc::invalid_argument};
+		if(length > width) return {last, std::errc::result_out_of_range};
+
+		if(!chars_to_bits(first, length, data))
+		{
+			const char* bad = first;
+			while(*bad == '0' || *bad == '1') ++bad;
+			return {bad, std::errc::invalid_argument};
+		}
+		return {last, std::errc()};
+	}
+}
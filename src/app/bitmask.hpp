@@ -2,19 +2,59 @@
 
 #include <bits/stdc++.h>
 #include "all.hpp"
+#include "bitwords.hpp"
+#include "bit_expression.hpp"
+#include "bitchars.hpp"
+#include "enum_reflection.hpp"
 
 /**
  * @brief Класс, описывающий битовую маску. Работает только с перечислением.
+ * @details Если элементы помещаются в базовый тип перечисления, маска - одно слово этого типа.
+ * Иначе (например, перечисление из 200 возможностей) маска хранится в массиве 64-битных слов.
+ * Операции с несколькими элементами (has(a, b, c), set, reset) сначала собирают маски по словам, а затем
+ * проверяют или меняют все слова за один проход; для констант компилятор сворачивает сборку масок целиком.
  * @tparam Enum Перечисление, для которого создаётся маска.
- * @tparam N Количество элементов в перечислении.
+ * @tparam N Количество элементов в перечислении. По умолчанию берётся из рефлексии (enum_size), которая видит только
+ * значения ниже UTILS_ENUM_RANGE: перечисление с большими значениями должно объявить MaxValue. Индекс не меньше N -
+ * ошибка, в отладочной сборке её ловит assert.
  */
-template<typename Enum, typename std::underlying_type<Enum>::type N>
+template<typename Enum, typename std::underlying_type<Enum>::type N = static_cast<typename std::underlying_type<Enum>::type>(enum_size<Enum>)>
 struct BitMask
 {
-	using type_t = typename std::underlying_type<Enum>::type;
+	using enum_t = Enum;
+	using underlying_t = typename std::underlying_type<Enum>::type;
+
+	/**
+	 * @brief Тип слова маски: базовый тип перечисления, если маска в него помещается, иначе uint64_t
+	 */
+	using type_t = std::conditional_t<(N <= sizeof(underlying_t) * 8), underlying_t, std::uint64_t>;
 
 	static_assert(std::is_enum<Enum>::value, "BitMask can be used only with enum types");
 	static_assert(std::is_unsigned<typename std::underlying_type<Enum>::type>::value, "Enum's underlying type must be unsigned");
+	static_assert(N > 0, "BitMask needs at least one element: declare MaxValue for enums with values at or above UTILS_ENUM_RANGE");
+
+	/**
+	 * @brief Итератор по выставленным битам маски, возвращает сами значения перечисления
+	 */
+	using const_iterator = detail::set_bit_iterator<type_t, Enum>;
+	using iterator = const_iterator;
+
+	static constexpr std::size_t word_bits = sizeof(type_t) * 8;
+
+	/**
+	 * @brief Количество слов, в которых хранится маска
+	 */
+	static constexpr std::size_t word_count = N ? (N + word_bits - 1) / word_bits : 1;
+
+	/**
+	 * @brief Количество битов в маске
+	 */
+	static constexpr std::size_t bit_count = N;
+
+	/**
+	 * @brief Длина строкового представления маски (to_string, to_chars): вся ширина слов маски
+	 */
+	static constexpr std::size_t chars_size = word_count * word_bits;
 
 	/**
 	 * @brief Конструктор по умолчанию. Создает пустой набор.
@@ -48,19 +88,78 @@ struct BitMask
 	}
 
 	/**
-	 * @brief Конструктор от значения типа, который хранится в наборе
+	 * @brief Конструктор от значения типа, который хранится в наборе. Доступен только для маски из одного слова.
 	 * @param value Значение типа, который хранится в наборе
-	 * @tparam T Тип значения. Должен быть таким же, как и тип элемента набора
 	 */
+	template<std::size_t W = word_count, typename = typename std::enable_if<W == 1>::type>
 	explicit constexpr BitMask(type_t value) noexcept
 	{
-		_value = value & get_strip_mask();
+		_words[0] = value & tail_mask();
 	}
 
 	BitMask& operator=(const BitMask& other) = default;
 
 	BitMask& operator=(BitMask&& other) = default;
 
+	/**
+	 * @brief Вычисляем в маску логическое выражение над масками того же типа (a & b, (a | b) & ~c и т.д.)
+	 * @param expr Выражение, см. bit_expression.hpp
+	 */
+	template<typename E, typename = typename std::enable_if<detail::is_bit_expression<E>::value &&
+															std::is_same<typename E::set_t, BitMask>::value>::type>
+	BitMask(const E& expr) noexcept
+	{
+		detail::bit_expression_assign(_words, expr);
+	}
+
+	template<typename E, typename = typename std::enable_if<detail::is_bit_expression<E>::value &&
+															std::is_same<typename E::set_t, BitMask>::value>::type>
+	BitMask& operator=(const E& expr) noexcept
+	{
+		detail::bit_expression_assign(_words, expr);
+		return *this;
+	}
+
+	/**
+	 * @brief Пересечение масок
+	 * @param other Вторая маска или выражение
+	 */
+	template<typename E, typename = detail::enable_bit_operand_of<BitMask, E>>
+	inline BitMask& operator&=(const E& other) noexcept
+	{
+		return *this = *this & other;
+	}
+
+	/**
+	 * @brief Объединение масок
+	 * @param other Вторая маска или выражение
+	 */
+	template<typename E, typename = detail::enable_bit_operand_of<BitMask, E>>
+	inline BitMask& operator|=(const E& other) noexcept
+	{
+		return *this = *this | other;
+	}
+
+	/**
+	 * @brief Симметрическая разность масок
+	 * @param other Вторая маска или выражение
+	 */
+	template<typename E, typename = detail::enable_bit_operand_of<BitMask, E>>
+	inline BitMask& operator^=(const E& other) noexcept
+	{
+		return *this = *this ^ other;
+	}
+
+	/**
+	 * @brief Разность масок: убираем из текущей маски все элементы другой (this & ~other)
+	 * @param other Вторая маска или выражение
+	 */
+	template<typename E, typename = detail::enable_bit_operand_of<BitMask, E>>
+	inline BitMask& and_not(const E& other) noexcept
+	{
+		return *this = ::and_not(*this, other);
+	}
+
 	/**
 	 * @brief Оператор списковой инициализации
 	 * @param list Список из индексов битов, которые нужно выставить в 1
@@ -69,38 +168,31 @@ struct BitMask
 	template<typename T, typename = typename std::enable_if<std::is_same<Enum, T>::value>::type>
 	BitMask& operator=(const std::initializer_list<T>& list) noexcept
 	{
-		// если список пустой значение можно сбросить
-		if(!list.size())
-			_value = 0;
-
+		reset();
 		for(const auto& index : list)
-		{
-			_value |= static_cast<type_t>(1) << static_cast<type_t>(index);
-		}
-
-		// удаляем  лишние биты
-		_value = _value &  get_strip_mask();
+			set_impl(index);
 		return *this;
 	}
 
 	/**
-	 * @brief Оператор присваивания от целого
+	 * @brief Оператор присваивания от целого. Доступен только для маски из одного слова.
 	 * @param value Значение типа, который хранится в наборе
-	 * @tparam T Тип значения. Должен быть таким же, как и тип элемента набора
 	 */
+	template<std::size_t W = word_count, typename = typename std::enable_if<W == 1>::type>
 	BitMask& operator=(type_t value) noexcept
 	{
-		_value = value & get_strip_mask();
+		_words[0] = value & tail_mask();
 		return *this;
 	}
 
 	/**
-	 * @brief Приводим BitMask к значению типа, который хранится в наборе
+	 * @brief Приводим BitMask к значению типа, который хранится в наборе. Доступно только для маски из одного слова.
 	 * @return Значение типа, который хранится в наборе
 	 */
+	template<std::size_t W = word_count, typename = typename std::enable_if<W == 1>::type>
 	inline operator type_t() const
 	{
-		return _value;
+		return _words[0];
 	}
 
 	/**
@@ -165,15 +257,10 @@ struct BitMask
 	inline bool has(T index, Args&&... args) const noexcept
 	{
 		static_assert(std::is_same<Enum, T>::value, "has parameters type must be same as Enum");
-		static_assert(all_same<Enum, Args...>::value, "has parameters type must be same as Enum");
-
-		if(!has_impl(index)) return false;
+		static_assert(all_same<Enum, std::decay_t<Args>...>::value, "has parameters type must be same as Enum");
 
-		for(const auto& arg : {args...})
-		{
-			if(!has_impl(arg)) return false;
-		}
-		return true;
+		const BitMask wanted = masks_of(index, args...);
+		return has(wanted);
 	}
 
 	/**
@@ -181,7 +268,7 @@ struct BitMask
 	 * @param index Индекс
 	 * @return true, если по переданному индексу бит выставлен
 	 */	
-	template<typename T>
+	template<typename T, typename = typename std::enable_if<!detail::is_bit_operand<T>::value>::type>
 	inline bool has(T index) const noexcept
 	{
 		static_assert(std::is_same<Enum, T>::value, "has parameters type must be same as Enum");
@@ -196,7 +283,21 @@ struct BitMask
 	 */
 	inline bool has(const BitMask& other) const noexcept
 	{
-		return (_value & other._value) == other._value;
+		type_t missing = 0;
+		for(std::size_t i = 0; i < word_count; ++i)
+			missing |= other._words[i] & static_cast<type_t>(~_words[i]);
+		return !missing;
+	}
+
+	/**
+	 * @brief Проверяем, выставлены ли в маске все биты результата выражения. Выражение не сохраняется в памяти.
+	 * @param expr Выражение над масками того же типа
+	 */
+	template<typename E, typename = typename std::enable_if<detail::is_bit_expression<E>::value &&
+															std::is_same<typename E::set_t, BitMask>::value>::type>
+	inline bool has(const E& expr) const noexcept
+	{
+		return detail::bit_expression_contains(*this, expr);
 	}
 
 	/**
@@ -205,7 +306,10 @@ struct BitMask
 	 */
 	inline bool any() const noexcept
 	{
-		return _value;
+		type_t result = 0;
+		for(std::size_t i = 0; i < word_count; ++i)
+			result |= _words[i];
+		return result;
 	}
 
 	/**
@@ -214,7 +318,9 @@ struct BitMask
 	 */
 	inline bool all() const noexcept
 	{
-		return _value == get_strip_mask();
+		for(std::size_t i = 0; i + 1 < word_count; ++i)
+			if(_words[i] != static_cast<type_t>(~static_cast<type_t>(0))) return false;
+		return _words[word_count - 1] == tail_mask();
 	}
 
 	/**
@@ -223,29 +329,47 @@ struct BitMask
 	 */
 	inline bool empty() const noexcept
 	{
-		return !_value;		
+		return !any();
 	}
 
 	/**
-	 * @brief Устанавливаем значение в маску
-	 * @param value Значение типа, который хранится в наборе
-	 * @tparam T Тип значения. Должен быть таким же, как и тип элемента набора
+	 * @brief Устанавливаем значения в маску
+	 * @param index, args Элементы перечисления, биты которых нужно выставить
+	 * @tparam T, Args Тип элементов. Должен быть таким же, как и тип элемента набора
 	 */
-	template<typename T, typename = typename std::enable_if<std::is_same<Enum, T>::value>::type>
-	inline void set(T index) noexcept
+	template<typename T, typename... Args, typename = typename std::enable_if<all_same<Enum, T, std::decay_t<Args>...>::value>::type>
+	inline void set(T index, Args&&... args) noexcept
 	{
-		set_impl(index);
+		if constexpr (!sizeof...(Args))
+		{
+			set_impl(index);
+		}
+		else
+		{
+			const BitMask bits = masks_of(index, args...);
+			for(std::size_t i = 0; i < word_count; ++i)
+				_words[i] |= bits._words[i];
+		}
 	}
 
 	/**
-	 * @brief Сбрасываем бит в маске
-	 * @param index Индекс бита, который мы хотим выставить в false в маске
-	 * @tparam T тип параметра, должен совпадать с Enum
+	 * @brief Сбрасываем биты в маске
+	 * @param index, args Элементы перечисления, биты которых нужно сбросить
+	 * @tparam T, Args тип параметров, должен совпадать с Enum
 	 */
-	template<typename T, typename = typename std::enable_if<std::is_same<Enum, T>::value>::type>
-	inline void reset(T index) noexcept
+	template<typename T, typename... Args, typename = typename std::enable_if<all_same<Enum, T, std::decay_t<Args>...>::value>::type>
+	inline void reset(T index, Args&&... args) noexcept
 	{
-		reset_impl(index);
+		if constexpr (!sizeof...(Args))
+		{
+			reset_impl(index);
+		}
+		else
+		{
+			const BitMask bits = masks_of(index, args...);
+			for(std::size_t i = 0; i < word_count; ++i)
+				_words[i] &= static_cast<type_t>(~bits._words[i]);
+		}
 	}
 
 	/**
@@ -255,16 +379,39 @@ struct BitMask
 	 */
 	inline void reset() noexcept
 	{
-		_value = 0;
+		for(auto& word : _words)
+			word = 0;
 	}
 
 	/**
-	 * @brief Возвращаем значение набора
+	 * @brief Возвращаем значение набора. Доступно только для маски из одного слова.
 	 * @return Значение набора
 	 */
+	template<std::size_t W = word_count, typename = typename std::enable_if<W == 1>::type>
 	inline type_t value() const noexcept
 	{
-		return _value;
+		return _words[0];
+	}
+
+	/**
+	 * @brief Возвращаем слово маски по его номеру
+	 */
+	inline type_t word(std::size_t index) const noexcept
+	{
+		return _words[index];
+	}
+
+	/**
+	 * @brief Указатель на слова маски
+	 */
+	inline const type_t* data() const noexcept
+	{
+		return _words;
+	}
+
+	inline type_t* data() noexcept
+	{
+		return _words;
 	}
 
 	/**
@@ -282,26 +429,206 @@ struct BitMask
 	 */
 	inline constexpr type_t count() const noexcept
 	{
-		//https://stackoverflow.com/questions/109023/count-the-number-of-set-bits-in-a-32-bit-integer/109025#109025
-		return __builtin_popcount(_value);
+		std::size_t result = 0;
+		for(std::size_t i = 0; i < word_count; ++i)
+			result += detail::word_popcount(_words[i]);
+		return static_cast<type_t>(result);
 	}
 
 	/**
 	 * @brief Возвращаем строковое представление набора
-	 * @return Строковое представление набора в бинарном виде
+	 * @return Строковое представление набора в бинарном виде из chars_size символов (вся ширина типа), старший бит первым
 	 */
 	std::string to_string() const noexcept
 	{
-		std::string str(sizeof(type_t) * allignment, '0');
-		for(type_t i = 0; i < sizeof(type_t) * allignment; ++i)
-			str[i] = (_value & (static_cast<type_t>(1) << (sizeof(type_t) * 8 - i - 1))) ? '1' : '0';
+		std::string str(chars_size, '0');
+		to_chars(str.data(), str.data() + str.size());
+		return str;
+	}
+
+	/**
+	 * @brief Записываем маску в буфер вызывающего в виде chars_size символов '0'/'1', старший бит первым (как to_string)
+	 * @param first Начало буфера
+	 * @param last Конец буфера
+	 * @return ptr - конец записанного; ec == errc::value_too_large и ptr == last, если буфер меньше chars_size
+	 */
+	std::to_chars_result to_chars(char* first, char* last) const noexcept
+	{
+		if(static_cast<std::size_t>(last - first) < chars_size) return {last, std::errc::value_too_large};
+		detail::bits_to_chars(_words, chars_size, first);
+		return {first + chars_size, std::errc()};
+	}
+
+	/**
+	 * @brief Разбираем строку из '0'/'1', старший бит первым. Строка короче chars_size дополняется нулями слева.
+	 * @details При ошибке маска не меняется. ec == errc::invalid_argument для пустой строки или постороннего символа
+	 * (ptr указывает на него), ec == errc::result_out_of_range для строки длиннее chars_size
+	 * или с выставленными битами, которых нет в перечислении.
+	 * @param first Начало строки
+	 * @param last Конец строки
+	 */
+	std::from_chars_result from_chars(const char* first, const char* last) noexcept
+	{
+		type_t words[word_count]{};
+		const auto result = detail::bits_from_chars(first, last, words, chars_size);
+		if(result.ec != std::errc()) return result;
+		if(words[word_count - 1] & static_cast<type_t>(~tail_mask())) return {last, std::errc::result_out_of_range};
+		std::copy(std::begin(words), std::end(words), _words);
+		return result;
+	}
+
+	/**
+	 * @brief Записываем имена выставленных элементов через '|' ("Red|Blue") в буфер вызывающего
+	 * @details Элементы без имени в перечислении записываются номером. Для пустой маски ничего не пишется.
+	 * @param first Начало буфера
+	 * @param last Конец буфера
+	 * @return ptr - конец записанного; ec == errc::value_too_large и ptr == last, если буфера не хватило
+	 */
+	std::to_chars_result to_names(char* first, char* last) const noexcept
+	{
+		char* out = first;
+		for(const Enum index : *this)
+		{
+			if(out != first)
+			{
+				if(out == last) return {last, std::errc::value_too_large};
+				*out++ = '|';
+			}
+
+			const std::string_view name = enum_traits<Enum>::name(index);
+			if(name.empty())
+			{
+				const auto result = std::to_chars(out, last, static_cast<std::size_t>(index));
+				if(result.ec != std::errc()) return {last, std::errc::value_too_large};
+				out = result.ptr;
+				continue;
+			}
+			if(static_cast<std::size_t>(last - out) < name.size()) return {last, std::errc::value_too_large};
+			out = std::copy(name.begin(), name.end(), out);
+		}
+		return {out, std::errc()};
+	}
+
+	/**
+	 * @brief Имена выставленных элементов через '|'
+	 */
+	std::string to_names() const
+	{
+		std::string str;
+		for(const Enum index : *this)
+		{
+			if(!str.empty()) str += '|';
+			const std::string_view name = enum_traits<Enum>::name(index);
+			if(name.empty()) str += std::to_string(static_cast<std::size_t>(index));
+			else str += name;
+		}
 		return str;
 	}
 
+	/**
+	 * @brief Разбираем имена элементов через '|' ("Red|Blue"). Пробелы вокруг имён пропускаются, вместо имени можно указать номер.
+	 * @details Имя ищется по совершенной хеш-таблице enum_traits: один хеш и одно сравнение на имя.
+	 * Пустая строка - пустая маска. При ошибке маска не меняется, ec == errc::invalid_argument,
+	 * ptr указывает на начало неизвестного или пустого имени.
+	 * @param first Начало строки
+	 * @param last Конец строки
+	 */
+	std::from_chars_result from_names(const char* first, const char* last) noexcept
+	{
+		const auto is_space = [](char c) { return c == ' ' || c == '\t'; };
+
+		//строка из одних пробелов - пустая маска
+		type_t words[word_count]{};
+		if(std::find_if_not(first, last, is_space) != last)
+		{
+			for(const char* token = first;;)
+			{
+				const char* end = std::find(token, last, '|');
+				const char* name_first = std::find_if_not(token, end, is_space);
+				const char* name_last = end;
+				while(name_last != name_first && is_space(name_last[-1])) --name_last;
+				if(name_first == name_last) return {name_first, std::errc::invalid_argument};
+
+				Enum index{};
+				std::size_t number = 0;
+				if(enum_traits<Enum>::from_name(std::string_view(name_first, static_cast<std::size_t>(name_last - name_first)), index))
+					number = static_cast<std::size_t>(index);
+				else if(std::from_chars(name_first, name_last, number).ptr != name_last)
+					return {name_first, std::errc::invalid_argument};
+
+				if(number >= N) return {name_first, std::errc::invalid_argument};
+				words[number / word_bits] |= bit_mask(number);
+
+				if(end == last) break;
+				token = end + 1;
+			}
+		}
+		std::copy(std::begin(words), std::end(words), _words);
+		return {last, std::errc()};
+	}
+
+	/**
+	 * @brief Маска из имён элементов через '|' ("Red|Blue")
+	 * @throw std::invalid_argument Если в строке есть неизвестное или пустое имя
+	 */
+	static BitMask parse(std::string_view names)
+	{
+		BitMask mask;
+		const auto result = mask.from_names(names.data(), names.data() + names.size());
+		if(result.ec != std::errc())
+			throw std::invalid_argument("BitMask: unknown flag name at position " + std::to_string(result.ptr - names.data()));
+		return mask;
+	}
+
+	/**
+	 * @brief Ищем первый выставленный элемент маски
+	 * @return Элемент перечисления или Enum(N), если маска пустая
+	 */
+	inline Enum find_first() const noexcept
+	{
+		return static_cast<Enum>(std::min<std::size_t>(detail::words_find_from(_words, word_count, 0), N));
+	}
+
+	/**
+	 * @brief Ищем следующий выставленный элемент маски после index
+	 * @param index Элемент, после которого начинаем поиск
+	 * @tparam T тип параметра, должен совпадать с Enum
+	 * @return Элемент перечисления или Enum(N), если после index выставленных элементов нет
+	 */
+	template<typename T, typename = typename std::enable_if<std::is_same<Enum, T>::value>::type>
+	inline Enum find_next(T index) const noexcept
+	{
+		const std::size_t from = static_cast<std::size_t>(index) + 1;
+		return static_cast<Enum>(std::min<std::size_t>(detail::words_find_from(_words, word_count, from), N));
+	}
+
+	/**
+	 * @brief Ищем последний выставленный элемент маски
+	 * @return Элемент перечисления или Enum(N), если маска пустая
+	 */
+	inline Enum find_last() const noexcept
+	{
+		return static_cast<Enum>(std::min<std::size_t>(detail::words_find_last(_words, word_count), N));
+	}
+
+	/**
+	 * @brief Итератор на первый выставленный элемент. Range-for по маске обходит только выставленные элементы.
+	 */
+	inline const_iterator begin() const noexcept
+	{
+		return const_iterator(_words, word_count, 0);
+	}
+
+	/**
+	 * @brief Итератор конца обхода выставленных элементов
+	 */
+	inline const_iterator end() const noexcept
+	{
+		return const_iterator(_words, word_count, word_count);
+	}
+
 private:
 
-	static constexpr type_t allignment = 8;
-	
 	/**
 	 * @brief Класс для работы с отдельным битом в наборе
 	 */
@@ -309,17 +636,17 @@ private:
     {
     public:
 		/**
-		 * @brief В конструкторе ссылки сохраняем ссылку на основной контейнер и индекс бита, с которым будем работать
+		 * @brief В конструкторе ссылки сохраняем ссылку на слово с битом и номер бита в слове
 		 */
-        reference(type_t& value, Enum index) 
-            : _value(value), _index(index) {}
+        reference(type_t& word, std::size_t bit) 
+            : _word(word), _bit(bit) {}
 
 		/**
 		 * @brief Оператор приведения к bool для проверки значения бита в наборе
 		 */
         operator bool() const noexcept
         {
-            return _value & (static_cast<type_t>(1) << static_cast<type_t>(_index));
+            return _word & (static_cast<type_t>(1) << _bit);
         }
 
 		/**
@@ -329,9 +656,9 @@ private:
         reference& operator=(bool flag) noexcept
         {
             if (flag)
-                _value |= (static_cast<type_t>(1) << static_cast<type_t>(_index));
+                _word |= (static_cast<type_t>(1) << _bit);
             else
-                _value &= ~(static_cast<type_t>(1) << static_cast<type_t>(_index));
+                _word &= static_cast<type_t>(~(static_cast<type_t>(1) << _bit));
             return *this;
         }
 
@@ -345,11 +672,19 @@ private:
         }
 
     private:
-        type_t& _value;
-        Enum _index;
+        type_t& _word;
+        std::size_t _bit;
     };
 
-	type_t _value{0};
+	type_t _words[word_count]{};
+
+	/**
+	 * @brief Бит номера number внутри его слова
+	 */
+	static constexpr type_t bit_mask(std::size_t number) noexcept
+	{
+		return static_cast<type_t>(static_cast<type_t>(1) << (number % word_bits));
+	}
 
 	/**
 	 * @brief Проверяем выставлен ли бит номер index в наборе
@@ -358,7 +693,9 @@ private:
 	 */
 	inline bool has_impl(Enum index) const noexcept
 	{
-		return _value & (static_cast<type_t>(1) << static_cast<type_t>(index));
+		const auto number = static_cast<std::size_t>(index);
+		assert(number < N);
+		return _words[number / word_bits] & bit_mask(number);
 	}
 
 	/**
@@ -367,7 +704,9 @@ private:
 	 */
 	inline void set_impl(Enum index) noexcept
 	{
-		_value |= (static_cast<type_t>(1) << static_cast<type_t>(index));
+		const auto number = static_cast<std::size_t>(index);
+		assert(number < N);
+		_words[number / word_bits] |= bit_mask(number);
 	}
 
 	/**
@@ -376,18 +715,30 @@ private:
 	 */
 	inline void reset_impl(Enum index) noexcept
 	{
-		_value &= ~(static_cast<type_t>(1) << static_cast<type_t>(index));
+		const auto number = static_cast<std::size_t>(index);
+		assert(number < N);
+		_words[number / word_bits] &= static_cast<type_t>(~bit_mask(number));
 	}
 
 	/**
-	 * @brief Получаем маску
-	 * @return маска для обрезки бит
+	 * @brief Маска значащих бит последнего слова. Если N кратно размеру слова, значащие все биты.
 	 */
-	static constexpr type_t get_strip_mask() noexcept
+	static constexpr type_t tail_mask() noexcept
 	{
-		type_t mask = ~static_cast<type_t>(0);
-		mask >>= sizeof(type_t) * allignment - N;
-		return mask;
+		return N % word_bits ? static_cast<type_t>((static_cast<type_t>(1) << (N % word_bits)) - 1) : static_cast<type_t>(~static_cast<type_t>(0));
+	}
+
+	/**
+	 * @brief Маска из перечисленных элементов: биты раскладываются по словам, и проверка или изменение
+	 * нескольких элементов выполняется одним проходом по словам, а не отдельной операцией на каждый элемент
+	 */
+	template<typename... Args>
+	static constexpr BitMask masks_of(Args... args) noexcept
+	{
+		assert(((static_cast<std::size_t>(args) < N) && ...));
+		BitMask result;
+		((result._words[static_cast<std::size_t>(args) / word_bits] |= bit_mask(static_cast<std::size_t>(args))), ...);
+		return result;
 	}
 
 public:
@@ -403,19 +754,20 @@ public:
 	template<typename T, typename = typename std::enable_if<std::is_same<Enum, T>::value>::type>
 	inline reference operator[](T index) noexcept
 	{
-		return reference(_value, index);
+		assert(static_cast<std::size_t>(index) < N);
+		return reference(_words[static_cast<std::size_t>(index) / word_bits], static_cast<std::size_t>(index) % word_bits);
 	}
 
 	/**
 	 * @brief Оператор доступа к биту по индексу 
 	 * @param index Индекс бита, к которому нужно получить доступ
 	 * @tparam T Тип индекса, должен быть таким же, как и Enum
-	 * @return Ссылка на бит по указанному индексу
+	 * @return Значение бита по указанному индексу
 	 */
 	template<typename T, typename = typename std::enable_if<std::is_same<Enum, T>::value>::type>
-	inline const reference operator[](T index) const noexcept
+	inline bool operator[](T index) const noexcept
 	{
-		return reference(_value, index);
+		return has_impl(index);
 	}
 
 	/**
@@ -427,18 +779,25 @@ public:
 	template<typename T, typename = typename std::enable_if<std::is_same<Enum, T>::value>::type>
 	inline reference at(T index) noexcept
 	{
-		return reference(_value, index);
+		assert(static_cast<std::size_t>(index) < N);
+		return reference(_words[static_cast<std::size_t>(index) / word_bits], static_cast<std::size_t>(index) % word_bits);
 	}
 
 	/**
 	 * @brief Метод доступа к биту по индексу 
 	 * @param index Индекс бита, к которому нужно получить доступ
 	 * @tparam T Тип индекса, должен быть таким же, как и Enum
-	 * @return Ссылка на бит по указанному индексу
+	 * @return Значение бита по указанному индексу
 	 */
 	template<typename T, typename = typename std::enable_if<std::is_same<Enum, T>::value>::type>
-	inline const reference at(T index) const noexcept
+	inline bool at(T index) const noexcept
 	{
-		return reference(_value, index);
+		return has_impl(index);
 	}
 };
+
+namespace detail
+{
+	template<typename Enum, typename std::underlying_type<Enum>::type N>
+	struct is_bit_leaf<BitMask<Enum, N>> : std::true_type {};
+}
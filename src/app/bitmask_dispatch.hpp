@@ -0,0 +1,112 @@
+#pragma once
+
+#include <bits/stdc++.h>
+#include "bitmask.hpp"
+
+
+namespace detail
+{
+	/**
+	 * @brief Вызываем обработчик элемента E: с std::integral_constant<Enum, E>, если он так вызывается
+	 * (значение известно при компиляции и неявно приводится к Enum), иначе без аргументов
+	 */
+	template<typename Enum, std::size_t E, typename H>
+	inline void dispatch_invoke(H& handler)
+	{
+		using value_t = std::integral_constant<Enum, static_cast<Enum>(E)>;
+		if constexpr (std::is_invocable<H&, value_t>::value)
+			handler(value_t{});
+		else
+			handler();
+	}
+
+	/**
+	 * @brief Ячейка таблицы переходов для элемента E. Один обработчик на все элементы или свой на каждый.
+	 */
+	template<typename Enum, std::size_t E, typename Tuple>
+	void dispatch_entry(Tuple& handlers)
+	{
+		if constexpr (std::tuple_size<Tuple>::value == 1)
+			dispatch_invoke<Enum, E>(std::get<0>(handlers));
+		else
+			dispatch_invoke<Enum, E>(std::get<E>(handlers));
+	}
+
+	template<typename Enum, typename Tuple, std::size_t... E>
+	constexpr std::array<void (*)(Tuple&), sizeof...(E)> dispatch_table(std::index_sequence<E...>) noexcept
+	{
+		return {{&dispatch_entry<Enum, E, Tuple>...}};
+	}
+
+	/**
+	 * @brief Обходим выставленные биты маски через ctz и для каждого делаем один переход по таблице
+	 */
+	template<typename Mask, typename Tuple>
+	inline void dispatch_set_bits(const Mask& mask, Tuple& handlers)
+	{
+		using enum_t = typename Mask::enum_t;
+		using type_t = typename Mask::type_t;
+
+		static constexpr auto table = dispatch_table<enum_t, Tuple>(std::make_index_sequence<Mask::bit_count>());
+
+		//биты за пределами bit_count в маске всегда сброшены, поэтому номер бита - всегда допустимый индекс таблицы
+		for(std::size_t i = 0; i < Mask::word_count; ++i)
+		{
+			for(type_t word = mask.word(i); word; word = static_cast<type_t>(word & (word - 1)))
+				table[i * Mask::word_bits + word_ctz(word)](handlers);
+		}
+	}
+}
+
+/**
+ * @brief Вызываем обработчики выставленных элементов маски в порядке возрастания
+ * @details handlers - либо один обработчик на все элементы, либо ровно bit_count обработчиков, i-й для элемента i.
+ * Обработчик принимает std::integral_constant<Enum, E> (или Enum, или auto - тогда внутри доступен if constexpr по значению)
+ * либо не принимает ничего. Для каждого элемента при компиляции строится своя функция со встроенным обработчиком,
+ * их адреса лежат в constexpr таблице переходов. Обход стоит один ctz и один косвенный вызов на выставленный бит
+ * вместо проверки has() и ветвления на каждый возможный элемент.
+ */
+template<typename Enum, typename std::underlying_type<Enum>::type N, typename... Handlers>
+inline void for_each_set(const BitMask<Enum, N>& mask, Handlers&&... handlers)
+{
+	static_assert(sizeof...(Handlers) == 1 || sizeof...(Handlers) == N, "for_each_set needs one handler or one handler per enumerator");
+
+	auto refs = std::forward_as_tuple(handlers...);
+	detail::dispatch_set_bits(mask, refs);
+}
+
+/**
+ * @brief Диспетчер: обработчики сохраняются один раз, затем вызываются для выставленных элементов каждой маски
+ * @details То же, что for_each_set, но без повторной передачи обработчиков в горячем цикле.
+ * @tparam Mask Тип маски (BitMask)
+ * @tparam Handlers Один обработчик на все элементы или по обработчику на каждый
+ */
+template<typename Mask, typename... Handlers>
+struct FlagDispatcher
+{
+	static_assert(sizeof...(Handlers) == 1 || sizeof...(Handlers) == Mask::bit_count, "FlagDispatcher needs one handler or one handler per enumerator");
+
+	explicit FlagDispatcher(Handlers... handlers)
+		: _handlers(std::move(handlers)...) {}
+
+	/**
+	 * @brief Вызываем обработчики выставленных элементов маски
+	 */
+	inline void operator()(const Mask& mask)
+	{
+		detail::dispatch_set_bits(mask, _handlers);
+	}
+
+private:
+
+	std::tuple<Handlers...> _handlers;
+};
+
+/**
+ * @brief Создаём диспетчер для масок типа Mask
+ */
+template<typename Mask, typename... Handlers>
+inline FlagDispatcher<Mask, std::decay_t<Handlers>...> make_dispatcher(Handlers&&... handlers)
+{
+	return FlagDispatcher<Mask, std::decay_t<Handlers>...>(std::forward<Handlers>(handlers)...);
+}
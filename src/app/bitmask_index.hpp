@@ -0,0 +1,338 @@
+#pragma once
+
+#include <bits/stdc++.h>
+#include "bitmask.hpp"
+#include "dynamic_bitset.hpp"
+#include "popcount.hpp"
+
+
+/**
+ * @brief Битовый индекс по столбцу масок: для каждого значения перечисления хранится битовая карта строк, в которых оно выставлено
+ * @details Вместо проверки has() для каждой записи условие вида has(A, B) && !has(C) вычисляется над картами
+ * векторными AND/ANDNOT по блокам слов, помещающимся в L1: блок результата сразу считается или перебирается,
+ * весь результат целиком в память не записывается.
+ * @tparam Enum Перечисление маски
+ * @tparam N Количество значений перечисления, как у BitMask
+ */
+template<typename Enum, typename std::underlying_type<Enum>::type N>
+struct BitMaskIndex
+{
+	using mask_t = BitMask<Enum, N>;
+	using bitmap_t = DynamicBitSet<uint64_t>;
+	using word_t = typename bitmap_t::type_t;
+
+	/**
+	 * @brief Количество бит в одном слове карты
+	 */
+	static constexpr std::size_t word_bits = bitmap_t::word_bits;
+
+	/**
+	 * @brief Количество слов, обрабатываемых за один шаг запроса (16384 строки, 2 КБ на буфер)
+	 */
+	static constexpr std::size_t chunk_words = 256;
+
+	/**
+	 * @brief Запрос к индексу: строка подходит, если в ней выставлены все значения из has(),
+	 * хотя бы одно из has_any() (если оно задано) и ни одного из has_none()
+	 */
+	struct Query
+	{
+		explicit Query(const BitMaskIndex& index) noexcept : _index(&index) {}
+
+		/**
+		 * @brief Требуем, чтобы в строке были выставлены все перечисленные значения
+		 */
+		template<typename... Args, typename = typename std::enable_if<all_same<Enum, std::decay_t<Args>...>::value>::type>
+		inline Query& has(Args&&... values) noexcept
+		{
+			(_all.set(values), ...);
+			return *this;
+		}
+
+		inline Query& has(const mask_t& mask) noexcept
+		{
+			_all |= mask;
+			return *this;
+		}
+
+		/**
+		 * @brief Требуем, чтобы в строке было выставлено хотя бы одно из перечисленных значений
+		 */
+		template<typename... Args, typename = typename std::enable_if<all_same<Enum, std::decay_t<Args>...>::value>::type>
+		inline Query& has_any(Args&&... values) noexcept
+		{
+			(_any.set(values), ...);
+			return *this;
+		}
+
+		inline Query& has_any(const mask_t& mask) noexcept
+		{
+			_any |= mask;
+			return *this;
+		}
+
+		/**
+		 * @brief Требуем, чтобы в строке не было ни одного из перечисленных значений
+		 */
+		template<typename... Args, typename = typename std::enable_if<all_same<Enum, std::decay_t<Args>...>::value>::type>
+		inline Query& has_none(Args&&... values) noexcept
+		{
+			(_none.set(values), ...);
+			return *this;
+		}
+
+		inline Query& has_none(const mask_t& mask) noexcept
+		{
+			_none |= mask;
+			return *this;
+		}
+
+		/**
+		 * @brief Считаем количество подходящих строк
+		 */
+		std::size_t count() const noexcept
+		{
+			std::size_t result = 0;
+			evaluate([&result](std::size_t, const word_t* words, std::size_t n) {
+				result += detail::bytes_popcount(words, n * sizeof(word_t));
+			});
+			return result;
+		}
+
+		/**
+		 * @brief Вызываем функцию для номера каждой подходящей строки по возрастанию
+		 * @param f Функция вида void(std::size_t row)
+		 */
+		template<typename F>
+		void for_each(F&& f) const
+		{
+			evaluate([&f](std::size_t first_word, const word_t* words, std::size_t n) {
+				for(std::size_t i = 0; i < n; ++i)
+				{
+					for(word_t word = words[i]; word; word &= word - 1)
+						f((first_word + i) * word_bits + detail::word_ctz(word));
+				}
+			});
+		}
+
+		/**
+		 * @brief Номера подходящих строк по возрастанию
+		 */
+		std::vector<std::size_t> rows() const
+		{
+			std::vector<std::size_t> result;
+			for_each([&result](std::size_t row) { result.push_back(row); });
+			return result;
+		}
+
+		/**
+		 * @brief Результат запроса в виде битовой карты строк
+		 */
+		bitmap_t bitmap() const
+		{
+			bitmap_t result(_index->size());
+			evaluate([&result](std::size_t first_word, const word_t* words, std::size_t n) {
+				std::memcpy(result.data() + first_word, words, n * sizeof(word_t));
+			});
+			return result;
+		}
+
+	private:
+
+		const BitMaskIndex* _index;
+		mask_t _all;
+		mask_t _any;
+		mask_t _none;
+
+		/**
+		 * @brief Вычисляем условие по блокам слов и передаём каждый блок в f(first_word, words, n)
+		 */
+		template<typename F>
+		void evaluate(F&& f) const
+		{
+			const std::size_t words = _index->word_count();
+			word_t result[chunk_words];
+			word_t any[chunk_words];
+
+			for(std::size_t base = 0; base < words; base += chunk_words)
+			{
+				const std::size_t n = std::min(chunk_words, words - base);
+
+				bool initialized = false;
+				for(Enum value : _all)
+				{
+					const word_t* bitmap = _index->bitmap(value).data() + base;
+					if(initialized)
+						detail::words_apply<detail::and_op>(result, result, bitmap, n);
+					else
+						std::memcpy(result, bitmap, n * sizeof(word_t));
+					initialized = true;
+				}
+
+				if(_any.any())
+				{
+					std::memset(any, 0, n * sizeof(word_t));
+					for(Enum value : _any)
+						detail::words_apply<detail::or_op>(any, any, _index->bitmap(value).data() + base, n);
+
+					if(initialized)
+						detail::words_apply<detail::and_op>(result, result, any, n);
+					else
+						std::memcpy(result, any, n * sizeof(word_t));
+					initialized = true;
+				}
+
+				//без положительных условий подходят все строки, кроме исключённых
+				if(!initialized)
+				{
+					std::fill(result, result + n, ~static_cast<word_t>(0));
+					if(base + n == words && _index->size() % word_bits)
+						result[n - 1] = (static_cast<word_t>(1) << (_index->size() % word_bits)) - 1;
+				}
+
+				for(Enum value : _none)
+					detail::words_apply<detail::andnot_op>(result, result, _index->bitmap(value).data() + base, n);
+
+				f(base, static_cast<const word_t*>(result), n);
+			}
+		}
+	};
+
+	/**
+	 * @brief Конструктор по умолчанию. Создает пустой индекс.
+	 */
+	BitMaskIndex() = default;
+
+	/**
+	 * @brief Строим индекс по диапазону масок
+	 */
+	template<typename It>
+	BitMaskIndex(It first, It last)
+	{
+		append(first, last);
+	}
+
+	/**
+	 * @brief Добавляем в конец индекса одну строку
+	 */
+	void push_back(const mask_t& mask)
+	{
+		for(auto& bitmap : _bitmaps)
+			bitmap.resize(_rows + 1);
+		set_row(_rows, mask);
+		++_rows;
+	}
+
+	/**
+	 * @brief Добавляем в конец индекса строки из диапазона масок
+	 * @details Полные слова карт собираются транспонированием по 64 строки: маски блока раскладываются
+	 * по локальным словам, и каждое слово карты записывается один раз.
+	 */
+	template<typename It>
+	void append(It first, It last)
+	{
+		const std::size_t added = static_cast<std::size_t>(std::distance(first, last));
+		std::size_t row = _rows;
+
+		_rows += added;
+		for(auto& bitmap : _bitmaps)
+			bitmap.resize(_rows);
+
+		for(; first != last && row % word_bits; ++first, ++row)
+			set_row(row, *first);
+
+		for(; _rows - row >= word_bits; row += word_bits)
+		{
+			word_t block[N]{};
+			for(std::size_t i = 0; i < word_bits; ++i, ++first)
+			{
+				const mask_t& mask = *first;
+				for(Enum value : mask)
+					block[static_cast<std::size_t>(value)] |= static_cast<word_t>(1) << i;
+			}
+			for(std::size_t value = 0; value < N; ++value)
+				_bitmaps[value].data()[row / word_bits] = block[value];
+		}
+
+		for(; first != last; ++first, ++row)
+			set_row(row, *first);
+	}
+
+	/**
+	 * @brief Восстанавливаем маску строки
+	 * @param row Номер строки
+	 */
+	mask_t operator[](std::size_t row) const noexcept
+	{
+		mask_t result;
+		for(std::size_t value = 0; value < N; ++value)
+			if(_bitmaps[value][row]) result.set(static_cast<Enum>(value));
+		return result;
+	}
+
+	/**
+	 * @brief Начинаем запрос к индексу
+	 */
+	inline Query query() const noexcept
+	{
+		return Query(*this);
+	}
+
+	/**
+	 * @brief Считаем строки, в которых выставлены все значения required и не выставлено ни одного из excluded
+	 */
+	inline std::size_t count(const mask_t& required, const mask_t& excluded = mask_t()) const noexcept
+	{
+		return query().has(required).has_none(excluded).count();
+	}
+
+	/**
+	 * @brief Битовая карта строк, в которых выставлено значение
+	 */
+	inline const bitmap_t& bitmap(Enum value) const noexcept
+	{
+		return _bitmaps[static_cast<std::size_t>(value)];
+	}
+
+	/**
+	 * @brief Количество строк в индексе
+	 */
+	inline std::size_t size() const noexcept
+	{
+		return _rows;
+	}
+
+	inline bool empty() const noexcept
+	{
+		return _rows == 0;
+	}
+
+	/**
+	 * @brief Количество слов в каждой карте
+	 */
+	inline std::size_t word_count() const noexcept
+	{
+		return (_rows + word_bits - 1) / word_bits;
+	}
+
+	/**
+	 * @brief Удаляем все строки
+	 */
+	void clear() noexcept
+	{
+		for(auto& bitmap : _bitmaps)
+			bitmap.resize(0);
+		_rows = 0;
+	}
+
+private:
+
+	std::array<bitmap_t, N> _bitmaps;
+	std::size_t _rows = 0;
+
+	inline void set_row(std::size_t row, const mask_t& mask) noexcept
+	{
+		for(Enum value : mask)
+			_bitmaps[static_cast<std::size_t>(value)].set(row);
+	}
+};
@@ -2,12 +2,20 @@
 
 #include <bits/stdc++.h>
 #include "all.hpp"
+#include "bitwords.hpp"
+#include "bit_expression.hpp"
+#include "popcount.hpp"
+#include "bitchars.hpp"
 
 
 /**
- * @brief Класс для работы с набором битов (аналог std::bitset, только с поддержкой разных типов данных). 
- * @tparam Integral Тип, который хранится в наборе. Должен быть беззнаковым.
- * @tparam N Количество битов в наборе. Должно быть меньше или равно количеству битов в типе, который хранится в наборе.
+ * @brief Класс для работы с набором битов (аналог std::bitset, только с поддержкой разных типов данных).
+ * @details Если N больше разрядности Integral, набор хранится в массиве из нескольких слов типа Integral,
+ * а логические операции над наборами выполняются векторно (SSE2/AVX2) по всем словам сразу.
+ * Операторы &, |, ^, ~ возвращают ленивое выражение (см. bit_expression.hpp), которое вычисляется за один проход
+ * при присваивании в BitSet или при вызове count(), any(), all(), has().
+ * @tparam Integral Тип слова, в котором хранится набор. Должен быть беззнаковым.
+ * @tparam N Количество битов в наборе.
  */
 template<typename Integral, typename std::size_t N = sizeof(Integral) * 8>
 struct BitSet
@@ -15,6 +23,33 @@ struct BitSet
 	using type_t = Integral;
 
 	static_assert(std::is_unsigned<Integral>::value, "BitSet type cannot be signed");
+	static_assert(N > 0, "BitSet size must be greater than zero");
+
+	/**
+	 * @brief Количество бит в одном слове
+	 */
+	static constexpr std::size_t word_bits = sizeof(type_t) * 8;
+
+	/**
+	 * @brief Количество слов, в которых хранится набор
+	 */
+	static constexpr std::size_t word_count = (N + word_bits - 1) / word_bits;
+
+	/**
+	 * @brief Количество битов в наборе
+	 */
+	static constexpr std::size_t bit_count = N;
+
+	/**
+	 * @brief Длина строкового представления набора (to_string, to_chars)
+	 */
+	static constexpr std::size_t chars_size = N;
+
+	/**
+	 * @brief Итератор по номерам выставленных бит
+	 */
+	using const_iterator = detail::set_bit_iterator<type_t, std::size_t>;
+	using iterator = const_iterator;
 
 	/**
 	 * @brief Конструктор по умолчанию. Создает пустой набор.
@@ -23,16 +58,28 @@ struct BitSet
 
 	/**
 	 * @brief Конструктор от значения типа, который хранится в наборе
+	 * @details Если значение шире слова, оно раскладывается по младшим словам набора
 	 * @param value Значение типа, который хранится в наборе
 	 * @tparam T Тип значения. Должен быть таким же, как и тип элемента набора
 	 */
 	template<typename T, typename = typename std::enable_if<std::is_unsigned<T>::value>::type>
 	explicit constexpr BitSet(T value) noexcept
 	{
+		if constexpr (sizeof(T) > sizeof(type_t))
+		{
+			for(std::size_t i = 0; i < word_count && value; ++i)
+			{
+				_words[i] = static_cast<type_t>(value);
+				value >>= word_bits;
+			}
+		}
+		else
+		{
+			_words[0] = static_cast<type_t>(value);
+		}
+
 		//когда присваиваем значение обрезаем лишние биты
-		type_t mask = ~static_cast<type_t>(0);
-		mask >>= sizeof(type_t) * allignment - N;
-		_value = value & mask;
+		strip();
 	}
 
 	/**
@@ -47,13 +94,18 @@ struct BitSet
 	 */
 	BitSet(BitSet&& other) = default;
 
+	BitSet& operator=(const BitSet& other) = default;
+
+	BitSet& operator=(BitSet&& other) = default;
+
 	/**
-	 * @brief Приводим BitSet к значению типа, который хранится в наборе
+	 * @brief Приводим BitSet к значению типа, который хранится в наборе. Доступно только для набора из одного слова.
 	 * @return Значение типа, который хранится в наборе
 	 */
+	template<std::size_t W = word_count, typename = typename std::enable_if<W == 1>::type>
 	inline operator type_t() const
 	{
-		return _value;
+		return _words[0];
 	}
 
 	/**
@@ -106,16 +158,76 @@ struct BitSet
 		return *this;
 	}
 
+	/**
+	 * @brief Вычисляем в набор логическое выражение над наборами того же типа (a & b, (a | b) & ~c и т.д.)
+	 * @details Выражение вычисляется за один проход по словам, без промежуточных наборов
+	 * @param expr Выражение, см. bit_expression.hpp
+	 */
+	template<typename E, typename = typename std::enable_if<detail::is_bit_expression<E>::value &&
+															std::is_same<typename E::set_t, BitSet>::value>::type>
+	BitSet(const E& expr) noexcept
+	{
+		detail::bit_expression_assign(_words, expr);
+	}
+
+	template<typename E, typename = typename std::enable_if<detail::is_bit_expression<E>::value &&
+															std::is_same<typename E::set_t, BitSet>::value>::type>
+	inline BitSet& operator=(const E& expr) noexcept
+	{
+		detail::bit_expression_assign(_words, expr);
+		return *this;
+	}
+
+	/**
+	 * @brief Пересечение наборов
+	 * @param other Второй набор или выражение
+	 */
+	template<typename E, typename = detail::enable_bit_operand_of<BitSet, E>>
+	inline BitSet& operator&=(const E& other) noexcept
+	{
+		return *this = *this & other;
+	}
+
+	/**
+	 * @brief Объединение наборов
+	 * @param other Второй набор или выражение
+	 */
+	template<typename E, typename = detail::enable_bit_operand_of<BitSet, E>>
+	inline BitSet& operator|=(const E& other) noexcept
+	{
+		return *this = *this | other;
+	}
+
+	/**
+	 * @brief Симметрическая разность наборов
+	 * @param other Второй набор или выражение
+	 */
+	template<typename E, typename = detail::enable_bit_operand_of<BitSet, E>>
+	inline BitSet& operator^=(const E& other) noexcept
+	{
+		return *this = *this ^ other;
+	}
+
+	/**
+	 * @brief Разность наборов: убираем из текущего набора все элементы другого (this & ~other)
+	 * @param other Второй набор или выражение
+	 */
+	template<typename E, typename = detail::enable_bit_operand_of<BitSet, E>>
+	inline BitSet& and_not(const E& other) noexcept
+	{
+		return *this = ::and_not(*this, other);
+	}
+
 	/**
 	 * @brief Проверяем, выставлены ли в наборе все биты в true для переданных индексов
 	 * @param args Индексы, которые проверяем на то, выставлены в true они, или нет
 	 * @param Args Parameter pack из индексов, которые проверяем на включение в текущий набор. Должны быть такого же типа, как и элементы набора.
 	 * @return true, если по всем переданным индексам биты выставлены, иначе false
-	 */	
+	 */
 	template<typename... Args, typename = typename std::enable_if<all_unsigned<Integral, Args...>::value>::type>
 	inline bool has(Args&&... args) const noexcept
 	{
-		for(const auto& arg : {args...})
+		for(const std::size_t arg : {static_cast<std::size_t>(args)...})
 		{
 			if(!has_impl(arg)) return false;
 		}
@@ -129,7 +241,18 @@ struct BitSet
 	 */
 	inline bool has(const BitSet& other) const noexcept
 	{
-		return (_value & other._value) == other._value;
+		return detail::words_contains(_words, other._words, word_count);
+	}
+
+	/**
+	 * @brief Проверяем, выставлены ли в наборе все биты результата выражения. Выражение не сохраняется в памяти.
+	 * @param expr Выражение над наборами того же типа
+	 */
+	template<typename E, typename = typename std::enable_if<detail::is_bit_expression<E>::value &&
+															std::is_same<typename E::set_t, BitSet>::value>::type>
+	inline bool has(const E& expr) const noexcept
+	{
+		return detail::bit_expression_contains(*this, expr);
 	}
 
 	/**
@@ -138,7 +261,7 @@ struct BitSet
 	 */
 	inline bool any() const noexcept
 	{
-		return _value;
+		return detail::words_any(_words, word_count);
 	}
 
 	/**
@@ -147,9 +270,8 @@ struct BitSet
 	 */
 	inline bool all() const noexcept
 	{
-		type_t mask = ~static_cast<type_t>(0);
-		mask >>= sizeof(type_t) * allignment - N;
-		return _value == mask;
+		if(!detail::words_all(_words, full_words)) return false;
+		return full_words == word_count || _words[word_count - 1] == tail_mask();
 	}
 
 	/**
@@ -158,7 +280,7 @@ struct BitSet
 	 */
 	inline bool empty() const noexcept
 	{
-		return !_value;		
+		return !any();
 	}
 
 	/**
@@ -169,7 +291,7 @@ struct BitSet
 	template<typename... Args, typename = typename std::enable_if<all_unsigned<Args...>::value>::type>
 	inline void set(Args&&... args) noexcept
 	{
-		for(const auto& arg : {args...})
+		for(const std::size_t arg : {static_cast<std::size_t>(args)...})
 		{
 			set_impl(arg);
 		}
@@ -184,32 +306,56 @@ struct BitSet
 	inline void reset(Args&&... args) noexcept
 	{
 		//проверяем количество аргументов
-		if(!sizeof...(args))
+		if constexpr (!sizeof...(args))
 		{
 			//если аргументов нет, сбрасываем значение
-			_value = 0;
-			return;
+			std::fill(std::begin(_words), std::end(_words), static_cast<type_t>(0));
+		}
+		else
+		{
+			//если аргументы есть - вызываем хелпер
+			for(const std::size_t arg : {static_cast<std::size_t>(args)...})
+				reset_impl(arg);
 		}
-
-		//если аргументы есть - вызываем хелпер
-		for(const auto arg : {args...})
-			reset_impl(arg);
 	}
 
 	/**
-	 * @brief Возвращаем значение набора
+	 * @brief Возвращаем значение набора. Доступно только для набора из одного слова.
 	 * @return Значение набора
 	 */
+	template<std::size_t W = word_count, typename = typename std::enable_if<W == 1>::type>
 	inline type_t value() const noexcept
 	{
-		return _value;
+		return _words[0];
+	}
+
+	/**
+	 * @brief Возвращаем слово набора по его номеру
+	 * @param index Номер слова, от 0 до word_count - 1
+	 */
+	inline type_t word(std::size_t index) const noexcept
+	{
+		return _words[index];
+	}
+
+	/**
+	 * @brief Указатель на массив слов набора. Младший бит набора - младший бит нулевого слова.
+	 */
+	inline const type_t* data() const noexcept
+	{
+		return _words;
+	}
+
+	inline type_t* data() noexcept
+	{
+		return _words;
 	}
 
 	/**
 	 * @brief Возвращаем размер набора в битах
 	 * @return Размер набора в битах
 	 */
-	inline constexpr type_t size() const noexcept
+	inline constexpr std::size_t size() const noexcept
 	{
 		return N;
 	}
@@ -218,32 +364,104 @@ struct BitSet
 	 * @brief Считаем количество бит, выставленных в 1 в наборе
 	 * @return Количество бит, выставленных в 1 в наборе
 	 */
-	inline constexpr type_t count() const noexcept
+	inline std::size_t count() const noexcept
 	{
-		//https://stackoverflow.com/questions/109023/count-the-number-of-set-bits-in-a-32-bit-integer/109025#109025
-		return __builtin_popcount(_value);
+		//большие наборы считаем ядром, выбранным по CPUID, маленькие - встроенным циклом без косвенного вызова
+		if constexpr (sizeof(_words) >= detail::popcount_dispatch_min_bytes)
+			return detail::bytes_popcount(_words, sizeof(_words));
+		else
+			return detail::words_count(_words, word_count);
 	}
 
 	/**
 	 * @brief Возвращаем строковое представление набора
-	 * @return Строковое представление набора в бинарном виде
+	 * @return Строковое представление набора в бинарном виде из chars_size символов, старший бит первым
 	 */
 	std::string to_string() const noexcept
 	{
-		std::string str(N, '0');
-		for(type_t i = 0; i < N; ++i)
-		{
-			type_t mask = static_cast<type_t>(1) << i;
-			str[i] = (_value & mask) ? '1' : '0';
-		}
+		std::string str(chars_size, '0');
+		to_chars(str.data(), str.data() + str.size());
 		return str;
 	}
 
-private:
+	/**
+	 * @brief Записываем набор в буфер вызывающего в виде chars_size символов '0'/'1', старший бит первым (как to_string)
+	 * @param first Начало буфера
+	 * @param last Конец буфера
+	 * @return ptr - конец записанного; ec == errc::value_too_large и ptr == last, если буфер меньше chars_size
+	 */
+	std::to_chars_result to_chars(char* first, char* last) const noexcept
+	{
+		if(static_cast<std::size_t>(last - first) < chars_size) return {last, std::errc::value_too_large};
+		detail::bits_to_chars(_words, N, first);
+		return {first + chars_size, std::errc()};
+	}
+
+	/**
+	 * @brief Разбираем строку из '0'/'1', старший бит первым. Строка короче chars_size дополняется нулями слева.
+	 * @details При ошибке набор не меняется. ec == errc::invalid_argument для пустой строки или постороннего символа
+	 * (ptr указывает на него), ec == errc::result_out_of_range для строки длиннее chars_size.
+	 * @param first Начало строки
+	 * @param last Конец строки
+	 */
+	std::from_chars_result from_chars(const char* first, const char* last) noexcept
+	{
+		type_t words[word_count]{};
+		const auto result = detail::bits_from_chars(first, last, words, chars_size);
+		if(result.ec == std::errc()) std::memcpy(_words, words, sizeof(words));
+		return result;
+	}
 
-	static constexpr type_t allignment = 8;
+	/**
+	 * @brief Ищем первый выставленный бит набора
+	 * @return Номер бита или size(), если набор пустой
+	 */
+	inline std::size_t find_first() const noexcept
+	{
+		return std::min(detail::words_find_from(_words, word_count, 0), N);
+	}
 
-	static_assert(N <= sizeof(type_t) * allignment, "size exceeds the bit width of the underlying type");
+	/**
+	 * @brief Ищем следующий выставленный бит после index
+	 * @param index Номер бита, после которого начинаем поиск
+	 * @return Номер бита или size(), если после index выставленных бит нет
+	 */
+	inline std::size_t find_next(std::size_t index) const noexcept
+	{
+		return std::min(detail::words_find_from(_words, word_count, index + 1), N);
+	}
+
+	/**
+	 * @brief Ищем последний выставленный бит набора
+	 * @return Номер бита или size(), если набор пустой
+	 */
+	inline std::size_t find_last() const noexcept
+	{
+		return std::min(detail::words_find_last(_words, word_count), N);
+	}
+
+	/**
+	 * @brief Итератор на первый выставленный бит. Range-for по набору обходит только выставленные биты по возрастанию.
+	 */
+	inline const_iterator begin() const noexcept
+	{
+		return const_iterator(_words, word_count, 0);
+	}
+
+	/**
+	 * @brief Итератор конца обхода выставленных бит
+	 */
+	inline const_iterator end() const noexcept
+	{
+		return const_iterator(_words, word_count, word_count);
+	}
+
+private:
+
+	/**
+	 * @brief Количество полностью занятых слов
+	 */
+	static constexpr std::size_t full_words = N / word_bits;
 
 	/**
 	 * @brief Класс для работы с отдельным битом в наборе
@@ -252,17 +470,17 @@ private:
     {
     public:
 		/**
-		 * @brief В конструкторе ссылки сохраняем ссылку на основной контейнер и индекс бита, с которым будем работать
+		 * @brief В конструкторе ссылки сохраняем ссылку на слово, в котором лежит бит, и номер бита в этом слове
 		 */
-        reference(type_t& value, Integral index) 
-            : _value(value), _index(index) {}
+        reference(type_t& word, std::size_t index)
+            : _word(word), _mask(static_cast<type_t>(static_cast<type_t>(1) << index)) {}
 
 		/**
 		 * @brief Оператор приведения к bool для проверки значения бита в наборе
 		 */
         operator bool() const noexcept
         {
-            return _value & (static_cast<type_t>(1) << static_cast<type_t>(_index));
+            return _word & _mask;
         }
 
 		/**
@@ -272,9 +490,9 @@ private:
         reference& operator=(bool flag) noexcept
         {
             if (flag)
-                _value |= (static_cast<type_t>(1) << static_cast<type_t>(_index));
+                _word |= _mask;
             else
-                _value &= ~(static_cast<type_t>(1) << static_cast<type_t>(_index));
+                _word &= static_cast<type_t>(~_mask);
             return *this;
         }
 
@@ -288,44 +506,70 @@ private:
         }
 
     private:
-        type_t& _value;
-        Integral _index;
+        type_t& _word;
+        type_t _mask;
     };
 
-	type_t _value{0};
+	type_t _words[word_count]{};
+
+	/**
+	 * @brief Маска значащих бит последнего слова
+	 */
+	static constexpr type_t tail_mask() noexcept
+	{
+		type_t mask = ~static_cast<type_t>(0);
+		mask >>= word_count * word_bits - N;
+		return mask;
+	}
+
+	/**
+	 * @brief Обнуляем биты последнего слова, лежащие за пределами N
+	 */
+	constexpr void strip() noexcept
+	{
+		_words[word_count - 1] &= tail_mask();
+	}
+
+	/**
+	 * @brief Маска бита index внутри его слова
+	 */
+	static constexpr type_t bit_mask(std::size_t index) noexcept
+	{
+		return static_cast<type_t>(static_cast<type_t>(1) << (index % word_bits));
+	}
 
 	/**
 	 * @brief Проверяем выставлен ли бит номер index в наборе
 	 * @param index Номер бита, который нужно проверить
 	 * @return true, если бит выставлен, иначе false
 	 */
-	inline bool has_impl(Integral index) const noexcept
+	inline bool has_impl(std::size_t index) const noexcept
 	{
-		return _value & (static_cast<type_t>(1) << static_cast<type_t>(index));
+		return _words[index / word_bits] & bit_mask(index);
 	}
 
 	/**
 	 * @brief Устанавливаем бит номер index в наборе
 	 * @param index Номер бита, который нужно установить
 	 */
-	inline void set_impl(Integral index) noexcept
+	inline void set_impl(std::size_t index) noexcept
 	{
-		_value |= (static_cast<type_t>(1) << static_cast<type_t>(index));
+		_words[index / word_bits] |= bit_mask(index);
 	}
 
 	/**
 	 * @brief Сбрасываем бит номер index в наборе
 	 * @param index Номер бита, который нужно сбросить
 	 */
-	inline void reset_impl(Integral index) noexcept
+	inline void reset_impl(std::size_t index) noexcept
 	{
-		_value &= ~(static_cast<type_t>(1) << static_cast<type_t>(index));
+		_words[index / word_bits] &= static_cast<type_t>(~bit_mask(index));
 	}
 public:
 
 	/**
 	 * Небезопасный оператор, который генерирует UB при индексе, выходящем из диапазона значений
-	 * @brief Оператор доступа к биту по индексу 
+	 * @brief Оператор доступа к биту по индексу
 	 * @param index Индекс бита, к которому нужно получить доступ
 	 * @tparam T Тип индекса, должен быть таким же, как и Enum
 	 * @return Ссылка на бит по указанному индексу
@@ -333,46 +577,114 @@ public:
 	template<typename T, typename = typename std::enable_if<std::is_unsigned<T>::value>::type>
 	inline reference operator[](T index) noexcept
 	{
-		return reference(_value, index);
+		return reference(_words[index / word_bits], index % word_bits);
 	}
 
 	/**
 	 * Небезопасный оператор, который генерирует UB при индексе, выходящем из диапазона значений
-	 * @brief Оператор доступа к биту по индексу 
+	 * @brief Оператор доступа к биту по индексу
 	 * @param index Индекс бита, к которому нужно получить доступ
 	 * @tparam T Тип индекса, должен быть таким же, как и Enum
-	 * @return Ссылка на бит по указанному индексу
+	 * @return Значение бита по указанному индексу
 	 */
 	template<typename T, typename = typename std::enable_if<std::is_unsigned<T>::value>::type>
-	inline const reference operator[](T index) const noexcept
+	inline bool operator[](T index) const noexcept
 	{
-		return reference(_value, index);
+		return has_impl(index);
 	}
 
 	/**
-	 * @brief Метод доступа к биту по индексу 
+	 * @brief Метод доступа к биту по индексу
 	 * @param index Индекс бита, к которому нужно получить доступ
 	 * @tparam T Тип индекса, должен быть таким же, как и Enum
 	 * @return Ссылка на бит по указанному индексу
 	 */
 	template<typename T, typename = typename std::enable_if<std::is_unsigned<T>::value>::type>
-	inline reference at(T index) noexcept
+	inline reference at(T index)
 	{
 		if(index >= N) throw std::out_of_range("BitSet::at: index out of range");
-		return reference(_value, index);
+		return reference(_words[index / word_bits], index % word_bits);
 	}
 
 	/**
-	 * @brief Метод доступа к биту по индексу 
+	 * @brief Метод доступа к биту по индексу
 	 * @param index Индекс бита, к которому нужно получить доступ
 	 * @tparam T Тип индекса, должен быть таким же, как и Enum
-	 * @return Ссылка на бит по указанному индексу
+	 * @return Значение бита по указанному индексу
 	 */
 	template<typename T, typename = typename std::enable_if<std::is_unsigned<T>::value>::type>
-	inline const reference at(T index) const noexcept
+	inline bool at(T index) const
 	{
 		if(index >= N) throw std::out_of_range("BitSet::at: index out of range");
-		return reference(_value, index);
+		return has_impl(index);
 	}
 };
 
+namespace detail
+{
+	template<typename Integral, std::size_t N>
+	struct is_bit_leaf<BitSet<Integral, N>> : std::true_type {};
+}
+
+/**
+ * @brief Считаем количество выставленных бит сразу во всех наборах массива
+ * @details Наборы лежат в памяти подряд, а биты за пределами N всегда сброшены,
+ * поэтому весь массив считается как один непрерывный блок памяти ядром, выбранным по CPUID.
+ * @param sets Начало массива наборов
+ * @param size Количество наборов
+ */
+template<typename Integral, std::size_t N>
+inline std::size_t count(const BitSet<Integral, N>* sets, std::size_t size) noexcept
+{
+	static_assert(sizeof(BitSet<Integral, N>) == BitSet<Integral, N>::word_count * sizeof(Integral), "BitSet must not have padding");
+	return detail::bytes_popcount(sets, size * sizeof(BitSet<Integral, N>));
+}
+
+/**
+ * @brief Считаем количество выставленных бит в попарных пересечениях наборов двух массивов, не сохраняя пересечения
+ * @param a Начало первого массива наборов
+ * @param b Начало второго массива наборов
+ * @param size Количество наборов в каждом массиве
+ */
+template<typename Integral, std::size_t N>
+inline std::size_t count_and(const BitSet<Integral, N>* a, const BitSet<Integral, N>* b, std::size_t size) noexcept
+{
+	static_assert(sizeof(BitSet<Integral, N>) == BitSet<Integral, N>::word_count * sizeof(Integral), "BitSet must not have padding");
+	return detail::bytes_popcount_and(a, b, size * sizeof(BitSet<Integral, N>));
+}
+
+namespace detail
+{
+	template<typename T>
+	struct is_bitset : std::false_type {};
+
+	template<typename Integral, std::size_t N>
+	struct is_bitset<BitSet<Integral, N>> : std::true_type {};
+
+	/**
+	 * @brief Непрерывный контейнер наборов (std::vector, std::array, массив)
+	 */
+	template<typename Container>
+	using enable_bitset_range = typename std::enable_if<
+		is_bitset<std::remove_cv_t<std::remove_pointer_t<decltype(std::data(std::declval<const Container&>()))>>>::value>::type;
+}
+
+/**
+ * @brief Считаем количество выставленных бит во всех наборах непрерывного контейнера
+ */
+template<typename Container, typename = detail::enable_bitset_range<Container>>
+inline std::size_t count(const Container& sets) noexcept
+{
+	return count(std::data(sets), std::size(sets));
+}
+
+/**
+ * @brief Считаем количество выставленных бит в попарных пересечениях наборов двух контейнеров
+ * @throw std::invalid_argument Если в контейнерах разное количество наборов
+ */
+template<typename Container, typename = detail::enable_bitset_range<Container>>
+inline std::size_t count_and(const Container& a, const Container& b)
+{
+	if(std::size(a) != std::size(b)) throw std::invalid_argument("count_and: size mismatch");
+	return count_and(std::data(a), std::data(b), std::size(a));
+}
@@ -0,0 +1,477 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(__AVX2__) || defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Операции над массивами слов, из которых состоят многословные наборы битов.
+ * @details Все функции работают с непрерывным массивом беззнаковых слов длиной n.
+ * Основная часть массива обрабатывается векторами по 32 (AVX2) или 16 (SSE2) байт,
+ * хвост, не кратный размеру вектора, обрабатывается по одному слову.
+ * Набор инструкций выбирается при компиляции (-mavx2 / -march=native), без AVX2 используется SSE2,
+ * вне x86 остаётся только скалярный путь.
+ */
+namespace detail
+{
+	/**
+	 * @brief Количество слов типа W в одном векторе
+	 */
+#if defined(__AVX2__)
+	template<typename W>
+	constexpr std::size_t avx2_step = 32 / sizeof(W);
+#endif
+
+#if defined(__SSE2__)
+	template<typename W>
+	constexpr std::size_t sse2_step = 16 / sizeof(W);
+#endif
+
+	struct and_op
+	{
+		template<typename W>
+		static constexpr W apply(W a, W b) noexcept { return static_cast<W>(a & b); }
+#if defined(__AVX2__)
+		static __m256i apply(__m256i a, __m256i b) noexcept { return _mm256_and_si256(a, b); }
+#endif
+#if defined(__SSE2__)
+		static __m128i apply(__m128i a, __m128i b) noexcept { return _mm_and_si128(a, b); }
+#endif
+	};
+
+	struct or_op
+	{
+		template<typename W>
+		static constexpr W apply(W a, W b) noexcept { return static_cast<W>(a | b); }
+#if defined(__AVX2__)
+		static __m256i apply(__m256i a, __m256i b) noexcept { return _mm256_or_si256(a, b); }
+#endif
+#if defined(__SSE2__)
+		static __m128i apply(__m128i a, __m128i b) noexcept { return _mm_or_si128(a, b); }
+#endif
+	};
+
+	struct xor_op
+	{
+		template<typename W>
+		static constexpr W apply(W a, W b) noexcept { return static_cast<W>(a ^ b); }
+#if defined(__AVX2__)
+		static __m256i apply(__m256i a, __m256i b) noexcept { return _mm256_xor_si256(a, b); }
+#endif
+#if defined(__SSE2__)
+		static __m128i apply(__m128i a, __m128i b) noexcept { return _mm_xor_si128(a, b); }
+#endif
+	};
+
+	/**
+	 * @brief a & ~b
+	 */
+	struct andnot_op
+	{
+		template<typename W>
+		static constexpr W apply(W a, W b) noexcept { return static_cast<W>(a & ~b); }
+#if defined(__AVX2__)
+		static __m256i apply(__m256i a, __m256i b) noexcept { return _mm256_andnot_si256(b, a); }
+#endif
+#if defined(__SSE2__)
+		static __m128i apply(__m128i a, __m128i b) noexcept { return _mm_andnot_si128(b, a); }
+#endif
+	};
+
+	/**
+	 * @brief Поэлементно применяем бинарную операцию: dst[i] = Op(a[i], b[i])
+	 * @details dst может совпадать с a или b
+	 */
+	template<typename Op, typename W>
+	inline void words_apply(W* dst, const W* a, const W* b, std::size_t n) noexcept
+	{
+		static_assert(std::is_unsigned<W>::value, "word type must be unsigned");
+
+		std::size_t i = 0;
+#if defined(__AVX2__)
+		for(; i < n / avx2_step<W> * avx2_step<W>; i += avx2_step<W>)
+		{
+			const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+			const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), Op::apply(va, vb));
+		}
+#elif defined(__SSE2__)
+		for(; i < n / sse2_step<W> * sse2_step<W>; i += sse2_step<W>)
+		{
+			const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+			const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), Op::apply(va, vb));
+		}
+#endif
+		for(; i < n; ++i)
+			dst[i] = Op::apply(a[i], b[i]);
+	}
+
+	/**
+	 * @brief Инвертируем все слова: dst[i] = ~a[i]
+	 */
+	template<typename W>
+	inline void words_not(W* dst, const W* a, std::size_t n) noexcept
+	{
+		std::size_t i = 0;
+#if defined(__AVX2__)
+		const __m256i ones256 = _mm256_set1_epi32(-1);
+		for(; i < n / avx2_step<W> * avx2_step<W>; i += avx2_step<W>)
+		{
+			const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_xor_si256(va, ones256));
+		}
+#elif defined(__SSE2__)
+		const __m128i ones128 = _mm_set1_epi32(-1);
+		for(; i < n / sse2_step<W> * sse2_step<W>; i += sse2_step<W>)
+		{
+			const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(va, ones128));
+		}
+#endif
+		for(; i < n; ++i)
+			dst[i] = static_cast<W>(~a[i]);
+	}
+
+	/**
+	 * @brief Проверяем, есть ли хотя бы один ненулевой бит в массиве
+	 */
+	template<typename W>
+	inline bool words_any(const W* a, std::size_t n) noexcept
+	{
+		std::size_t i = 0;
+#if defined(__AVX2__)
+		for(; i < n / avx2_step<W> * avx2_step<W>; i += avx2_step<W>)
+		{
+			const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+			if(!_mm256_testz_si256(va, va)) return true;
+		}
+#elif defined(__SSE2__)
+		for(; i < n / sse2_step<W> * sse2_step<W>; i += sse2_step<W>)
+		{
+			const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+			if(_mm_movemask_epi8(_mm_cmpeq_epi8(va, _mm_setzero_si128())) != 0xFFFF) return true;
+		}
+#endif
+		for(; i < n; ++i)
+			if(a[i]) return true;
+		return false;
+	}
+
+	/**
+	 * @brief Проверяем, что все биты массива выставлены
+	 */
+	template<typename W>
+	inline bool words_all(const W* a, std::size_t n) noexcept
+	{
+		std::size_t i = 0;
+#if defined(__AVX2__)
+		const __m256i ones256 = _mm256_set1_epi32(-1);
+		for(; i < n / avx2_step<W> * avx2_step<W>; i += avx2_step<W>)
+		{
+			const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+			if(!_mm256_testc_si256(va, ones256)) return false;
+		}
+#elif defined(__SSE2__)
+		const __m128i ones128 = _mm_set1_epi32(-1);
+		for(; i < n / sse2_step<W> * sse2_step<W>; i += sse2_step<W>)
+		{
+			const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+			if(_mm_movemask_epi8(_mm_cmpeq_epi8(va, ones128)) != 0xFFFF) return false;
+		}
+#endif
+		for(; i < n; ++i)
+			if(a[i] != static_cast<W>(~static_cast<W>(0))) return false;
+		return true;
+	}
+
+	/**
+	 * @brief Проверяем, что все биты b выставлены в a, то есть (b & ~a) == 0
+	 */
+	template<typename W>
+	inline bool words_contains(const W* a, const W* b, std::size_t n) noexcept
+	{
+		std::size_t i = 0;
+#if defined(__AVX2__)
+		for(; i < n / avx2_step<W> * avx2_step<W>; i += avx2_step<W>)
+		{
+			const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+			const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+			if(!_mm256_testc_si256(va, vb)) return false;
+		}
+#elif defined(__SSE2__)
+		for(; i < n / sse2_step<W> * sse2_step<W>; i += sse2_step<W>)
+		{
+			const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+			const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+			const __m128i rest = _mm_andnot_si128(va, vb);
+			if(_mm_movemask_epi8(_mm_cmpeq_epi8(rest, _mm_setzero_si128())) != 0xFFFF) return false;
+		}
+#endif
+		for(; i < n; ++i)
+			if(b[i] & ~a[i]) return false;
+		return true;
+	}
+
+	/**
+	 * @brief Проверяем, что массивы совпадают
+	 */
+	template<typename W>
+	inline bool words_equal(const W* a, const W* b, std::size_t n) noexcept
+	{
+		std::size_t i = 0;
+#if defined(__AVX2__)
+		for(; i < n / avx2_step<W> * avx2_step<W>; i += avx2_step<W>)
+		{
+			const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+			const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+			const __m256i diff = _mm256_xor_si256(va, vb);
+			if(!_mm256_testz_si256(diff, diff)) return false;
+		}
+#elif defined(__SSE2__)
+		for(; i < n / sse2_step<W> * sse2_step<W>; i += sse2_step<W>)
+		{
+			const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+			const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+			if(_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) != 0xFFFF) return false;
+		}
+#endif
+		for(; i < n; ++i)
+			if(a[i] != b[i]) return false;
+		return true;
+	}
+
+	/**
+	 * @brief Считаем количество единичных бит в одном слове любой ширины
+	 */
+	template<typename W>
+	inline constexpr std::size_t word_popcount(W word) noexcept
+	{
+		static_assert(std::is_unsigned<W>::value, "word type must be unsigned");
+
+		if constexpr (sizeof(W) <= sizeof(unsigned int))
+			return static_cast<std::size_t>(__builtin_popcount(word));
+		else
+			return static_cast<std::size_t>(__builtin_popcountll(word));
+	}
+
+#if defined(__AVX2__)
+	/**
+	 * @brief Подсчёт единиц в 256-битном векторе по таблице полубайтов (vpshufb) с суммированием через vpsadbw
+	 * @return Четыре 64-битные частичные суммы
+	 */
+	inline __m256i popcount256(__m256i v) noexcept
+	{
+		const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+												0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+		const __m256i low_mask = _mm256_set1_epi8(0x0F);
+		const __m256i lo = _mm256_and_si256(v, low_mask);
+		const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+		const __m256i cnt = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+		return _mm256_sad_epu8(cnt, _mm256_setzero_si256());
+	}
+#endif
+
+	/**
+	 * @brief Считаем количество единичных бит во всём массиве
+	 */
+	template<typename W>
+	inline std::size_t words_count(const W* a, std::size_t n) noexcept
+	{
+		std::size_t result = 0;
+		std::size_t i = 0;
+#if defined(__AVX2__)
+		__m256i acc = _mm256_setzero_si256();
+		for(; i < n / avx2_step<W> * avx2_step<W>; i += avx2_step<W>)
+		{
+			const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+			acc = _mm256_add_epi64(acc, popcount256(va));
+		}
+		result += static_cast<std::size_t>(_mm256_extract_epi64(acc, 0)) + static_cast<std::size_t>(_mm256_extract_epi64(acc, 1)) +
+				  static_cast<std::size_t>(_mm256_extract_epi64(acc, 2)) + static_cast<std::size_t>(_mm256_extract_epi64(acc, 3));
+#endif
+		//узкие слова склеиваем по 8 байт, чтобы считать одной инструкцией
+		constexpr std::size_t per_u64 = sizeof(std::uint64_t) / sizeof(W);
+		if constexpr (per_u64 > 1)
+		{
+			for(; i < n / per_u64 * per_u64; i += per_u64)
+			{
+				std::uint64_t chunk;
+				std::memcpy(&chunk, a + i, sizeof(chunk));
+				result += word_popcount(chunk);
+			}
+		}
+		for(; i < n; ++i)
+			result += word_popcount(a[i]);
+		return result;
+	}
+
+	/**
+	 * @brief Номер младшего выставленного бита слова. Слово не должно быть нулевым.
+	 */
+	template<typename W>
+	inline constexpr std::size_t word_ctz(W word) noexcept
+	{
+		if constexpr (sizeof(W) <= sizeof(unsigned int))
+			return static_cast<std::size_t>(__builtin_ctz(word));
+		else
+			return static_cast<std::size_t>(__builtin_ctzll(word));
+	}
+
+	/**
+	 * @brief Номер старшего выставленного бита слова. Слово не должно быть нулевым.
+	 */
+	template<typename W>
+	inline constexpr std::size_t word_msb(W word) noexcept
+	{
+		if constexpr (sizeof(W) <= sizeof(unsigned int))
+			return static_cast<std::size_t>(sizeof(unsigned int) * 8 - 1 - __builtin_clz(word));
+		else
+			return static_cast<std::size_t>(sizeof(unsigned long long) * 8 - 1 - __builtin_clzll(word));
+	}
+
+	/**
+	 * @brief Номер выставленного бита слова, перед которым ровно rank выставленных бит (select внутри слова)
+	 * @details С BMI2 это PDEP единицы на место rank-го бита и TZCNT, без него - поиск нужного байта по popcount.
+	 * rank должен быть меньше количества выставленных бит слова.
+	 */
+	inline std::size_t word_select(std::uint64_t word, std::size_t rank) noexcept
+	{
+#if defined(__BMI2__)
+		return static_cast<std::size_t>(_tzcnt_u64(_pdep_u64(static_cast<std::uint64_t>(1) << rank, word)));
+#else
+		std::size_t shift = 0;
+		for(;; shift += 8)
+		{
+			const auto in_byte = static_cast<std::size_t>(__builtin_popcount(static_cast<unsigned>((word >> shift) & 0xFF)));
+			if(rank < in_byte) break;
+			rank -= in_byte;
+		}
+		std::uint64_t byte = (word >> shift) & 0xFF;
+		for(; rank; --rank)
+			byte &= byte - 1;
+		return shift + word_ctz(byte);
+#endif
+	}
+
+	/**
+	 * @brief Ищем первый выставленный бит с номером не меньше pos
+	 * @return Номер бита или n * (бит в слове), если таких бит нет
+	 */
+	template<typename W>
+	inline std::size_t words_find_from(const W* a, std::size_t n, std::size_t pos) noexcept
+	{
+		constexpr std::size_t bits = sizeof(W) * 8;
+		std::size_t i = pos / bits;
+		if(i >= n) return n * bits;
+
+		//в первом слове отбрасываем биты младше pos
+		const W from_mask = static_cast<W>(static_cast<W>(~static_cast<W>(0)) << (pos % bits));
+		W word = static_cast<W>(a[i] & from_mask);
+		while(!word)
+		{
+			if(++i == n) return n * bits;
+			word = a[i];
+		}
+		return i * bits + word_ctz(word);
+	}
+
+	/**
+	 * @brief Ищем последний выставленный бит массива
+	 * @return Номер бита или n * (бит в слове), если массив пустой
+	 */
+	template<typename W>
+	inline std::size_t words_find_last(const W* a, std::size_t n) noexcept
+	{
+		for(std::size_t i = n; i-- > 0;)
+		{
+			if(a[i]) return i * sizeof(W) * 8 + word_msb(a[i]);
+		}
+		return n * sizeof(W) * 8;
+	}
+
+	/**
+	 * @brief Forward-итератор по выставленным битам массива слов
+	 * @details На каждом шаге берём младший выставленный бит текущего слова (ctz) и сбрасываем его (w & (w - 1)),
+	 * нулевые слова пропускаются целиком, поэтому обход стоит один шаг на выставленный бит.
+	 * @tparam W Тип слова
+	 * @tparam Value Тип, в котором итератор возвращает номер бита (std::size_t или перечисление)
+	 */
+	template<typename W, typename Value>
+	struct set_bit_iterator
+	{
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = Value;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const Value*;
+		using reference = Value;
+
+		constexpr set_bit_iterator() = default;
+
+		/**
+		 * @brief Итератор на первый выставленный бит, начиная со слова index
+		 * @param words Массив слов
+		 * @param count Количество слов в массиве
+		 * @param index Номер слова, с которого начинаем обход. index == count - итератор конца.
+		 */
+		set_bit_iterator(const W* words, std::size_t count, std::size_t index) noexcept
+			: _words(words), _count(count), _index(index), _current(index < count ? words[index] : 0)
+		{
+			skip_empty();
+		}
+
+		inline Value operator*() const noexcept
+		{
+			return static_cast<Value>(_index * bits + word_ctz(_current));
+		}
+
+		inline set_bit_iterator& operator++() noexcept
+		{
+			_current = static_cast<W>(_current & (_current - 1));
+			skip_empty();
+			return *this;
+		}
+
+		inline set_bit_iterator operator++(int) noexcept
+		{
+			set_bit_iterator copy(*this);
+			++*this;
+			return copy;
+		}
+
+		inline friend bool operator==(const set_bit_iterator& lhs, const set_bit_iterator& rhs) noexcept
+		{
+			return lhs._index == rhs._index && lhs._current == rhs._current;
+		}
+
+		inline friend bool operator!=(const set_bit_iterator& lhs, const set_bit_iterator& rhs) noexcept
+		{
+			return !(lhs == rhs);
+		}
+
+	private:
+		static constexpr std::size_t bits = sizeof(W) * 8;
+
+		const W* _words{nullptr};
+		std::size_t _count{0};
+		std::size_t _index{0};
+		W _current{0};
+
+		/**
+		 * @brief Переходим к следующему ненулевому слову, если в текущем не осталось бит
+		 */
+		inline void skip_empty() noexcept
+		{
+			while(!_current && _index < _count)
+			{
+				if(++_index < _count) _current = _words[_index];
+			}
+		}
+	};
+}
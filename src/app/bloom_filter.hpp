@@ -0,0 +1,383 @@
+#pragma once
+
+#include <bits/stdc++.h>
+#include "aligned_allocator.hpp"
+#include "bitset.hpp"
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+
+namespace detail
+{
+	/**
+	 * @brief Заголовок сериализованного BloomFilter
+	 */
+	struct bloom_filter_header
+	{
+		static constexpr char expected_magic[8] = {'U', 'T', 'L', 'B', 'L', 'O', 'O', 'M'};
+		static constexpr std::uint32_t current_version = 1;
+
+		char magic[8];
+		std::uint32_t version;
+		std::uint32_t block_bits;
+		std::uint64_t block_count;
+		std::uint64_t reserved;
+	};
+
+	static_assert(sizeof(bloom_filter_header) == 32, "BloomFilter header must be 32 bytes");
+
+	/**
+	 * @brief Нечётные множители, которыми из 32 бит хеша получается номер бита в каждом из 8 слов блока
+	 */
+	alignas(32) constexpr std::uint32_t bloom_salts[8] = {
+		0x47B6137Bu, 0x44974D91u, 0x8824AD5Bu, 0xA2B7289Du, 0x705495C7u, 0x2DF1424Bu, 0x9EFC4947u, 0x5C6BFB31u
+	};
+
+	/**
+	 * @brief Перемешиваем хеш (финализатор murmur3), чтобы годился и тождественный std::hash для целых
+	 */
+	inline constexpr std::uint64_t bloom_mix(std::uint64_t hash) noexcept
+	{
+		hash ^= hash >> 33;
+		hash *= 0xFF51AFD7ED558CCDull;
+		hash ^= hash >> 33;
+		hash *= 0xC4CEB9FE1A85EC53ull;
+		hash ^= hash >> 33;
+		return hash;
+	}
+}
+
+/**
+ * @brief Блочный (split-block) фильтр Блума
+ * @details Фильтр состоит из блоков BitSet<uint64_t, 512> - по кэш-линии на блок. Старшие 32 бита хеша выбирают блок,
+ * младшие 32 бита, умноженные на восемь разных множителей, - по одному биту в каждом из восьми слов блока (k = 8).
+ * Поэтому проверка читает одну кэш-линию, а восемь бит проверяются одной векторной операцией
+ * (AVX-512 или две половины AVX2; без них - восемь скалярных слов).
+ * contains_many проверяет массив хешей, заранее подгружая (prefetch) блоки следующих элементов.
+ * Фильтр принимает готовые 64-битные хеши ключей и перемешивает их сам.
+ */
+struct BloomFilter
+{
+	using type_t = std::uint64_t;
+	using block_t = BitSet<type_t, 512>;
+	using header_t = detail::bloom_filter_header;
+
+	static constexpr std::size_t block_bits = 512;
+	static constexpr std::size_t block_words = block_t::word_count;
+
+	/**
+	 * @brief Количество бит, которое выставляет один ключ
+	 */
+	static constexpr std::size_t hash_count = 8;
+
+	/**
+	 * @brief На сколько элементов вперёд contains_many подгружает блоки
+	 */
+	static constexpr std::size_t prefetch_distance = 8;
+
+	/**
+	 * @brief Наибольшее количество блоков фильтра (256 ГиБ)
+	 * @details Номер блока - (старшие 32 бита хеша * количество блоков) >> 32, произведение помещается в 64 бита
+	 * только при количестве блоков не больше 2^32
+	 */
+	static constexpr std::size_t max_blocks = std::size_t(1) << 32;
+
+	/**
+	 * @brief Конструктор по умолчанию. Фильтр из одного блока.
+	 */
+	BloomFilter() : _blocks(1) {}
+
+	/**
+	 * @brief Создаём фильтр под ожидаемое количество ключей
+	 * @param expected Ожидаемое количество ключей
+	 * @param false_positive_rate Допустимая доля ложных срабатываний при expected ключах
+	 * @throw std::invalid_argument Если false_positive_rate не лежит в (0, 1)
+	 */
+	explicit BloomFilter(std::size_t expected, double false_positive_rate = 0.01)
+		: _blocks(blocks_for(expected, false_positive_rate)) {}
+
+	/**
+	 * @brief Доля ложных срабатываний фильтра из blocks блоков с n ключами.
+	 * @details Число ключей в блоке распределено по Пуассону, поэтому складываем вероятности по загрузке блока.
+	 */
+	static double estimate_false_positive_rate(std::size_t blocks, std::size_t n) noexcept
+	{
+		if(n == 0) return 0.0;
+
+		//вне lambda +- 10 стандартных отклонений вероятности загрузки пренебрежимо малы: слагаемых O(sqrt(lambda)), а не O(n)
+		const double lambda = static_cast<double>(n) / static_cast<double>(blocks);
+		const double spread = 10.0 * std::sqrt(lambda) + 20.0;
+		const auto first = static_cast<std::size_t>(std::max(1.0, lambda - spread));
+		const auto last = static_cast<std::size_t>(lambda + spread);
+		double result = 0.0;
+		for(std::size_t i = first; i <= last; ++i)
+		{
+			const double load = std::exp(-lambda + static_cast<double>(i) * std::log(lambda) - std::lgamma(static_cast<double>(i) + 1.0));
+			const double bit = 1.0 - std::pow(1.0 - 1.0 / (block_bits / hash_count), static_cast<double>(i));
+			result += load * std::pow(bit, static_cast<double>(hash_count));
+		}
+		return result;
+	}
+
+	/**
+	 * @brief Наименьшее количество блоков, при котором с expected ключами доля ложных срабатываний не больше заданной
+	 * @details Не больше max_blocks: если и их не хватает, возвращается max_blocks
+	 * @throw std::invalid_argument Если false_positive_rate не лежит в (0, 1)
+	 */
+	static std::size_t blocks_for(std::size_t expected, double false_positive_rate)
+	{
+		if(!(false_positive_rate > 0.0 && false_positive_rate < 1.0))
+			throw std::invalid_argument("BloomFilter: false positive rate must be in (0, 1)");
+
+		//начинаем с оценки обычного фильтра Блума: n * -ln p / ln^2 2 бит, блочному нужно немного больше
+		const double ln2 = std::log(2.0);
+		const double estimate = static_cast<double>(expected) * -std::log(false_positive_rate) / (ln2 * ln2) / block_bits;
+		std::size_t hi = estimate >= 1.0 ? static_cast<std::size_t>(std::min(estimate, static_cast<double>(max_blocks))) : 1;
+
+		std::size_t lo = 1;
+		while(estimate_false_positive_rate(hi, expected) > false_positive_rate && hi < max_blocks)
+		{
+			lo = hi + 1;
+			hi = std::min(hi * 2, max_blocks);
+		}
+
+		while(lo < hi)
+		{
+			const std::size_t mid = lo + (hi - lo) / 2;
+			if(estimate_false_positive_rate(mid, expected) > false_positive_rate) lo = mid + 1;
+			else hi = mid;
+		}
+		return std::max<std::size_t>(hi, 1);
+	}
+
+	/**
+	 * @brief Добавляем ключ по его хешу
+	 */
+	inline void insert(std::uint64_t hash) noexcept
+	{
+		const std::uint64_t mixed = detail::bloom_mix(hash);
+		block_insert(_blocks[block_index(mixed)].data(), static_cast<std::uint32_t>(mixed));
+	}
+
+	/**
+	 * @brief Проверяем ключ по его хешу
+	 * @return false - ключа точно нет, true - ключ, вероятно, есть
+	 */
+	inline bool contains(std::uint64_t hash) const noexcept
+	{
+		const std::uint64_t mixed = detail::bloom_mix(hash);
+		return block_contains(_blocks[block_index(mixed)].data(), static_cast<std::uint32_t>(mixed));
+	}
+
+	/**
+	 * @brief Проверяем массив хешей
+	 * @param hashes Хеши ключей
+	 * @param n Количество хешей
+	 * @param result Массив не меньше n элементов для ответов
+	 * @return Количество положительных ответов
+	 */
+	std::size_t contains_many(const std::uint64_t* hashes, std::size_t n, bool* result) const noexcept
+	{
+		std::size_t found = 0;
+		for(std::size_t i = 0; i < n; ++i)
+		{
+			if(i + prefetch_distance < n)
+				__builtin_prefetch(_blocks[block_index(detail::bloom_mix(hashes[i + prefetch_distance]))].data(), 0, 1);
+
+			const std::uint64_t mixed = detail::bloom_mix(hashes[i]);
+			result[i] = block_contains(_blocks[block_index(mixed)].data(), static_cast<std::uint32_t>(mixed));
+			found += result[i];
+		}
+		return found;
+	}
+
+	/**
+	 * @brief Объединяем с фильтром того же размера: результат содержит ключи обоих фильтров
+	 * @throw std::invalid_argument Если количество блоков различается
+	 */
+	BloomFilter& merge(const BloomFilter& other)
+	{
+		if(other._blocks.size() != _blocks.size())
+			throw std::invalid_argument("BloomFilter: merge of filters with different block count");
+
+		for(std::size_t i = 0; i < _blocks.size(); ++i)
+			_blocks[i] |= other._blocks[i];
+		return *this;
+	}
+
+	/**
+	 * @brief Очищаем фильтр
+	 */
+	inline void clear() noexcept
+	{
+		for(auto& block : _blocks)
+			block.reset();
+	}
+
+	/**
+	 * @brief Количество выставленных бит (для оценки заполнения)
+	 */
+	inline std::size_t count() const noexcept
+	{
+		return detail::bytes_popcount(reinterpret_cast<const unsigned char*>(_blocks.data()), size_in_bytes());
+	}
+
+	/**
+	 * @brief Количество блоков
+	 */
+	inline std::size_t block_count() const noexcept
+	{
+		return _blocks.size();
+	}
+
+	inline std::size_t size_in_bytes() const noexcept
+	{
+		return _blocks.size() * sizeof(block_t);
+	}
+
+	inline const block_t& block(std::size_t index) const noexcept
+	{
+		return _blocks[index];
+	}
+
+	/**
+	 * @brief Записываем фильтр в поток: заголовок bloom_filter_header и блоки в порядке байт платформы
+	 * @throw std::runtime_error Если запись не удалась
+	 */
+	void write(std::ostream& out) const
+	{
+		header_t header{};
+		std::memcpy(header.magic, header_t::expected_magic, sizeof(header.magic));
+		header.version = header_t::current_version;
+		header.block_bits = block_bits;
+		header.block_count = _blocks.size();
+
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		out.write(reinterpret_cast<const char*>(_blocks.data()), static_cast<std::streamsize>(size_in_bytes()));
+		if(!out) throw std::runtime_error("BloomFilter: cannot write filter");
+	}
+
+	/**
+	 * @brief Читаем фильтр, записанный write()
+	 * @throw std::runtime_error Если поток оборвался или заголовок не от BloomFilter этой версии
+	 */
+	static BloomFilter read(std::istream& in)
+	{
+		header_t header;
+		if(!in.read(reinterpret_cast<char*>(&header), sizeof(header)))
+			throw std::runtime_error("BloomFilter: truncated header");
+		if(std::memcmp(header.magic, header_t::expected_magic, sizeof(header.magic)) != 0)
+			throw std::runtime_error("BloomFilter: bad magic");
+		if(header.version != header_t::current_version || header.block_bits != block_bits || header.block_count == 0 ||
+		   header.block_count > max_blocks)
+			throw std::runtime_error("BloomFilter: unsupported format");
+
+		//читаем частями, чтобы память росла вместе с прочитанными данными: испорченный block_count
+		//заканчивается обрывом потока, а не попыткой выделить огромный буфер
+		constexpr std::size_t chunk_blocks = 4096;
+		BloomFilter filter;
+		filter._blocks.clear();
+		for(std::size_t done = 0; done < header.block_count;)
+		{
+			const std::size_t n = static_cast<std::size_t>(std::min<std::uint64_t>(chunk_blocks, header.block_count - done));
+			filter._blocks.resize(done + n);
+			if(!in.read(reinterpret_cast<char*>(filter._blocks.data() + done), static_cast<std::streamsize>(n * sizeof(block_t))))
+				throw std::runtime_error("BloomFilter: truncated blocks");
+			done += n;
+		}
+		return filter;
+	}
+
+	inline bool operator==(const BloomFilter& other) const noexcept
+	{
+		return _blocks == other._blocks;
+	}
+
+	inline bool operator!=(const BloomFilter& other) const noexcept
+	{
+		return !(*this == other);
+	}
+
+private:
+
+	std::vector<block_t, aligned_allocator<block_t>> _blocks;
+
+	/**
+	 * @brief Номер блока по старшим 32 битам хеша: умножение вместо деления по модулю
+	 */
+	inline std::size_t block_index(std::uint64_t mixed) const noexcept
+	{
+		return static_cast<std::size_t>(((mixed >> 32) * _blocks.size()) >> 32);
+	}
+
+	/**
+	 * @brief Номер бита в каждом слове блока - старшие 6 бит произведения на множитель
+	 */
+	static inline std::uint32_t bit_index(std::uint32_t key, std::size_t word) noexcept
+	{
+		return (key * detail::bloom_salts[word]) >> 26;
+	}
+
+#if defined(__AVX2__)
+	/**
+	 * @brief Маски восьми слов блока двумя половинами AVX2: номера бит считаются в 32-битных полосах и расширяются до 64
+	 */
+	static inline void block_masks(std::uint32_t key, __m256i& low, __m256i& high) noexcept
+	{
+		const __m256i salts = _mm256_load_si256(reinterpret_cast<const __m256i*>(detail::bloom_salts));
+		const __m256i bits = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(key)), salts), 26);
+		const __m256i one = _mm256_set1_epi64x(1);
+		low = _mm256_sllv_epi64(one, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(bits)));
+		high = _mm256_sllv_epi64(one, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(bits, 1)));
+	}
+#endif
+
+#if defined(__AVX512F__) && defined(__AVX2__)
+	/**
+	 * @brief Маски всех восьми слов блока одним 512-битным регистром
+	 * @details Формы maskz с полной маской: обычные берут _mm512_undefined_epi32 и в GCC 12 дают ложные -Wmaybe-uninitialized
+	 */
+	static inline __m512i block_masks(std::uint32_t key) noexcept
+	{
+		const __m256i salts = _mm256_load_si256(reinterpret_cast<const __m256i*>(detail::bloom_salts));
+		const __m256i bits = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(key)), salts), 26);
+		return _mm512_maskz_sllv_epi64(0xFF, _mm512_set1_epi64(1), _mm512_maskz_cvtepu32_epi64(0xFF, bits));
+	}
+#endif
+
+	static inline void block_insert(type_t* words, std::uint32_t key) noexcept
+	{
+#if defined(__AVX512F__) && defined(__AVX2__)
+		_mm512_store_si512(words, _mm512_or_si512(_mm512_load_si512(words), block_masks(key)));
+#elif defined(__AVX2__)
+		__m256i low, high;
+		block_masks(key, low, high);
+		auto* v = reinterpret_cast<__m256i*>(words);
+		_mm256_store_si256(v, _mm256_or_si256(_mm256_load_si256(v), low));
+		_mm256_store_si256(v + 1, _mm256_or_si256(_mm256_load_si256(v + 1), high));
+#else
+		for(std::size_t i = 0; i < block_words; ++i)
+			words[i] |= static_cast<type_t>(1) << bit_index(key, i);
+#endif
+	}
+
+	static inline bool block_contains(const type_t* words, std::uint32_t key) noexcept
+	{
+#if defined(__AVX512F__) && defined(__AVX2__)
+		const __m512i masks = block_masks(key);
+		return _mm512_cmpneq_epi64_mask(_mm512_and_si512(_mm512_load_si512(words), masks), masks) == 0;
+#elif defined(__AVX2__)
+		__m256i low, high;
+		block_masks(key, low, high);
+		const auto* v = reinterpret_cast<const __m256i*>(words);
+		return _mm256_testc_si256(_mm256_load_si256(v), low) & _mm256_testc_si256(_mm256_load_si256(v + 1), high);
+#else
+		type_t missing = 0;
+		for(std::size_t i = 0; i < block_words; ++i)
+			missing |= ~words[i] & (static_cast<type_t>(1) << bit_index(key, i));
+		return missing == 0;
+#endif
+	}
+};
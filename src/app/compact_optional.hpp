@@ -0,0 +1,450 @@
+#pragma once
+
+#include <bits/stdc++.h>
+#include "optional.hpp"
+#include "bitmask.hpp"
+
+/**
+ * @brief Политика "пустого" значения: пустым считается одно заранее выбранное значение T
+ * @tparam Value Значение-признак отсутствия (целое, перечисление или указатель)
+ */
+template<typename T, T Value>
+struct sentinel_policy
+{
+    static constexpr T empty() noexcept
+    {
+        return Value;
+    }
+
+    static constexpr bool is_empty(const T& value) noexcept
+    {
+        return value == Value;
+    }
+};
+
+/**
+ * @brief Пустое значение числа с плавающей точкой - тихий NaN с особой полезной нагрузкой
+ * @details Сравнение побитовое: обычные NaN, которые дают вычисления, остаются допустимыми значениями.
+ */
+template<typename T>
+struct nan_policy
+{
+    static_assert(std::is_floating_point<T>::value && std::numeric_limits<T>::is_iec559, "nan_policy needs an IEEE 754 floating point type");
+    static_assert(sizeof(T) == sizeof(std::uint32_t) || sizeof(T) == sizeof(std::uint64_t), "nan_policy supports float and double");
+
+    using bits_t = std::conditional_t<sizeof(T) == sizeof(std::uint32_t), std::uint32_t, std::uint64_t>;
+
+    //все биты экспоненты, старший бит мантиссы (тихий NaN) и узнаваемый хвост
+    static constexpr bits_t pattern = sizeof(T) == sizeof(std::uint32_t) ? bits_t(0x7FC0'CA5Eu) : bits_t(0x7FF8'0000'C0FF'CA5Eull);
+
+    static T empty() noexcept
+    {
+        T value;
+        std::memcpy(&value, &pattern, sizeof(T));
+        return value;
+    }
+
+    static bool is_empty(const T& value) noexcept
+    {
+        bits_t bits;
+        std::memcpy(&bits, &value, sizeof(T));
+        return bits == pattern;
+    }
+};
+
+/**
+ * @brief Пустое значение перечисления - максимум базового типа, который лежит за пределами объявленных значений
+ */
+template<typename Enum>
+struct enum_policy
+{
+    using underlying_t = std::underlying_type_t<Enum>;
+
+    static_assert(enum_size<Enum> <= static_cast<std::size_t>(std::numeric_limits<underlying_t>::max()), "enum_policy needs an unused value of the underlying type");
+
+    static constexpr Enum empty() noexcept
+    {
+        return static_cast<Enum>(std::numeric_limits<underlying_t>::max());
+    }
+
+    static constexpr bool is_empty(const Enum& value) noexcept
+    {
+        return static_cast<underlying_t>(value) == std::numeric_limits<underlying_t>::max();
+    }
+};
+
+/**
+ * @brief Пустое значение BitMask - старший запасной бит последнего слова
+ * @details У настоящей маски биты за пределами bit_count всегда сброшены, поэтому такое значение маской быть не может.
+ */
+template<typename Mask>
+struct bitmask_policy
+{
+    using type_t = typename Mask::type_t;
+
+    static_assert(Mask::bit_count < Mask::word_count * Mask::word_bits, "bitmask_policy needs a spare bit in the mask's last word");
+
+    static constexpr type_t spare_bit = static_cast<type_t>(static_cast<type_t>(1) << (Mask::word_bits - 1));
+
+    static Mask empty() noexcept
+    {
+        Mask mask;
+        mask.data()[Mask::word_count - 1] = spare_bit;
+        return mask;
+    }
+
+    static bool is_empty(const Mask& mask) noexcept
+    {
+        return mask.word(Mask::word_count - 1) & spare_bit;
+    }
+};
+
+namespace detail
+{
+    template<typename T, typename = void>
+    struct niche_policy
+    {
+    };
+
+    template<typename T>
+    struct niche_policy<T, std::enable_if_t<std::is_floating_point<T>::value>>
+    {
+        using type = nan_policy<T>;
+    };
+
+    template<typename T>
+    struct niche_policy<T, std::enable_if_t<std::is_pointer<T>::value>>
+    {
+        using type = sentinel_policy<T, nullptr>;
+    };
+
+    template<typename T>
+    struct niche_policy<T, std::enable_if_t<std::is_enum<T>::value>>
+    {
+        using type = enum_policy<T>;
+    };
+
+    template<typename Enum, typename std::underlying_type<Enum>::type N>
+    struct niche_policy<BitMask<Enum, N>>
+    {
+        using type = bitmask_policy<BitMask<Enum, N>>;
+    };
+}
+
+/**
+ * @brief Политика по умолчанию: NaN для чисел с плавающей точкой, nullptr для указателей,
+ * значение вне перечисления для enum, запасной бит для BitMask. Для целых нужно явно указать sentinel_policy.
+ */
+template<typename T>
+using niche_policy = typename detail::niche_policy<T>::type;
+
+/**
+ * @brief optional без отдельного флага: отсутствие значения кодируется значением, которое T никогда не принимает
+ * @details sizeof(compact_optional<T>) == sizeof(T), поэтому массивы необязательных полей не раздуваются
+ * выравниванием флага (optional<double> - 16 байт, compact_optional<double> - 8).
+ * Записывать в compact_optional само пустое значение политики нельзя: оно читается как отсутствие значения.
+ * @tparam T Тривиально копируемый тип
+ * @tparam Policy Политика пустого значения: static T empty() и static bool is_empty(const T&)
+ */
+template<typename T, typename Policy = niche_policy<T>>
+struct compact_optional
+{
+    static_assert(std::is_trivially_copyable<T>::value, "compact_optional stores trivially copyable types");
+
+    using value_type = T;
+    using policy_type = Policy;
+
+    /**
+     * @brief Создаём пустой объект
+     */
+    constexpr compact_optional() noexcept : _value(Policy::empty())
+    {}
+
+    constexpr compact_optional(nullopt_t) noexcept : _value(Policy::empty())
+    {}
+
+    constexpr compact_optional(const T& value) noexcept : _value(value)
+    {}
+
+    template<class... Args>
+    constexpr explicit compact_optional(in_place_t, Args&&... args) : _value(std::forward<Args>(args)...)
+    {}
+
+    /**
+     * @brief Проверяем, инициализирован ли объект
+     */
+    constexpr bool has_value() const noexcept
+    {
+        return !Policy::is_empty(_value);
+    }
+
+    /**
+     * @brief Оператор приведения к bool
+     */
+    constexpr explicit operator bool() const noexcept
+    {
+        return has_value();
+    }
+
+    template<class... Args>
+    T& emplace(Args&&... args)
+    {
+        _value = T(std::forward<Args>(args)...);
+        return _value;
+    }
+
+    void reset() noexcept
+    {
+        _value = Policy::empty();
+    }
+
+    constexpr T& value() &
+    {
+        return has_value() ? _value : throw bad_optional_access();
+    }
+
+    constexpr const T& value() const &
+    {
+        return has_value() ? _value : throw bad_optional_access();
+    }
+
+    constexpr T&& value() &&
+    {
+        return has_value() ? std::move(_value) : throw bad_optional_access();
+    }
+
+    constexpr const T&& value() const &&
+    {
+        return has_value() ? std::move(_value) : throw bad_optional_access();
+    }
+
+    template<class U>
+    constexpr T value_or(U&& u) const
+    {
+        return has_value() ? _value : static_cast<T>(std::forward<U>(u));
+    }
+
+    compact_optional& operator=(nullopt_t) noexcept
+    {
+        reset();
+        return *this;
+    }
+
+    compact_optional& operator=(const T& value) noexcept
+    {
+        _value = value;
+        return *this;
+    }
+
+    /**
+     * @brief Оператор разыменования
+     * @details Если объект не инициализирован, возвращается пустое значение политики
+     */
+    constexpr T& operator*() noexcept
+    {
+        return _value;
+    }
+
+    constexpr const T& operator*() const noexcept
+    {
+        return _value;
+    }
+
+    constexpr T* operator->() noexcept
+    {
+        return &_value;
+    }
+
+    constexpr const T* operator->() const noexcept
+    {
+        return &_value;
+    }
+
+private:
+    T _value;
+};
+
+//compact_optional vs compact_optional
+template<class T, class P, class U, class Q>
+constexpr bool operator==(const compact_optional<T, P>& lhs, const compact_optional<U, Q>& rhs)
+{
+    return lhs.has_value() == rhs.has_value() && (!lhs || *lhs == *rhs);
+}
+
+template<class T, class P, class U, class Q>
+constexpr bool operator!=(const compact_optional<T, P>& lhs, const compact_optional<U, Q>& rhs)
+{
+    return !(lhs == rhs);
+}
+
+template<class T, class P, class U, class Q>
+constexpr bool operator<(const compact_optional<T, P>& lhs, const compact_optional<U, Q>& rhs)
+{
+    return rhs && (!lhs || *lhs < *rhs);
+}
+
+template<class T, class P, class U, class Q>
+constexpr bool operator<=(const compact_optional<T, P>& lhs, const compact_optional<U, Q>& rhs)
+{
+    return !lhs || (rhs && *lhs <= *rhs);
+}
+
+template<class T, class P, class U, class Q>
+constexpr bool operator>(const compact_optional<T, P>& lhs, const compact_optional<U, Q>& rhs)
+{
+    return lhs && (!rhs || *lhs > *rhs);
+}
+
+template<class T, class P, class U, class Q>
+constexpr bool operator>=(const compact_optional<T, P>& lhs, const compact_optional<U, Q>& rhs)
+{
+    return !rhs || (lhs && *lhs >= *rhs);
+}
+
+
+//compact_optional vs nullopt
+template<class T, class P>
+constexpr bool operator==(const compact_optional<T, P>& opt, nullopt_t) noexcept
+{
+    return !opt;
+}
+
+template<class T, class P>
+constexpr bool operator==(nullopt_t, const compact_optional<T, P>& opt) noexcept
+{
+    return !opt;
+}
+
+template<class T, class P>
+constexpr bool operator!=(const compact_optional<T, P>& opt, nullopt_t) noexcept
+{
+    return opt.has_value();
+}
+
+template<class T, class P>
+constexpr bool operator!=(nullopt_t, const compact_optional<T, P>& opt) noexcept
+{
+    return opt.has_value();
+}
+
+template<class T, class P>
+constexpr bool operator<(const compact_optional<T, P>&, nullopt_t) noexcept
+{
+    return false;
+}
+
+template<class T, class P>
+constexpr bool operator<(nullopt_t, const compact_optional<T, P>& opt) noexcept
+{
+    return opt.has_value();
+}
+
+template<class T, class P>
+constexpr bool operator<=(const compact_optional<T, P>& opt, nullopt_t) noexcept
+{
+    return !opt;
+}
+
+template<class T, class P>
+constexpr bool operator<=(nullopt_t, const compact_optional<T, P>&) noexcept
+{
+    return true;
+}
+
+template<class T, class P>
+constexpr bool operator>(const compact_optional<T, P>& opt, nullopt_t) noexcept
+{
+    return opt.has_value();
+}
+
+template<class T, class P>
+constexpr bool operator>(nullopt_t, const compact_optional<T, P>&) noexcept
+{
+    return false;
+}
+
+template<class T, class P>
+constexpr bool operator>=(const compact_optional<T, P>&, nullopt_t) noexcept
+{
+    return true;
+}
+
+template<class T, class P>
+constexpr bool operator>=(nullopt_t, const compact_optional<T, P>& opt) noexcept
+{
+    return !opt;
+}
+
+
+//compact_optional vs значение
+template<class T, class P, class U>
+constexpr bool operator==(const compact_optional<T, P>& opt, const U& value)
+{
+    return opt && *opt == value;
+}
+
+template<class U, class T, class P>
+constexpr bool operator==(const U& value, const compact_optional<T, P>& opt)
+{
+    return opt && value == *opt;
+}
+
+template<class T, class P, class U>
+constexpr bool operator!=(const compact_optional<T, P>& opt, const U& value)
+{
+    return !opt || *opt != value;
+}
+
+template<class U, class T, class P>
+constexpr bool operator!=(const U& value, const compact_optional<T, P>& opt)
+{
+    return !opt || value != *opt;
+}
+
+template<class T, class P, class U>
+constexpr bool operator<(const compact_optional<T, P>& opt, const U& value)
+{
+    return !opt || *opt < value;
+}
+
+template<class U, class T, class P>
+constexpr bool operator<(const U& value, const compact_optional<T, P>& opt)
+{
+    return opt && value < *opt;
+}
+
+template<class T, class P, class U>
+constexpr bool operator<=(const compact_optional<T, P>& opt, const U& value)
+{
+    return !opt || *opt <= value;
+}
+
+template<class U, class T, class P>
+constexpr bool operator<=(const U& value, const compact_optional<T, P>& opt)
+{
+    return opt && value <= *opt;
+}
+
+template<class T, class P, class U>
+constexpr bool operator>(const compact_optional<T, P>& opt, const U& value)
+{
+    return opt && *opt > value;
+}
+
+template<class U, class T, class P>
+constexpr bool operator>(const U& value, const compact_optional<T, P>& opt)
+{
+    return !opt || value > *opt;
+}
+
+template<class T, class P, class U>
+constexpr bool operator>=(const compact_optional<T, P>& opt, const U& value)
+{
+    return opt && *opt >= value;
+}
+
+template<class U, class T, class P>
+constexpr bool operator>=(const U& value, const compact_optional<T, P>& opt)
+{
+    return !opt || value >= *opt;
+}
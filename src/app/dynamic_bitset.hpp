@@ -0,0 +1,536 @@
+#pragma once
+
+#include <bits/stdc++.h>
+#include "all.hpp"
+#include "bitwords.hpp"
+#include "popcount.hpp"
+#include "bitchars.hpp"
+#include "aligned_allocator.hpp"
+
+
+/**
+ * @brief Набор битов, размер которого задаётся во время выполнения. API повторяет BitSet.
+ * @details Слова хранятся в непрерывном буфере, выделенном через Allocator (по умолчанию выровненном по кэш-линии),
+ * логические операции над наборами выполняются векторно теми же функциями, что и у BitSet.
+ * Биты последнего слова за пределами size() всегда нулевые.
+ * @tparam Integral Тип слова, в котором хранится набор. Должен быть беззнаковым.
+ * @tparam Allocator Аллокатор слов, например арена
+ */
+template<typename Integral = uint64_t, typename Allocator = aligned_allocator<Integral>>
+struct DynamicBitSet
+{
+	using type_t = Integral;
+	using allocator_type = Allocator;
+
+	static_assert(std::is_unsigned<Integral>::value, "DynamicBitSet type cannot be signed");
+	static_assert(std::is_same<typename std::allocator_traits<Allocator>::value_type, Integral>::value,
+				  "Allocator value_type must be the same as Integral");
+
+	/**
+	 * @brief Количество бит в одном слове
+	 */
+	static constexpr std::size_t word_bits = sizeof(type_t) * 8;
+
+	/**
+	 * @brief Итератор по номерам выставленных бит
+	 */
+	using const_iterator = detail::set_bit_iterator<type_t, std::size_t>;
+	using iterator = const_iterator;
+
+	/**
+	 * @brief Конструктор по умолчанию. Создает пустой набор нулевого размера.
+	 */
+	DynamicBitSet() = default;
+
+	/**
+	 * @brief Создаём набор заданного размера
+	 * @param size Количество битов в наборе
+	 * @param value Значение, которым заполняются все биты
+	 * @param alloc Аллокатор слов
+	 */
+	explicit DynamicBitSet(std::size_t size, bool value = false, const Allocator& alloc = Allocator())
+		: _words(words_for(size), value ? static_cast<type_t>(~static_cast<type_t>(0)) : static_cast<type_t>(0), alloc), _size(size)
+	{
+		strip();
+	}
+
+	/**
+	 * @brief Создаём пустой набор с заданным аллокатором
+	 * @param alloc Аллокатор слов
+	 */
+	explicit DynamicBitSet(const Allocator& alloc) : _words(alloc) {}
+
+	DynamicBitSet(const DynamicBitSet& other) = default;
+
+	DynamicBitSet(DynamicBitSet&& other) noexcept : _words(std::move(other._words)), _size(other._size)
+	{
+		other._size = 0;
+	}
+
+	DynamicBitSet& operator=(const DynamicBitSet& other) = default;
+
+	DynamicBitSet& operator=(DynamicBitSet&& other) noexcept
+	{
+		_words = std::move(other._words);
+		_size = other._size;
+		other._size = 0;
+		return *this;
+	}
+
+	/**
+	 * @brief Меняем размер набора
+	 * @details Существующие биты сохраняются, новые биты заполняются value. Слова переносятся как есть, без пересчёта.
+	 * @param size Новое количество битов
+	 * @param value Значение добавляемых битов
+	 */
+	void resize(std::size_t size, bool value = false)
+	{
+		const std::size_t old_size = _size;
+
+		//если растём и заполняем единицами, сначала выставляем хвост последнего слова
+		if(value && size > old_size && old_size % word_bits)
+			_words.back() |= static_cast<type_t>(static_cast<type_t>(~static_cast<type_t>(0)) << (old_size % word_bits));
+
+		_words.resize(words_for(size), value ? static_cast<type_t>(~static_cast<type_t>(0)) : static_cast<type_t>(0));
+		_size = size;
+		strip();
+	}
+
+	/**
+	 * @brief Резервируем место под size битов без изменения размера
+	 */
+	void reserve(std::size_t size)
+	{
+		_words.reserve(words_for(size));
+	}
+
+	/**
+	 * @brief Добавляем элемент в набор
+	 * @param index Бит, который нужно выставить в наборе
+	 */
+	inline DynamicBitSet& operator+=(std::size_t index) noexcept
+	{
+		set_impl(index);
+		return *this;
+	}
+
+	/**
+	 * @brief Удаляем элемент из набора
+	 * @param index Бит, который нужно сбросить в наборе
+	 */
+	inline DynamicBitSet& operator-=(std::size_t index) noexcept
+	{
+		reset_impl(index);
+		return *this;
+	}
+
+	/**
+	 * @brief Пересечение наборов. Размеры наборов должны совпадать.
+	 * @param other Второй набор
+	 */
+	inline DynamicBitSet& operator&=(const DynamicBitSet& other)
+	{
+		check_size(other);
+		detail::words_apply<detail::and_op>(_words.data(), _words.data(), other._words.data(), _words.size());
+		return *this;
+	}
+
+	/**
+	 * @brief Объединение наборов. Размеры наборов должны совпадать.
+	 * @param other Второй набор
+	 */
+	inline DynamicBitSet& operator|=(const DynamicBitSet& other)
+	{
+		check_size(other);
+		detail::words_apply<detail::or_op>(_words.data(), _words.data(), other._words.data(), _words.size());
+		return *this;
+	}
+
+	/**
+	 * @brief Симметрическая разность наборов. Размеры наборов должны совпадать.
+	 * @param other Второй набор
+	 */
+	inline DynamicBitSet& operator^=(const DynamicBitSet& other)
+	{
+		check_size(other);
+		detail::words_apply<detail::xor_op>(_words.data(), _words.data(), other._words.data(), _words.size());
+		return *this;
+	}
+
+	/**
+	 * @brief Разность наборов: убираем из текущего набора все элементы другого (this & ~other)
+	 * @param other Второй набор
+	 */
+	inline DynamicBitSet& and_not(const DynamicBitSet& other)
+	{
+		check_size(other);
+		detail::words_apply<detail::andnot_op>(_words.data(), _words.data(), other._words.data(), _words.size());
+		return *this;
+	}
+
+	inline friend DynamicBitSet operator&(DynamicBitSet lhs, const DynamicBitSet& rhs)
+	{
+		return lhs &= rhs;
+	}
+
+	inline friend DynamicBitSet operator|(DynamicBitSet lhs, const DynamicBitSet& rhs)
+	{
+		return lhs |= rhs;
+	}
+
+	inline friend DynamicBitSet operator^(DynamicBitSet lhs, const DynamicBitSet& rhs)
+	{
+		return lhs ^= rhs;
+	}
+
+	/**
+	 * @brief Дополнение набора. Биты за пределами size() остаются нулевыми.
+	 */
+	inline DynamicBitSet operator~() const
+	{
+		DynamicBitSet result(*this);
+		detail::words_not(result._words.data(), _words.data(), _words.size());
+		result.strip();
+		return result;
+	}
+
+	inline friend bool operator==(const DynamicBitSet& lhs, const DynamicBitSet& rhs) noexcept
+	{
+		return lhs._size == rhs._size && detail::words_equal(lhs._words.data(), rhs._words.data(), lhs._words.size());
+	}
+
+	inline friend bool operator!=(const DynamicBitSet& lhs, const DynamicBitSet& rhs) noexcept
+	{
+		return !(lhs == rhs);
+	}
+
+	/**
+	 * @brief Проверяем, выставлены ли в наборе все биты в true для переданных индексов
+	 * @param args Индексы, которые проверяем на то, выставлены в true они, или нет
+	 * @return true, если по всем переданным индексам биты выставлены, иначе false
+	 */
+	template<typename... Args, typename = typename std::enable_if<all_unsigned<std::decay_t<Args>...>::value>::type>
+	inline bool has(Args&&... args) const noexcept
+	{
+		for(const std::size_t arg : {static_cast<std::size_t>(args)...})
+		{
+			if(!has_impl(arg)) return false;
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Проверяем, выставлены ли все биты из второго набора в первом. Размеры наборов должны совпадать.
+	 * @param other Набор, который проверяем на включение в текущий набор
+	 * @return true, если текущий набор включает все элементы другого набора, иначе false
+	 */
+	inline bool has(const DynamicBitSet& other) const
+	{
+		check_size(other);
+		return detail::words_contains(_words.data(), other._words.data(), _words.size());
+	}
+
+	/**
+	 * @brief Проверяем, выставлен ли в наборе хотя бы один бит
+	 */
+	inline bool any() const noexcept
+	{
+		return detail::words_any(_words.data(), _words.size());
+	}
+
+	/**
+	 * @brief Проверяем, выставлены ли все биты в наборе. Для пустого набора возвращает true.
+	 */
+	inline bool all() const noexcept
+	{
+		const std::size_t full_words = _size / word_bits;
+		if(!detail::words_all(_words.data(), full_words)) return false;
+		return full_words == _words.size() || _words.back() == tail_mask();
+	}
+
+	/**
+	 * @brief Проверяем, что в наборе не выставлены ни один бит
+	 */
+	inline bool empty() const noexcept
+	{
+		return !any();
+	}
+
+	/**
+	 * @brief Выставляем биты в наборе
+	 * @param args Индексы битов, которые мы хотим выставить в true в наборе
+	 */
+	template<typename... Args, typename = typename std::enable_if<all_unsigned<std::decay_t<Args>...>::value>::type>
+	inline void set(Args&&... args) noexcept
+	{
+		for(const std::size_t arg : {static_cast<std::size_t>(args)...})
+		{
+			set_impl(arg);
+		}
+	}
+
+	/**
+	 * @brief Сбрасываем биты в наборе. Без аргументов сбрасываем весь набор.
+	 * @param args Индексы битов, которые мы хотим выставить в false в наборе
+	 */
+	template<typename... Args, typename = typename std::enable_if<all_unsigned<std::decay_t<Args>...>::value>::type>
+	inline void reset(Args&&... args) noexcept
+	{
+		if constexpr (!sizeof...(args))
+		{
+			std::fill(_words.begin(), _words.end(), static_cast<type_t>(0));
+		}
+		else
+		{
+			for(const std::size_t arg : {static_cast<std::size_t>(args)...})
+				reset_impl(arg);
+		}
+	}
+
+	/**
+	 * @brief Возвращаем размер набора в битах
+	 */
+	inline std::size_t size() const noexcept
+	{
+		return _size;
+	}
+
+	/**
+	 * @brief Количество слов, в которых хранится набор
+	 */
+	inline std::size_t word_count() const noexcept
+	{
+		return _words.size();
+	}
+
+	/**
+	 * @brief Возвращаем слово набора по его номеру
+	 */
+	inline type_t word(std::size_t index) const noexcept
+	{
+		return _words[index];
+	}
+
+	/**
+	 * @brief Указатель на массив слов набора. Младший бит набора - младший бит нулевого слова.
+	 */
+	inline const type_t* data() const noexcept
+	{
+		return _words.data();
+	}
+
+	inline type_t* data() noexcept
+	{
+		return _words.data();
+	}
+
+	inline allocator_type get_allocator() const noexcept
+	{
+		return _words.get_allocator();
+	}
+
+	/**
+	 * @brief Считаем количество бит, выставленных в 1 в наборе
+	 */
+	inline std::size_t count() const noexcept
+	{
+		const std::size_t bytes = _words.size() * sizeof(type_t);
+		if(bytes >= detail::popcount_dispatch_min_bytes) return detail::bytes_popcount(_words.data(), bytes);
+		return detail::words_count(_words.data(), _words.size());
+	}
+
+	/**
+	 * @brief Возвращаем строковое представление набора
+	 * @return Строковое представление набора в бинарном виде из size() символов, старший бит первым
+	 */
+	std::string to_string() const
+	{
+		std::string str(_size, '0');
+		to_chars(str.data(), str.data() + str.size());
+		return str;
+	}
+
+	/**
+	 * @brief Записываем набор в буфер вызывающего в виде size() символов '0'/'1', старший бит первым (как to_string)
+	 * @return ptr - конец записанного; ec == errc::value_too_large и ptr == last, если буфер меньше size()
+	 */
+	std::to_chars_result to_chars(char* first, char* last) const noexcept
+	{
+		if(static_cast<std::size_t>(last - first) < _size) return {last, std::errc::value_too_large};
+		detail::bits_to_chars(_words.data(), _size, first);
+		return {first + _size, std::errc()};
+	}
+
+	/**
+	 * @brief Разбираем строку из '0'/'1', старший бит первым. Размер набора не меняется, строка короче size() дополняется нулями слева.
+	 * @details Строка разбирается прямо в слова набора, без выделения памяти, поэтому при ошибке набор оказывается пустым.
+	 * ec == errc::invalid_argument для пустой строки или постороннего символа (ptr указывает на него),
+	 * ec == errc::result_out_of_range для строки длиннее size().
+	 */
+	std::from_chars_result from_chars(const char* first, const char* last) noexcept
+	{
+		std::fill(_words.begin(), _words.end(), 0);
+		const auto result = detail::bits_from_chars(first, last, _words.data(), _size);
+		if(result.ec != std::errc()) std::fill(_words.begin(), _words.end(), 0);
+		return result;
+	}
+
+	/**
+	 * @brief Ищем первый выставленный бит набора
+	 * @return Номер бита или size(), если набор пустой
+	 */
+	inline std::size_t find_first() const noexcept
+	{
+		return std::min(detail::words_find_from(_words.data(), _words.size(), 0), _size);
+	}
+
+	/**
+	 * @brief Ищем следующий выставленный бит после index
+	 * @return Номер бита или size(), если после index выставленных бит нет
+	 */
+	inline std::size_t find_next(std::size_t index) const noexcept
+	{
+		return std::min(detail::words_find_from(_words.data(), _words.size(), index + 1), _size);
+	}
+
+	/**
+	 * @brief Ищем последний выставленный бит набора
+	 * @return Номер бита или size(), если набор пустой
+	 */
+	inline std::size_t find_last() const noexcept
+	{
+		return std::min(detail::words_find_last(_words.data(), _words.size()), _size);
+	}
+
+	inline const_iterator begin() const noexcept
+	{
+		return const_iterator(_words.data(), _words.size(), 0);
+	}
+
+	inline const_iterator end() const noexcept
+	{
+		return const_iterator(_words.data(), _words.size(), _words.size());
+	}
+
+private:
+
+	/**
+	 * @brief Класс для работы с отдельным битом в наборе
+	 */
+	struct reference
+	{
+	public:
+		reference(type_t& word, std::size_t index)
+			: _word(word), _mask(static_cast<type_t>(static_cast<type_t>(1) << index)) {}
+
+		operator bool() const noexcept
+		{
+			return _word & _mask;
+		}
+
+		reference& operator=(bool flag) noexcept
+		{
+			if (flag)
+				_word |= _mask;
+			else
+				_word &= static_cast<type_t>(~_mask);
+			return *this;
+		}
+
+		reference& operator=(const reference& other) noexcept
+		{
+			return *this = static_cast<bool>(other);
+		}
+
+	private:
+		type_t& _word;
+		type_t _mask;
+	};
+
+	std::vector<type_t, Allocator> _words;
+	std::size_t _size{0};
+
+	/**
+	 * @brief Количество слов, нужное для хранения size бит
+	 */
+	static constexpr std::size_t words_for(std::size_t size) noexcept
+	{
+		return (size + word_bits - 1) / word_bits;
+	}
+
+	/**
+	 * @brief Маска значащих бит последнего слова
+	 */
+	inline type_t tail_mask() const noexcept
+	{
+		const std::size_t tail = _size % word_bits;
+		return tail ? static_cast<type_t>((static_cast<type_t>(1) << tail) - 1) : static_cast<type_t>(~static_cast<type_t>(0));
+	}
+
+	/**
+	 * @brief Обнуляем биты последнего слова, лежащие за пределами size()
+	 */
+	inline void strip() noexcept
+	{
+		if(!_words.empty()) _words.back() &= tail_mask();
+	}
+
+	/**
+	 * @brief Проверяем, что размер другого набора совпадает с текущим
+	 */
+	inline void check_size(const DynamicBitSet& other) const
+	{
+		if(other._size != _size) throw std::invalid_argument("DynamicBitSet: size mismatch");
+	}
+
+	static constexpr type_t bit_mask(std::size_t index) noexcept
+	{
+		return static_cast<type_t>(static_cast<type_t>(1) << (index % word_bits));
+	}
+
+	inline bool has_impl(std::size_t index) const noexcept
+	{
+		return _words[index / word_bits] & bit_mask(index);
+	}
+
+	inline void set_impl(std::size_t index) noexcept
+	{
+		_words[index / word_bits] |= bit_mask(index);
+	}
+
+	inline void reset_impl(std::size_t index) noexcept
+	{
+		_words[index / word_bits] &= static_cast<type_t>(~bit_mask(index));
+	}
+
+public:
+
+	/**
+	 * Небезопасный оператор, который генерирует UB при индексе, выходящем из диапазона значений
+	 * @brief Оператор доступа к биту по индексу
+	 */
+	inline reference operator[](std::size_t index) noexcept
+	{
+		return reference(_words[index / word_bits], index % word_bits);
+	}
+
+	inline bool operator[](std::size_t index) const noexcept
+	{
+		return has_impl(index);
+	}
+
+	/**
+	 * @brief Метод доступа к биту по индексу с проверкой диапазона
+	 */
+	inline reference at(std::size_t index)
+	{
+		if(index >= _size) throw std::out_of_range("DynamicBitSet::at: index out of range");
+		return reference(_words[index / word_bits], index % word_bits);
+	}
+
+	inline bool at(std::size_t index) const
+	{
+		if(index >= _size) throw std::out_of_range("DynamicBitSet::at: index out of range");
+		return has_impl(index);
+	}
+};
@@ -0,0 +1,329 @@
+#pragma once
+
+#include <bits/stdc++.h>
+
+/**
+ * @brief Верхняя граница значений перечисления, которые перебирает рефлексия
+ */
+#ifndef UTILS_ENUM_RANGE
+#define UTILS_ENUM_RANGE 256
+#endif
+
+
+/**
+ * @brief Рефлексия перечислений во время компиляции
+ * @details Имя значения берётся из __PRETTY_FUNCTION__ шаблона, инстанцированного этим значением:
+ * для объявленного значения компилятор печатает его имя (Color::Red), для необъявленного - приведение ((Color)7).
+ * Перебираются значения 0..UTILS_ENUM_RANGE - 1 (не больше максимума базового типа).
+ * Количество элементов - значение MaxValue, если оно объявлено в перечислении (принятый в библиотеке маркер конца),
+ * иначе последнее объявленное значение + 1. Значения от UTILS_ENUM_RANGE и выше рефлексия не видит, поэтому перечисление
+ * с такими значениями должно объявить MaxValue, а UTILS_ENUM_RANGE - быть не меньше его.
+ * Поиск значения по имени идёт по совершенной хеш-функции, построенной при компиляции (hash and displace):
+ * хеш имени выбирает корзину, смещение корзины - слот таблицы, в слоте единственный кандидат, которого
+ * остаётся сравнить с именем. Поэтому поиск стоит один хеш и одно сравнение строк независимо от числа элементов.
+ */
+namespace detail
+{
+	template<typename Enum, Enum V>
+	constexpr std::string_view enum_pretty_name() noexcept
+	{
+		return __PRETTY_FUNCTION__;
+	}
+
+	/**
+	 * @brief Имя значения без пространства имён и типа или пустая строка, если значение не объявлено
+	 */
+	template<typename Enum, Enum V>
+	constexpr std::string_view enum_value_name() noexcept
+	{
+		constexpr std::string_view pretty = enum_pretty_name<Enum, V>();
+		constexpr std::size_t start = pretty.find(" V = ") + 5;
+		constexpr std::size_t end = pretty.find_first_of(";,]", start);
+		constexpr std::string_view value = pretty.substr(start, end - start);
+
+		if constexpr (value.empty() || value[0] == '(' || (value[0] >= '0' && value[0] <= '9') || value[0] == '-')
+			return {};
+		else
+			return value.substr(value.find_last_of(':') == std::string_view::npos ? 0 : value.find_last_of(':') + 1);
+	}
+
+	template<typename Enum, typename = void>
+	struct enum_max_value
+	{
+		static constexpr bool declared = false;
+		static constexpr std::size_t value = 0;
+	};
+
+	template<typename Enum>
+	struct enum_max_value<Enum, std::void_t<decltype(Enum::MaxValue)>>
+	{
+		static constexpr bool declared = true;
+		static constexpr std::size_t value = static_cast<std::size_t>(Enum::MaxValue);
+	};
+
+	template<typename Enum>
+	constexpr std::size_t enum_reflect_range() noexcept
+	{
+		using type_t = std::underlying_type_t<Enum>;
+		//сравниваем максимумы, а не количества: для 64-битного типа max() + 1 переполняется в ноль
+		return static_cast<std::size_t>(std::min<std::uintmax_t>(UTILS_ENUM_RANGE - 1, std::numeric_limits<type_t>::max())) + 1;
+	}
+
+	template<typename Enum, std::size_t... I>
+	constexpr std::array<std::string_view, sizeof...(I)> enum_reflect_names(std::index_sequence<I...>) noexcept
+	{
+		return {{enum_value_name<Enum, static_cast<Enum>(I)>()...}};
+	}
+
+	/**
+	 * @brief Читаем Bytes байт имени как little-endian число. Во время выполнения - одна загрузка, при компиляции - побайтно.
+	 */
+	template<std::size_t Bytes>
+	constexpr std::uint64_t enum_name_load(const char* p) noexcept
+	{
+		if(!__builtin_is_constant_evaluated())
+		{
+			std::conditional_t<Bytes == 8, std::uint64_t, std::uint32_t> value = 0;
+			std::memcpy(&value, p, Bytes);
+			return value;
+		}
+
+		std::uint64_t value = 0;
+		for(std::size_t i = 0; i < Bytes; ++i)
+			value |= static_cast<std::uint64_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+		return value;
+	}
+
+	/**
+	 * @brief Хеш имени по 8 байт за шаг. Хвост читается загрузками с перекрытием, без побайтного цикла.
+	 */
+	constexpr std::uint64_t enum_name_hash(std::string_view name, std::uint64_t seed) noexcept
+	{
+		const char* p = name.data();
+		const std::size_t size = name.size();
+
+		std::uint64_t hash = seed ^ (size * 0x9E3779B97F4A7C15ull);
+		std::size_t i = 0;
+		for(; i + 8 < size; i += 8)
+		{
+			hash = (hash ^ enum_name_load<8>(p + i)) * 0xFF51AFD7ED558CCDull;
+			hash ^= hash >> 32;
+		}
+
+		std::uint64_t tail = 0;
+		if(size >= 8)
+			tail = enum_name_load<8>(p + size - 8);
+		else if(size >= 4)
+			tail = enum_name_load<4>(p) | (enum_name_load<4>(p + size - 4) << 32);
+		else if(size > 0)
+			tail = static_cast<std::uint64_t>(static_cast<unsigned char>(p[0])) |
+				   static_cast<std::uint64_t>(static_cast<unsigned char>(p[size / 2])) << 8 |
+				   static_cast<std::uint64_t>(static_cast<unsigned char>(p[size - 1])) << 16;
+
+		hash = (hash ^ tail) * 0xC4CEB9FE1A85EC53ull;
+		return hash ^ (hash >> 29);
+	}
+
+	/**
+	 * @brief Слот таблицы по хешу и смещению корзины
+	 */
+	constexpr std::size_t enum_hash_slot(std::uint64_t hash, std::uint32_t displacement, std::size_t mask) noexcept
+	{
+		std::uint64_t x = hash + displacement * 0x9E3779B97F4A7C15ull;
+		x = (x ^ (x >> 31)) * 0xBF58476D1CE4E5B9ull;
+		return static_cast<std::size_t>(x >> 40) & mask;
+	}
+
+	constexpr std::size_t enum_pow2_ceil(std::size_t n) noexcept
+	{
+		std::size_t result = 1;
+		while(result < n)
+			result *= 2;
+		return result;
+	}
+
+	/**
+	 * @brief Совершенная хеш-таблица имён перечисления
+	 * @tparam Size Количество имён (с пустыми для необъявленных значений)
+	 */
+	template<std::size_t Size>
+	struct enum_name_table
+	{
+		static constexpr std::size_t table_size = enum_pow2_ceil(std::max<std::size_t>(Size * 2, 4));
+		static constexpr std::size_t bucket_count = enum_pow2_ceil(std::max<std::size_t>(Size / 2, 1));
+
+		using index_t = std::conditional_t<(Size < 0xFFFF), std::uint16_t, std::uint32_t>;
+
+		static constexpr index_t empty = static_cast<index_t>(~static_cast<index_t>(0));
+
+		std::uint64_t seed = 0;
+		std::array<std::uint32_t, bucket_count> displacement{};
+		std::array<index_t, table_size> slots{};
+
+		/**
+		 * @brief Строим таблицу: корзины от больших к малым, каждой подбираем смещение, при котором её имена
+		 * попадают в разные свободные слоты. Если смещение не нашлось, меняем затравку хеша.
+		 */
+		constexpr explicit enum_name_table(const std::array<std::string_view, Size>& names)
+		{
+			for(std::uint64_t attempt = 0;; ++attempt)
+			{
+				seed = 0x2545F4914F6CDD1Dull * (attempt + 1);
+				if(build(names)) return;
+			}
+		}
+
+		/**
+		 * @brief Номер имени или Size, если такого имени нет
+		 */
+		constexpr std::size_t find(const std::array<std::string_view, Size>& names, std::string_view name) const noexcept
+		{
+			const std::uint64_t hash = enum_name_hash(name, seed);
+			const index_t index = slots[enum_hash_slot(hash, displacement[hash & (bucket_count - 1)], table_size - 1)];
+			return index != empty && names[index] == name ? index : Size;
+		}
+
+	private:
+
+		constexpr bool build(const std::array<std::string_view, Size>& names)
+		{
+			std::array<std::uint64_t, Size> hashes{};
+			std::array<std::size_t, bucket_count> sizes{};
+			std::size_t largest = 0;
+			for(std::size_t i = 0; i < Size; ++i)
+			{
+				if(names[i].empty()) continue;
+				hashes[i] = enum_name_hash(names[i], seed);
+				largest = std::max(largest, ++sizes[hashes[i] & (bucket_count - 1)]);
+			}
+
+			for(auto& slot : slots)
+				slot = empty;
+			for(auto& d : displacement)
+				d = 0;
+
+			for(std::size_t size = largest; size > 0; --size)
+			{
+				for(std::size_t bucket = 0; bucket < bucket_count; ++bucket)
+				{
+					if(sizes[bucket] != size) continue;
+					if(!place(names, hashes, bucket)) return false;
+				}
+			}
+			return true;
+		}
+
+		constexpr bool place(const std::array<std::string_view, Size>& names, const std::array<std::uint64_t, Size>& hashes, std::size_t bucket)
+		{
+			for(std::uint32_t d = 0; d < 4096; ++d)
+			{
+				bool fits = true;
+				for(std::size_t i = 0; i < Size && fits; ++i)
+				{
+					if(names[i].empty() || (hashes[i] & (bucket_count - 1)) != bucket) continue;
+					const std::size_t slot = enum_hash_slot(hashes[i], d, table_size - 1);
+					if(slots[slot] != empty) fits = false;
+					else slots[slot] = static_cast<index_t>(i);
+				}
+				if(fits)
+				{
+					displacement[bucket] = d;
+					return true;
+				}
+
+				//откатываем слоты, занятые этой попыткой
+				for(std::size_t i = 0; i < Size; ++i)
+				{
+					if(names[i].empty() || (hashes[i] & (bucket_count - 1)) != bucket) continue;
+					const std::size_t slot = enum_hash_slot(hashes[i], d, table_size - 1);
+					if(slots[slot] == i) slots[slot] = empty;
+				}
+			}
+			return false;
+		}
+	};
+}
+
+/**
+ * @brief Сведения о перечислении, полученные рефлексией
+ * @tparam Enum Перечисление с беззнаковым базовым типом и значениями от нуля
+ */
+template<typename Enum>
+struct enum_traits
+{
+	static_assert(std::is_enum<Enum>::value, "enum_traits can be used only with enum types");
+
+	/**
+	 * @brief Все перебранные значения 0..range - 1
+	 */
+	static constexpr std::size_t range = detail::enum_reflect_range<Enum>();
+
+	static constexpr std::array<std::string_view, range> all_names = detail::enum_reflect_names<Enum>(std::make_index_sequence<range>());
+
+private:
+
+	static constexpr std::size_t reflected_size() noexcept
+	{
+		std::size_t result = 0;
+		for(std::size_t i = 0; i < range; ++i)
+			if(!all_names[i].empty()) result = i + 1;
+		return result;
+	}
+
+	template<std::size_t... I>
+	static constexpr std::array<std::string_view, sizeof...(I)> head(std::index_sequence<I...>) noexcept
+	{
+		return {{all_names[I]...}};
+	}
+
+public:
+
+	/**
+	 * @brief Количество элементов: MaxValue, если объявлено, иначе последнее объявленное значение + 1
+	 */
+	static constexpr std::size_t size = detail::enum_max_value<Enum>::declared ? detail::enum_max_value<Enum>::value : reflected_size();
+
+	static_assert(size > 0, "No enum values below UTILS_ENUM_RANGE: declare MaxValue or raise UTILS_ENUM_RANGE");
+
+	static_assert(size <= range, "Enum values exceed UTILS_ENUM_RANGE");
+
+	/**
+	 * @brief Имена значений 0..size - 1; для необъявленных значений - пустые строки
+	 */
+	static constexpr std::array<std::string_view, size> names = head(std::make_index_sequence<size>());
+
+	static constexpr detail::enum_name_table<size> table{names};
+
+	/**
+	 * @brief Имя значения или пустая строка, если значение не объявлено или не меньше size
+	 */
+	static constexpr std::string_view name(Enum value) noexcept
+	{
+		const auto index = static_cast<std::size_t>(value);
+		return index < size ? names[index] : std::string_view();
+	}
+
+	/**
+	 * @brief Ищем значение по имени
+	 * @return true, если имя найдено
+	 */
+	static constexpr bool from_name(std::string_view name, Enum& value) noexcept
+	{
+		const std::size_t index = table.find(names, name);
+		if(index == size) return false;
+		value = static_cast<Enum>(index);
+		return true;
+	}
+};
+
+/**
+ * @brief Количество элементов перечисления (для BitMask по умолчанию)
+ */
+template<typename Enum>
+constexpr std::size_t enum_size = enum_traits<Enum>::size;
+
+template<typename Enum>
+constexpr std::string_view enum_name(Enum value) noexcept
+{
+	return enum_traits<Enum>::name(value);
+}
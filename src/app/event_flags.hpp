@@ -0,0 +1,222 @@
+#pragma once
+
+#include <bits/stdc++.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "bitmask.hpp"
+
+
+namespace detail
+{
+	/**
+	 * @brief Ждём на слове, пока оно равно expected и не пришло пробуждение с пересекающимся bitset
+	 * @param deadline Абсолютное время по CLOCK_MONOTONIC (steady_clock) или nullptr - без ограничения
+	 */
+	inline void futex_wait(const std::atomic<std::uint32_t>* word, std::uint32_t expected, const timespec* deadline, std::uint32_t bitset) noexcept
+	{
+		::syscall(SYS_futex, reinterpret_cast<const std::uint32_t*>(word), FUTEX_WAIT_BITSET | FUTEX_PRIVATE_FLAG,
+				  expected, deadline, nullptr, bitset);
+	}
+
+	/**
+	 * @brief Будим всех, кто ждёт на слове с bitset, пересекающимся с переданным
+	 */
+	inline void futex_wake(const std::atomic<std::uint32_t>* word, std::uint32_t bitset) noexcept
+	{
+		::syscall(SYS_futex, reinterpret_cast<const std::uint32_t*>(word), FUTEX_WAKE_BITSET | FUTEX_PRIVATE_FLAG,
+				  INT_MAX, nullptr, nullptr, bitset);
+	}
+}
+
+/**
+ * @brief Группа флагов событий (как event flags в RTOS) на атомарной BitMask
+ * @details Флаги хранятся в одном 32-битном атомарном слове, на нём же ждут потоки через futex.
+ * Ожидающий передаёт в FUTEX_WAIT_BITSET свою маску, а set будит с маской только что выставленных флагов,
+ * поэтому ядро будит лишь тех, чьи флаги изменились; clear не будит никого - ожидание всегда ждёт выставления.
+ * Если никто не ждёт (счётчик ожидающих равен нулю) или set не выставил новых флагов, системного вызова нет.
+ * wait_any/wait_all возвращают флаги в момент выполнения условия или истечения таймаута (как xEventGroupWaitBits):
+ * условие проверяется по результату. С clear_on_exit ожидаемые флаги сбрасываются той же атомарной операцией,
+ * которой проверено условие, поэтому одно событие достаётся ровно одному ожидающему.
+ * @tparam Enum Перечисление флагов
+ * @tparam N Количество флагов, не больше 32
+ */
+template<typename Enum, typename std::underlying_type<Enum>::type N = static_cast<typename std::underlying_type<Enum>::type>(enum_size<Enum>)>
+struct EventFlags
+{
+	using mask_t = BitMask<Enum, N>;
+	using type_t = typename mask_t::type_t;
+
+	static_assert(N <= 32, "EventFlags holds at most 32 flags: futex waits on a 32-bit word");
+
+	EventFlags() = default;
+
+	explicit EventFlags(const mask_t& flags) noexcept
+		: _flags(flags.value()) {}
+
+	EventFlags(const EventFlags&) = delete;
+
+	EventFlags& operator=(const EventFlags&) = delete;
+
+	/**
+	 * @brief Выставляем флаги и будим тех, кто ждёт хотя бы один из только что выставленных
+	 * @return Флаги до изменения
+	 */
+	inline mask_t set(const mask_t& flags) noexcept
+	{
+		const std::uint32_t bits = flags.value();
+		const std::uint32_t previous = _flags.fetch_or(bits, std::memory_order_seq_cst);
+
+		//seq_cst в паре с ожидающим: либо он увидит новые флаги, либо мы увидим его в счётчике
+		const std::uint32_t raised = bits & ~previous;
+		if(raised && _waiters.load(std::memory_order_seq_cst))
+			detail::futex_wake(&_flags, raised);
+		return to_mask(previous);
+	}
+
+	/**
+	 * @brief Сбрасываем флаги
+	 * @return Флаги до изменения
+	 */
+	inline mask_t clear(const mask_t& flags) noexcept
+	{
+		return to_mask(_flags.fetch_and(~static_cast<std::uint32_t>(flags.value()), std::memory_order_seq_cst));
+	}
+
+	/**
+	 * @brief Текущие флаги
+	 */
+	inline mask_t get() const noexcept
+	{
+		return to_mask(_flags.load(std::memory_order_seq_cst));
+	}
+
+	/**
+	 * @brief Количество потоков, ждущих сейчас в wait_any/wait_all
+	 */
+	inline std::size_t waiting() const noexcept
+	{
+		return _waiters.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Ждём, пока выставлен хотя бы один флаг из mask
+	 * @param clear_on_exit Сбросить флаги mask при выполнении условия
+	 * @return Флаги в момент выполнения условия. Для пустой mask условие не выполнится никогда, поэтому сразу возвращаются текущие флаги.
+	 */
+	inline mask_t wait_any(const mask_t& mask, bool clear_on_exit = false) noexcept
+	{
+		return wait<false>(mask.value(), nullptr, clear_on_exit);
+	}
+
+	/**
+	 * @brief Ждём, пока выставлен хотя бы один флаг из mask, но не дольше timeout
+	 * @return Флаги в момент выполнения условия или истечения таймаута; пересечение с mask пустое, если таймаут истёк
+	 */
+	template<typename Rep, typename Period>
+	inline mask_t wait_any(const mask_t& mask, const std::chrono::duration<Rep, Period>& timeout, bool clear_on_exit = false) noexcept
+	{
+		timespec deadline;
+		return wait<false>(mask.value(), make_deadline(timeout, deadline), clear_on_exit);
+	}
+
+	/**
+	 * @brief Ждём, пока выставлены все флаги из mask
+	 * @param clear_on_exit Сбросить флаги mask при выполнении условия
+	 * @return Флаги в момент выполнения условия
+	 */
+	inline mask_t wait_all(const mask_t& mask, bool clear_on_exit = false) noexcept
+	{
+		return wait<true>(mask.value(), nullptr, clear_on_exit);
+	}
+
+	/**
+	 * @brief Ждём, пока выставлены все флаги из mask, но не дольше timeout
+	 * @return Флаги в момент выполнения условия или истечения таймаута; has(mask) ложно, если таймаут истёк
+	 */
+	template<typename Rep, typename Period>
+	inline mask_t wait_all(const mask_t& mask, const std::chrono::duration<Rep, Period>& timeout, bool clear_on_exit = false) noexcept
+	{
+		timespec deadline;
+		return wait<true>(mask.value(), make_deadline(timeout, deadline), clear_on_exit);
+	}
+
+private:
+
+	static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t), "futex needs a plain 32-bit word");
+
+	std::atomic<std::uint32_t> _flags{0};
+	std::atomic<std::uint32_t> _waiters{0};
+
+	static inline mask_t to_mask(std::uint32_t bits) noexcept
+	{
+		return mask_t(static_cast<type_t>(bits));
+	}
+
+	template<bool All>
+	static inline bool satisfied(std::uint32_t flags, std::uint32_t mask) noexcept
+	{
+		return All ? (flags & mask) == mask : (flags & mask) != 0;
+	}
+
+	/**
+	 * @brief Абсолютный срок по steady_clock (CLOCK_MONOTONIC - часы FUTEX_WAIT_BITSET)
+	 * @return nullptr, если таймаут настолько велик, что ждать нужно без ограничения
+	 */
+	template<typename Rep, typename Period>
+	static const timespec* make_deadline(const std::chrono::duration<Rep, Period>& timeout, timespec& deadline) noexcept
+	{
+		//больше ~30 лет - без ограничения, заодно избегаем переполнения при переводе в наносекунды
+		if(std::chrono::duration<double>(timeout).count() > 1e9) return nullptr;
+
+		const auto relative = std::max(std::chrono::ceil<std::chrono::nanoseconds>(timeout), std::chrono::nanoseconds(0));
+		const auto since_epoch = (std::chrono::steady_clock::now() + relative).time_since_epoch();
+		const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(since_epoch);
+		deadline.tv_sec = static_cast<time_t>(seconds.count());
+		deadline.tv_nsec = static_cast<long>(std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch - seconds).count());
+		return &deadline;
+	}
+
+	static bool expired(const timespec* deadline) noexcept
+	{
+		if(!deadline) return false;
+		timespec now;
+		::clock_gettime(CLOCK_MONOTONIC, &now);
+		return now.tv_sec > deadline->tv_sec || (now.tv_sec == deadline->tv_sec && now.tv_nsec >= deadline->tv_nsec);
+	}
+
+	/**
+	 * @brief Проверяем условие и, если нужно, сбрасываем флаги одной операцией
+	 * @return true, если условие выполнено; flags - флаги до сброса
+	 */
+	template<bool All>
+	inline bool try_take(std::uint32_t& flags, std::uint32_t mask, bool clear_on_exit) noexcept
+	{
+		flags = _flags.load(std::memory_order_seq_cst);
+		while(satisfied<All>(flags, mask))
+		{
+			if(!clear_on_exit || _flags.compare_exchange_weak(flags, flags & ~mask, std::memory_order_seq_cst))
+				return true;
+		}
+		return false;
+	}
+
+	template<bool All>
+	mask_t wait(std::uint32_t mask, const timespec* deadline, bool clear_on_exit) noexcept
+	{
+		std::uint32_t flags;
+		//быстрый путь без регистрации в счётчике ожидающих
+		if(try_take<All>(flags, mask, clear_on_exit) || (!All && !mask) || expired(deadline)) return to_mask(flags);
+
+		_waiters.fetch_add(1, std::memory_order_seq_cst);
+		for(;;)
+		{
+			if(try_take<All>(flags, mask, clear_on_exit) || expired(deadline)) break;
+
+			//ядро сравнит слово с flags: если флаги успели измениться, вернёмся сразу и проверим снова
+			detail::futex_wait(&_flags, flags, deadline, mask);
+		}
+		_waiters.fetch_sub(1, std::memory_order_relaxed);
+		return to_mask(flags);
+	}
+};
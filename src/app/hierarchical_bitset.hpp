@@ -0,0 +1,333 @@
+#pragma once
+
+#include <bits/stdc++.h>
+#include "all.hpp"
+#include "bitset.hpp"
+
+
+namespace detail
+{
+	/**
+	 * @brief Количество бит на уровне иерархии: на уровне 0 - сами биты, на уровне k - по биту на слово уровня k-1
+	 */
+	constexpr std::size_t hierarchy_level_bits(std::size_t bits, std::size_t word_bits, std::size_t level) noexcept
+	{
+		for(std::size_t i = 0; i < level; ++i)
+			bits = (bits + word_bits - 1) / word_bits;
+		return bits;
+	}
+
+	/**
+	 * @brief Количество уровней сводки над bits битами: последний уровень умещается в одно слово
+	 */
+	constexpr std::size_t hierarchy_levels(std::size_t bits, std::size_t word_bits) noexcept
+	{
+		std::size_t level = 1;
+		while(hierarchy_level_bits(bits, word_bits, level) > word_bits)
+			++level;
+		return level;
+	}
+
+	/**
+	 * @brief Смещение уровня сводки (с 1) в общем массиве слов сводки
+	 */
+	constexpr std::size_t hierarchy_level_offset(std::size_t bits, std::size_t word_bits, std::size_t level) noexcept
+	{
+		std::size_t offset = 0;
+		for(std::size_t i = 1; i < level; ++i)
+			offset += (hierarchy_level_bits(bits, word_bits, i) + word_bits - 1) / word_bits;
+		return offset;
+	}
+}
+
+/**
+ * @brief Набор битов с иерархией сводок для поиска за O(log64 N)
+ * @details Биты хранятся в обычном BitSet<uint64_t, N>. Над ним строятся две иерархии сводок,
+ * по одному биту на слово нижнего уровня: в сводке any бит выставлен, если в слове есть единица,
+ * в сводке free - если в слове есть ноль. Уровни добавляются, пока верхний не поместится в одно слово
+ * (для 16M бит - три уровня). Поиск первого выставленного или сброшенного бита спускается от верхнего слова
+ * и стоит одну tzcnt на уровень, set/reset поднимаются вверх только пока слово меняет состояние пусто/полно.
+ * @tparam N Количество битов в наборе
+ */
+template<std::size_t N>
+struct HierarchicalBitSet
+{
+	using type_t = std::uint64_t;
+	using bitset_t = BitSet<type_t, N>;
+	using const_iterator = typename bitset_t::const_iterator;
+	using iterator = const_iterator;
+
+	static constexpr std::size_t word_bits = bitset_t::word_bits;
+	static constexpr std::size_t word_count = bitset_t::word_count;
+
+	/**
+	 * @brief Количество уровней сводки: последний умещается в одно слово
+	 */
+	static constexpr std::size_t levels = detail::hierarchy_levels(N, word_bits);
+
+	static constexpr std::size_t level_bits(std::size_t level) noexcept
+	{
+		return detail::hierarchy_level_bits(N, word_bits, level);
+	}
+
+	static constexpr std::size_t level_offset(std::size_t level) noexcept
+	{
+		return detail::hierarchy_level_offset(N, word_bits, level);
+	}
+
+	/**
+	 * @brief Общее количество слов во всех уровнях одной сводки
+	 */
+	static constexpr std::size_t summary_words = detail::hierarchy_level_offset(N, word_bits, levels + 1);
+
+	/**
+	 * @brief Конструктор по умолчанию. Создает пустой набор.
+	 */
+	HierarchicalBitSet() noexcept
+	{
+		//все слова пустые: в каждом есть сброшенный бит
+		for(std::size_t level = 1; level <= levels; ++level)
+		{
+			const std::size_t bits = level_bits(level);
+			type_t* words = _free + level_offset(level);
+			for(std::size_t i = 0; i < bits / word_bits; ++i)
+				words[i] = ~static_cast<type_t>(0);
+			if(bits % word_bits)
+				words[bits / word_bits] = (static_cast<type_t>(1) << (bits % word_bits)) - 1;
+		}
+	}
+
+	/**
+	 * @brief Проверяем, выставлены ли все переданные биты
+	 */
+	template<typename... Args, typename = typename std::enable_if<all_unsigned<std::decay_t<Args>...>::value>::type>
+	inline bool has(Args&&... args) const noexcept
+	{
+		return (has_impl(args) && ...);
+	}
+
+	inline bool operator[](std::size_t index) const noexcept
+	{
+		return has_impl(index);
+	}
+
+	/**
+	 * @brief Выставляем биты и обновляем сводки
+	 */
+	template<typename... Args, typename = typename std::enable_if<all_unsigned<std::decay_t<Args>...>::value>::type>
+	inline void set(Args&&... args) noexcept
+	{
+		(set_impl(args), ...);
+	}
+
+	/**
+	 * @brief Сбрасываем биты и обновляем сводки
+	 */
+	template<typename... Args, typename = typename std::enable_if<all_unsigned<std::decay_t<Args>...>::value>::type>
+	inline void reset(Args&&... args) noexcept
+	{
+		(reset_impl(args), ...);
+	}
+
+	/**
+	 * @brief Ищем первый выставленный бит
+	 * @return Номер бита или size(), если набор пустой
+	 */
+	inline std::size_t find_first_set() const noexcept
+	{
+		return find_from<false>(_any, 0);
+	}
+
+	/**
+	 * @brief Ищем первый сброшенный бит
+	 * @return Номер бита или size(), если все биты выставлены
+	 */
+	inline std::size_t find_first_clear() const noexcept
+	{
+		return find_from<true>(_free, 0);
+	}
+
+	/**
+	 * @brief Ищем следующий выставленный бит после index
+	 * @return Номер бита или size(), если таких нет
+	 */
+	inline std::size_t find_next(std::size_t index) const noexcept
+	{
+		return find_from<false>(_any, index + 1);
+	}
+
+	/**
+	 * @brief Ищем следующий сброшенный бит после index
+	 * @return Номер бита или size(), если таких нет
+	 */
+	inline std::size_t find_next_clear(std::size_t index) const noexcept
+	{
+		return find_from<true>(_free, index + 1);
+	}
+
+	/**
+	 * @brief Проверяем, выставлен ли хотя бы один бит (по верхней сводке)
+	 */
+	inline bool any() const noexcept
+	{
+		return _any[level_offset(levels)] != 0;
+	}
+
+	inline bool empty() const noexcept
+	{
+		return !any();
+	}
+
+	/**
+	 * @brief Проверяем, выставлены ли все биты (по верхней сводке)
+	 */
+	inline bool all() const noexcept
+	{
+		return _free[level_offset(levels)] == 0;
+	}
+
+	inline std::size_t count() const noexcept
+	{
+		return _bits.count();
+	}
+
+	inline constexpr std::size_t size() const noexcept
+	{
+		return N;
+	}
+
+	/**
+	 * @brief Сами биты набора
+	 */
+	inline const bitset_t& bits() const noexcept
+	{
+		return _bits;
+	}
+
+	inline const_iterator begin() const noexcept
+	{
+		return _bits.begin();
+	}
+
+	inline const_iterator end() const noexcept
+	{
+		return _bits.end();
+	}
+
+private:
+
+	bitset_t _bits;
+	type_t _any[summary_words]{};
+	type_t _free[summary_words]{};
+
+	static constexpr type_t bit_mask(std::size_t index) noexcept
+	{
+		return static_cast<type_t>(1) << (index % word_bits);
+	}
+
+	/**
+	 * @brief Маска значащих бит слова index уровня 0
+	 */
+	static constexpr type_t valid_mask(std::size_t index) noexcept
+	{
+		return index + 1 == word_count && N % word_bits ? (static_cast<type_t>(1) << (N % word_bits)) - 1 : ~static_cast<type_t>(0);
+	}
+
+	inline bool has_impl(std::size_t index) const noexcept
+	{
+		return _bits.word(index / word_bits) & bit_mask(index);
+	}
+
+	inline void set_impl(std::size_t index) noexcept
+	{
+		const std::size_t w = index / word_bits;
+		type_t& word = _bits.data()[w];
+		const type_t old = word;
+		word |= bit_mask(index);
+
+		if(old == 0 && word != 0) summary_set(_any, w);
+		if(word == valid_mask(w) && old != word) summary_reset(_free, w);
+	}
+
+	inline void reset_impl(std::size_t index) noexcept
+	{
+		const std::size_t w = index / word_bits;
+		type_t& word = _bits.data()[w];
+		const type_t old = word;
+		word &= ~bit_mask(index);
+
+		if(old != 0 && word == 0) summary_reset(_any, w);
+		if(old == valid_mask(w) && old != word) summary_set(_free, w);
+	}
+
+	/**
+	 * @brief Выставляем бит сводки и поднимаемся выше, пока слово было пустым
+	 */
+	static void summary_set(type_t* summary, std::size_t index) noexcept
+	{
+		for(std::size_t level = 1; level <= levels; ++level, index /= word_bits)
+		{
+			type_t& word = summary[level_offset(level) + index / word_bits];
+			const bool was_empty = word == 0;
+			word |= bit_mask(index);
+			if(!was_empty) return;
+		}
+	}
+
+	/**
+	 * @brief Сбрасываем бит сводки и поднимаемся выше, пока слово становится пустым
+	 */
+	static void summary_reset(type_t* summary, std::size_t index) noexcept
+	{
+		for(std::size_t level = 1; level <= levels; ++level, index /= word_bits)
+		{
+			type_t& word = summary[level_offset(level) + index / word_bits];
+			word &= ~bit_mask(index);
+			if(word != 0) return;
+		}
+	}
+
+	/**
+	 * @brief Слово уровня 0, в котором искомые биты выставлены (для поиска нулей - инвертированное)
+	 */
+	template<bool Clear>
+	inline type_t level0(std::size_t index) const noexcept
+	{
+		return Clear ? static_cast<type_t>(~_bits.word(index)) : _bits.word(index);
+	}
+
+	/**
+	 * @brief Ищем первый искомый бит с номером не меньше pos: проверяем остаток его слова,
+	 * поднимаемся по сводке до уровня, где справа есть непустое поддерево, и спускаемся в него по tzcnt
+	 */
+	template<bool Clear>
+	std::size_t find_from(const type_t* summary, std::size_t pos) const noexcept
+	{
+		if(pos >= N) return N;
+
+		std::size_t index = pos / word_bits;
+		const type_t first = level0<Clear>(index) & (~static_cast<type_t>(0) << (pos % word_bits));
+		//в последнем слове инвертированные лишние биты выглядят как нули, поэтому ограничиваем N
+		if(first) return std::min(index * word_bits + detail::word_ctz(first), N);
+
+		std::size_t level = 1;
+		for(; level <= levels; ++level, index /= word_bits)
+		{
+			const std::size_t next = index + 1;
+			if(next % word_bits == 0) continue;
+
+			const type_t word = summary[level_offset(level) + index / word_bits] & (~static_cast<type_t>(0) << (next % word_bits));
+			if(word)
+			{
+				index = index / word_bits * word_bits + detail::word_ctz(word);
+				break;
+			}
+		}
+		if(level > levels) return N;
+
+		for(; level > 1; --level)
+			index = index * word_bits + detail::word_ctz(summary[level_offset(level - 1) + index]);
+
+		return index * word_bits + detail::word_ctz(level0<Clear>(index));
+	}
+};
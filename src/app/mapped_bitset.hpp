@@ -0,0 +1,415 @@
+#pragma once
+
+#include <bits/stdc++.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "all.hpp"
+#include "bitwords.hpp"
+#include "popcount.hpp"
+
+
+namespace detail
+{
+	/**
+	 * @brief Заголовок файла MappedBitSet. Занимает 64 байта, чтобы слова в отображении были выровнены по кэш-линии.
+	 */
+	struct mapped_bitset_header
+	{
+		static constexpr char expected_magic[8] = {'U', 'T', 'L', 'B', 'I', 'T', 'S', '\0'};
+		static constexpr std::uint32_t current_version = 1;
+
+		char magic[8];
+		std::uint32_t version;
+		std::uint32_t word_size;
+		std::uint64_t bit_count;
+		std::uint64_t checksum;
+		std::uint64_t reserved[4];
+	};
+
+	static_assert(sizeof(mapped_bitset_header) == 64, "MappedBitSet header must be 64 bytes");
+
+	/**
+	 * @brief Контрольная сумма слов файла: по слову за шаг, чтобы проверка гигабайтного файла шла со скоростью чтения памяти
+	 */
+	inline std::uint64_t mapped_checksum(const std::uint64_t* words, std::size_t n) noexcept
+	{
+		std::uint64_t hash = 0xCBF29CE484222325ull ^ n;
+		for(std::size_t i = 0; i < n; ++i)
+		{
+			hash ^= words[i];
+			hash = ((hash << 27) | (hash >> 37)) * 0x9E3779B97F4A7C15ull;
+		}
+		return hash;
+	}
+
+	/**
+	 * @brief Записываем буфер в файл целиком
+	 */
+	inline void write_all(int fd, const void* data, std::size_t size, const std::string& path)
+	{
+		const auto* p = static_cast<const char*>(data);
+		while(size)
+		{
+			const ssize_t written = ::write(fd, p, size);
+			if(written < 0)
+			{
+				if(errno == EINTR) continue;
+				throw std::system_error(errno, std::generic_category(), "MappedBitSet: cannot write " + path);
+			}
+			p += written;
+			size -= static_cast<std::size_t>(written);
+		}
+	}
+}
+
+/**
+ * @brief Набор битов, отображённый в память прямо из файла
+ * @details Файл состоит из заголовка mapped_bitset_header и слов набора, как в DynamicBitSet<uint64_t>.
+ * Открытие - это один вызов mmap: страницы подгружаются при первом обращении, а процессы,
+ * открывшие один файл, делят одни и те же страницы кэша ОС.
+ * Контрольная сумма проверяется только по запросу (verify), чтобы не читать весь файл при старте.
+ * Файл пишет save(): через временный файл и rename, поэтому уже открытые отображения не портятся.
+ * Порядок байт слов - порядок платформы (little-endian).
+ */
+struct MappedBitSet
+{
+	using type_t = std::uint64_t;
+	using header_t = detail::mapped_bitset_header;
+	using const_iterator = detail::set_bit_iterator<type_t, std::size_t>;
+	using iterator = const_iterator;
+
+	/**
+	 * @brief Количество бит в одном слове
+	 */
+	static constexpr std::size_t word_bits = sizeof(type_t) * 8;
+
+	/**
+	 * @brief Режим отображения
+	 */
+	enum class mapping
+	{
+		read_only,		///< Только чтение, страницы общие для всех процессов
+		copy_on_write	///< Запись разрешена, изменённые страницы копируются и в файл не попадают
+	};
+
+	/**
+	 * @brief Отображаем файл в память
+	 * @param path Путь к файлу, записанному save()
+	 * @param mode Режим отображения
+	 * @param verify Проверить контрольную сумму (читает весь файл)
+	 * @throw std::system_error Если файл не удалось открыть или отобразить
+	 * @throw std::runtime_error Если файл повреждён или записан несовместимой версией
+	 */
+	explicit MappedBitSet(const std::string& path, mapping mode = mapping::read_only, bool verify = false) : _mode(mode)
+	{
+		const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if(fd < 0) throw std::system_error(errno, std::generic_category(), "MappedBitSet: cannot open " + path);
+
+		struct stat st;
+		if(::fstat(fd, &st) != 0)
+		{
+			const int error = errno;
+			::close(fd);
+			throw std::system_error(error, std::generic_category(), "MappedBitSet: cannot stat " + path);
+		}
+
+		_length = static_cast<std::size_t>(st.st_size);
+		if(_length < sizeof(header_t))
+		{
+			::close(fd);
+			throw std::runtime_error("MappedBitSet: file is too small: " + path);
+		}
+
+		const int protection = mode == mapping::read_only ? PROT_READ : PROT_READ | PROT_WRITE;
+		const int flags = mode == mapping::read_only ? MAP_SHARED : MAP_PRIVATE;
+		void* base = ::mmap(nullptr, _length, protection, flags, fd, 0);
+		const int error = errno;
+		//отображение держит файл само, дескриптор больше не нужен
+		::close(fd);
+		if(base == MAP_FAILED) throw std::system_error(error, std::generic_category(), "MappedBitSet: cannot map " + path);
+
+		_base = base;
+		try
+		{
+			check_header(path, verify);
+		}
+		catch(...)
+		{
+			unmap();
+			throw;
+		}
+	}
+
+	MappedBitSet(const MappedBitSet&) = delete;
+
+	MappedBitSet& operator=(const MappedBitSet&) = delete;
+
+	MappedBitSet(MappedBitSet&& other) noexcept
+		: _base(std::exchange(other._base, nullptr)), _length(std::exchange(other._length, 0)),
+		  _words(std::exchange(other._words, nullptr)), _size(std::exchange(other._size, 0)), _mode(other._mode) {}
+
+	MappedBitSet& operator=(MappedBitSet&& other) noexcept
+	{
+		if(this != &other)
+		{
+			unmap();
+			_base = std::exchange(other._base, nullptr);
+			_length = std::exchange(other._length, 0);
+			_words = std::exchange(other._words, nullptr);
+			_size = std::exchange(other._size, 0);
+			_mode = other._mode;
+		}
+		return *this;
+	}
+
+	~MappedBitSet()
+	{
+		unmap();
+	}
+
+	/**
+	 * @brief Записываем набор в файл в формате MappedBitSet
+	 * @param path Путь к файлу. Существующий файл заменяется атомарно.
+	 * @param words Слова набора, биты за пределами bits должны быть сброшены
+	 * @param bits Количество бит в наборе
+	 * @throw std::system_error Если файл не удалось записать
+	 */
+	static void save(const std::string& path, const type_t* words, std::size_t bits)
+	{
+		const std::size_t count = (bits + word_bits - 1) / word_bits;
+
+		header_t header{};
+		std::memcpy(header.magic, header_t::expected_magic, sizeof(header.magic));
+		header.version = header_t::current_version;
+		header.word_size = sizeof(type_t);
+		header.bit_count = bits;
+		header.checksum = detail::mapped_checksum(words, count);
+
+		const std::string temp = path + ".tmp";
+		const int fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+		if(fd < 0) throw std::system_error(errno, std::generic_category(), "MappedBitSet: cannot create " + temp);
+
+		try
+		{
+			detail::write_all(fd, &header, sizeof(header), temp);
+			detail::write_all(fd, words, count * sizeof(type_t), temp);
+			if(::fsync(fd) != 0) throw std::system_error(errno, std::generic_category(), "MappedBitSet: cannot sync " + temp);
+		}
+		catch(...)
+		{
+			::close(fd);
+			::unlink(temp.c_str());
+			throw;
+		}
+
+		::close(fd);
+		if(::rename(temp.c_str(), path.c_str()) != 0)
+		{
+			const int error = errno;
+			::unlink(temp.c_str());
+			throw std::system_error(error, std::generic_category(), "MappedBitSet: cannot rename " + temp);
+		}
+	}
+
+	/**
+	 * @brief Записываем в файл набор с 64-битными словами (BitSet, DynamicBitSet)
+	 */
+	template<typename Set, typename = typename std::enable_if<std::is_same<typename Set::type_t, type_t>::value>::type>
+	static void save(const std::string& path, const Set& set)
+	{
+		save(path, set.data(), set.size());
+	}
+
+	/**
+	 * @brief Проверяем, выставлены ли все переданные биты
+	 */
+	template<typename... Args, typename = typename std::enable_if<all_unsigned<std::decay_t<Args>...>::value>::type>
+	inline bool has(Args&&... args) const noexcept
+	{
+		return (has_impl(args) && ...);
+	}
+
+	inline bool operator[](std::size_t index) const noexcept
+	{
+		return has_impl(index);
+	}
+
+	/**
+	 * @brief Выставляем биты. Только для режима copy_on_write, изменения в файл не попадают.
+	 * @throw std::logic_error Если набор открыт только для чтения
+	 */
+	template<typename... Args, typename = typename std::enable_if<all_unsigned<std::decay_t<Args>...>::value>::type>
+	inline void set(Args&&... args)
+	{
+		check_writable();
+		((_words[args / word_bits] |= bit_mask(args)), ...);
+	}
+
+	/**
+	 * @brief Сбрасываем биты. Только для режима copy_on_write, изменения в файл не попадают.
+	 * @throw std::logic_error Если набор открыт только для чтения
+	 */
+	template<typename... Args, typename = typename std::enable_if<all_unsigned<std::decay_t<Args>...>::value>::type>
+	inline void reset(Args&&... args)
+	{
+		check_writable();
+		((_words[args / word_bits] &= ~bit_mask(args)), ...);
+	}
+
+	/**
+	 * @brief Проверяем, выставлен ли хотя бы один бит
+	 */
+	inline bool any() const noexcept
+	{
+		return detail::words_any(_words, word_count());
+	}
+
+	inline bool empty() const noexcept
+	{
+		return !any();
+	}
+
+	/**
+	 * @brief Считаем количество выставленных бит ядром, выбранным по CPUID
+	 */
+	inline std::size_t count() const noexcept
+	{
+		return detail::bytes_popcount(_words, word_count() * sizeof(type_t));
+	}
+
+	/**
+	 * @brief Ищем первый выставленный бит набора
+	 * @return Номер бита или size(), если набор пустой
+	 */
+	inline std::size_t find_first() const noexcept
+	{
+		return std::min(detail::words_find_from(_words, word_count(), 0), _size);
+	}
+
+	/**
+	 * @brief Ищем следующий выставленный бит после index
+	 * @return Номер бита или size(), если таких нет
+	 */
+	inline std::size_t find_next(std::size_t index) const noexcept
+	{
+		return std::min(detail::words_find_from(_words, word_count(), index + 1), _size);
+	}
+
+	/**
+	 * @brief Ищем последний выставленный бит набора
+	 * @return Номер бита или size(), если набор пустой
+	 */
+	inline std::size_t find_last() const noexcept
+	{
+		return std::min(detail::words_find_last(_words, word_count()), _size);
+	}
+
+	inline const_iterator begin() const noexcept
+	{
+		return const_iterator(_words, word_count(), 0);
+	}
+
+	inline const_iterator end() const noexcept
+	{
+		return const_iterator(_words, word_count(), word_count());
+	}
+
+	/**
+	 * @brief Проверяем контрольную сумму слов. Читает весь файл.
+	 */
+	inline bool verify() const noexcept
+	{
+		return detail::mapped_checksum(_words, word_count()) == header().checksum;
+	}
+
+	/**
+	 * @brief Просим ОС заранее подгрузить страницы файла (madvise MADV_WILLNEED)
+	 */
+	inline void prefetch() const noexcept
+	{
+		::madvise(_base, _length, MADV_WILLNEED);
+	}
+
+	inline std::size_t size() const noexcept
+	{
+		return _size;
+	}
+
+	inline std::size_t word_count() const noexcept
+	{
+		return (_size + word_bits - 1) / word_bits;
+	}
+
+	inline type_t word(std::size_t index) const noexcept
+	{
+		return _words[index];
+	}
+
+	inline const type_t* data() const noexcept
+	{
+		return _words;
+	}
+
+	inline mapping mode() const noexcept
+	{
+		return _mode;
+	}
+
+private:
+
+	void* _base = nullptr;
+	std::size_t _length = 0;
+	type_t* _words = nullptr;
+	std::size_t _size = 0;
+	mapping _mode = mapping::read_only;
+
+	inline const header_t& header() const noexcept
+	{
+		return *static_cast<const header_t*>(_base);
+	}
+
+	void check_header(const std::string& path, bool verify_checksum)
+	{
+		const header_t& h = header();
+		if(std::memcmp(h.magic, header_t::expected_magic, sizeof(h.magic)) != 0)
+			throw std::runtime_error("MappedBitSet: not a bitset file: " + path);
+		if(h.version != header_t::current_version)
+			throw std::runtime_error("MappedBitSet: unsupported version " + std::to_string(h.version) + ": " + path);
+		if(h.word_size != sizeof(type_t))
+			throw std::runtime_error("MappedBitSet: unsupported word size " + std::to_string(h.word_size) + ": " + path);
+
+		//сравниваем с вместимостью файла до округления: у испорченного bit_count около 2^64 округление переполняется
+		const std::uint64_t capacity = (_length - sizeof(header_t)) / sizeof(type_t);
+		if(h.bit_count > capacity * word_bits)
+			throw std::runtime_error("MappedBitSet: file is truncated: " + path);
+
+		_size = static_cast<std::size_t>(h.bit_count);
+		_words = reinterpret_cast<type_t*>(static_cast<char*>(_base) + sizeof(header_t));
+
+		if(verify_checksum && !verify())
+			throw std::runtime_error("MappedBitSet: checksum mismatch: " + path);
+	}
+
+	inline void check_writable() const
+	{
+		if(_mode == mapping::read_only) throw std::logic_error("MappedBitSet: mapping is read-only");
+	}
+
+	inline void unmap() noexcept
+	{
+		if(_base) ::munmap(_base, _length);
+		_base = nullptr;
+	}
+
+	static constexpr type_t bit_mask(std::size_t index) noexcept
+	{
+		return static_cast<type_t>(1) << (index % word_bits);
+	}
+
+	inline bool has_impl(std::size_t index) const noexcept
+	{
+		return _words[index / word_bits] & bit_mask(index);
+	}
+};
@@ -0,0 +1,462 @@
+#pragma once
+
+#include <bits/stdc++.h>
+#include "optional.hpp"
+#include "dynamic_bitset.hpp"
+
+namespace detail
+{
+    /**
+     * @brief Тип суммы: double/float для чисел с плавающей точкой, 64-битное целое нужной знаковости для целых
+     */
+    template<typename T>
+    using nullable_sum_t = std::conditional_t<std::is_floating_point<T>::value, T,
+                           std::conditional_t<std::is_signed<T>::value, std::int64_t, std::uint64_t>>;
+
+    /**
+     * @brief Свёртка значений, чьи биты выставлены в validity
+     * @details Значения обходятся блоками по 64 - по слову маски. Пустые слова пропускаются, в полных слагаемые
+     * берутся подряд, в смешанных отсутствующие заменяются нейтральным элементом без ветвлений.
+     * Аккумулятор - кэш-линия независимых полос, поэтому компилятор разворачивает внутренний цикл в векторные
+     * инструкции и для чисел с плавающей точкой (порядок сложения внутри полосы не меняется).
+     * @param values Значения, не меньше words * 64
+     * @param validity Слова маски, бит i соответствует values[i]
+     * @param identity Нейтральный элемент op
+     */
+    template<typename Acc, typename T, typename Op>
+    Acc masked_reduce(const T* values, const std::uint64_t* validity, std::size_t words, Acc identity, Op op) noexcept
+    {
+        constexpr std::size_t lanes = 64 / sizeof(Acc) ? 64 / sizeof(Acc) : 1;
+        Acc acc[lanes];
+        for(std::size_t k = 0; k < lanes; ++k)
+            acc[k] = identity;
+
+        for(std::size_t w = 0; w < words; ++w)
+        {
+            const std::uint64_t bits = validity[w];
+            const T* block = values + w * 64;
+            if(!bits) continue;
+            if(bits == ~std::uint64_t(0))
+            {
+                for(std::size_t j = 0; j < 64; j += lanes)
+                    for(std::size_t k = 0; k < lanes; ++k)
+                        acc[k] = op(acc[k], static_cast<Acc>(block[j + k]));
+            }
+            else
+            {
+                for(std::size_t j = 0; j < 64; j += lanes)
+                    for(std::size_t k = 0; k < lanes; ++k)
+                        acc[k] = op(acc[k], (bits >> (j + k)) & 1 ? static_cast<Acc>(block[j + k]) : identity);
+            }
+        }
+
+        Acc result = identity;
+        for(std::size_t k = 0; k < lanes; ++k)
+            result = op(result, acc[k]);
+        return result;
+    }
+
+    /**
+     * @brief Записываем fill во все значения, чьи биты в keep сброшены
+     * @details Слова из одних единиц пропускаются, в остальных выбор между старым значением и fill без ветвлений.
+     */
+    template<typename T>
+    void masked_fill(T* values, const std::uint64_t* keep, std::size_t words, std::uint64_t tail, const T& fill) noexcept
+    {
+        for(std::size_t w = 0; w < words; ++w)
+        {
+            const std::uint64_t bits = keep[w] | (w + 1 == words ? tail : 0);
+            T* block = values + w * 64;
+            if(bits == ~std::uint64_t(0)) continue;
+            if(!bits)
+            {
+                std::fill(block, block + 64, fill);
+                continue;
+            }
+            for(std::size_t j = 0; j < 64; ++j)
+                block[j] = (bits >> j) & 1 ? block[j] : fill;
+        }
+    }
+}
+
+/**
+ * @brief Столбец необязательных значений: непрерывный буфер T и отдельная маска присутствия (validity)
+ * @details В отличие от vector<optional<T>>, флаг не перемежается со значениями и не добавляет выравнивание:
+ * значения лежат подряд и обрабатываются векторно, маска - слова DynamicBitSet, бит 1 означает, что значение есть.
+ * Раскладка совпадает с Apache Arrow: маска в порядке младший бит первым, оба буфера выровнены по 64 байтам,
+ * буфер значений дополнен до целого числа блоков по 64 элемента. Поэтому values() и validity().data()
+ * передаются в Arrow без копирования. Значения на месте отсутствующих не определены.
+ * @tparam T Тривиально копируемый тип
+ */
+template<typename T>
+struct nullable_vector
+{
+    static_assert(std::is_trivially_copyable<T>::value, "nullable_vector stores trivially copyable types");
+
+    using value_type = T;
+    using size_type = std::size_t;
+    using validity_type = DynamicBitSet<std::uint64_t>;
+
+    /**
+     * @brief Количество элементов в одном блоке - по числу бит слова маски
+     */
+    static constexpr size_type block_size = validity_type::word_bits;
+
+    /**
+     * @brief Прокси элемента с интерфейсом optional
+     * @details Присваивание значения или nullopt меняет и значение, и бит маски.
+     */
+    template<bool Const>
+    class element_reference
+    {
+        using value_ref = std::conditional_t<Const, const T&, T&>;
+        using word_ref = std::conditional_t<Const, const std::uint64_t&, std::uint64_t&>;
+
+    public:
+        element_reference(value_ref value, word_ref word, std::uint64_t mask) noexcept : _value(value), _word(word), _mask(mask)
+        {}
+
+        template<bool C = Const, typename = std::enable_if_t<C>>
+        element_reference(const element_reference<false>& other) noexcept : _value(*other), _word(other._word), _mask(other._mask)
+        {}
+
+        bool has_value() const noexcept
+        {
+            return _word & _mask;
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return has_value();
+        }
+
+        value_ref value() const
+        {
+            return has_value() ? _value : throw bad_optional_access();
+        }
+
+        template<class U>
+        T value_or(U&& u) const
+        {
+            return has_value() ? _value : static_cast<T>(std::forward<U>(u));
+        }
+
+        /**
+         * @brief Оператор разыменования
+         * @details Для отсутствующего элемента значение не определено
+         */
+        value_ref operator*() const noexcept
+        {
+            return _value;
+        }
+
+        std::add_pointer_t<value_ref> operator->() const noexcept
+        {
+            return &_value;
+        }
+
+        operator optional<T>() const
+        {
+            return has_value() ? optional<T>(_value) : optional<T>();
+        }
+
+        const element_reference& operator=(const T& value) const noexcept
+        {
+            static_assert(!Const, "cannot assign through nullable_vector::const_reference");
+            _value = value;
+            _word |= _mask;
+            return *this;
+        }
+
+        const element_reference& operator=(nullopt_t) const noexcept
+        {
+            reset();
+            return *this;
+        }
+
+        const element_reference& operator=(const optional<T>& other) const noexcept
+        {
+            return other ? *this = *other : *this = nullopt;
+        }
+
+        /**
+         * @brief Присваивание копирует элемент, а не перенаправляет прокси
+         */
+        const element_reference& operator=(const element_reference& other) const noexcept
+        {
+            return other ? *this = *other : *this = nullopt;
+        }
+
+        template<class... Args>
+        value_ref emplace(Args&&... args) const
+        {
+            *this = T(std::forward<Args>(args)...);
+            return _value;
+        }
+
+        void reset() const noexcept
+        {
+            static_assert(!Const, "cannot reset through nullable_vector::const_reference");
+            _word &= ~_mask;
+        }
+
+        friend bool operator==(const element_reference& ref, nullopt_t) noexcept
+        {
+            return !ref;
+        }
+
+        friend bool operator==(nullopt_t, const element_reference& ref) noexcept
+        {
+            return !ref;
+        }
+
+        friend bool operator!=(const element_reference& ref, nullopt_t) noexcept
+        {
+            return ref.has_value();
+        }
+
+        friend bool operator!=(nullopt_t, const element_reference& ref) noexcept
+        {
+            return ref.has_value();
+        }
+
+        friend bool operator==(const element_reference& ref, const T& value)
+        {
+            return ref && *ref == value;
+        }
+
+        friend bool operator==(const T& value, const element_reference& ref)
+        {
+            return ref && *ref == value;
+        }
+
+        friend bool operator!=(const element_reference& ref, const T& value)
+        {
+            return !(ref == value);
+        }
+
+        friend bool operator!=(const T& value, const element_reference& ref)
+        {
+            return !(ref == value);
+        }
+
+    private:
+        template<bool>
+        friend class element_reference;
+
+        value_ref _value;
+        word_ref _word;
+        std::uint64_t _mask;
+    };
+
+    using reference = element_reference<false>;
+    using const_reference = element_reference<true>;
+
+    nullable_vector() = default;
+
+    /**
+     * @brief Создаём count отсутствующих элементов
+     */
+    explicit nullable_vector(size_type count)
+    {
+        resize(count);
+    }
+
+    /**
+     * @brief Создаём count элементов, равных value
+     */
+    nullable_vector(size_type count, const T& value) : _values(blocks_for(count) * block_size, value), _validity(count, true)
+    {}
+
+    nullable_vector(std::initializer_list<optional<T>> il)
+    {
+        reserve(il.size());
+        for(const optional<T>& value : il)
+            push_back(value);
+    }
+
+    void push_back(const T& value)
+    {
+        grow_one();
+        _values[size()] = value;
+        _validity.resize(size() + 1, true);
+    }
+
+    void push_back(nullopt_t)
+    {
+        grow_one();
+        _validity.resize(size() + 1);
+    }
+
+    void push_back(const optional<T>& value)
+    {
+        if(value) push_back(*value);
+        else push_back(nullopt);
+    }
+
+    /**
+     * @brief Меняем размер; новые элементы отсутствуют
+     */
+    void resize(size_type count)
+    {
+        _values.resize(blocks_for(count) * block_size);
+        _validity.resize(count);
+    }
+
+    void reserve(size_type count)
+    {
+        _values.reserve(blocks_for(count) * block_size);
+        _validity.reserve(count);
+    }
+
+    void clear() noexcept
+    {
+        _values.clear();
+        _validity.resize(0);
+    }
+
+    reference operator[](size_type index) noexcept
+    {
+        return reference(_values[index], _validity.data()[index / block_size], mask_of(index));
+    }
+
+    const_reference operator[](size_type index) const noexcept
+    {
+        return const_reference(_values[index], _validity.data()[index / block_size], mask_of(index));
+    }
+
+    reference at(size_type index)
+    {
+        if(index >= size()) throw std::out_of_range("nullable_vector: index out of range");
+        return (*this)[index];
+    }
+
+    const_reference at(size_type index) const
+    {
+        if(index >= size()) throw std::out_of_range("nullable_vector: index out of range");
+        return (*this)[index];
+    }
+
+    size_type size() const noexcept
+    {
+        return _validity.size();
+    }
+
+    bool empty() const noexcept
+    {
+        return size() == 0;
+    }
+
+    /**
+     * @brief Буфер значений в формате Arrow: size() значений, дополненных до кратного block_size
+     */
+    T* values() noexcept
+    {
+        return _values.data();
+    }
+
+    const T* values() const noexcept
+    {
+        return _values.data();
+    }
+
+    /**
+     * @brief Маска присутствия: бит i выставлен, если значение i есть
+     */
+    const validity_type& validity() const noexcept
+    {
+        return _validity;
+    }
+
+    /**
+     * @brief Количество присутствующих значений - popcount маски
+     */
+    size_type count_valid() const noexcept
+    {
+        return _validity.count();
+    }
+
+    size_type null_count() const noexcept
+    {
+        return size() - count_valid();
+    }
+
+    /**
+     * @brief Заменяем отсутствующие значения на value, после чего присутствуют все элементы
+     */
+    void fill_null(const T& value)
+    {
+        const size_type count = size();
+        const std::uint64_t tail = count % block_size ? ~std::uint64_t(0) << (count % block_size) : 0;
+        detail::masked_fill(_values.data(), _validity.data(), _validity.word_count(), tail, value);
+        _validity.resize(0);
+        _validity.resize(count, true);
+    }
+
+    /**
+     * @brief Сумма присутствующих значений; 0, если таких нет
+     */
+    detail::nullable_sum_t<T> sum() const noexcept
+    {
+        static_assert(std::is_arithmetic<T>::value, "nullable_vector::sum needs an arithmetic type");
+        using sum_t = detail::nullable_sum_t<T>;
+        return detail::masked_reduce<sum_t>(_values.data(), _validity.data(), _validity.word_count(), sum_t(0),
+                                            [](sum_t a, sum_t b) { return a + b; });
+    }
+
+    /**
+     * @brief Наименьшее из присутствующих значений; пусто, если таких нет
+     */
+    optional<T> min() const noexcept
+    {
+        static_assert(std::is_arithmetic<T>::value, "nullable_vector::min needs an arithmetic type");
+        if(!count_valid()) return nullopt;
+        return detail::masked_reduce<T>(_values.data(), _validity.data(), _validity.word_count(), min_identity(),
+                                        [](T a, T b) { return b < a ? b : a; });
+    }
+
+    /**
+     * @brief Наибольшее из присутствующих значений; пусто, если таких нет
+     */
+    optional<T> max() const noexcept
+    {
+        static_assert(std::is_arithmetic<T>::value, "nullable_vector::max needs an arithmetic type");
+        if(!count_valid()) return nullopt;
+        return detail::masked_reduce<T>(_values.data(), _validity.data(), _validity.word_count(), max_identity(),
+                                        [](T a, T b) { return a < b ? b : a; });
+    }
+
+private:
+    std::vector<T, aligned_allocator<T>> _values;
+    validity_type _validity;
+
+    static constexpr size_type blocks_for(size_type count) noexcept
+    {
+        return (count + block_size - 1) / block_size;
+    }
+
+    static constexpr std::uint64_t mask_of(size_type index) noexcept
+    {
+        return std::uint64_t(1) << (index % block_size);
+    }
+
+    /**
+     * @brief Добавляем блок значений, если следующий элемент начинает новый блок
+     */
+    void grow_one()
+    {
+        if(size() % block_size == 0) _values.resize(_values.size() + block_size);
+    }
+
+    static constexpr T min_identity() noexcept
+    {
+        if constexpr (std::numeric_limits<T>::has_infinity) return std::numeric_limits<T>::infinity();
+        else return std::numeric_limits<T>::max();
+    }
+
+    static constexpr T max_identity() noexcept
+    {
+        if constexpr (std::numeric_limits<T>::has_infinity) return -std::numeric_limits<T>::infinity();
+        else return std::numeric_limits<T>::lowest();
+    }
+};
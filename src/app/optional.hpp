@@ -2,6 +2,11 @@
 
 #include <type_traits>
 #include <exception>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <utility>
+#include "relocate.hpp"
 
 struct bad_optional_access : std::exception
 {
@@ -24,6 +29,11 @@ struct in_place_t
     explicit in_place_t() = default;
 };
 
+constexpr in_place_t in_place{};
+
+template<class T>
+struct optional;
+
 namespace detail
 {
     template <typename T, typename U>
@@ -39,7 +49,12 @@ namespace detail
     struct ctor_convert_assign;
 }
 
-template<class T, typename = void>
+/**
+ * @brief Хранилище значения optional
+ * @details Для тривиально разрушаемого T деструктор тривиальный. Копирование и перемещение хранилища
+ * тривиальны, если тривиальны у T, иначе (из-за union) удалены - их определяют слои ниже.
+ */
+template<class T, bool = std::is_trivially_destructible<T>::value>
 struct optional_storage
 {
     union 
@@ -49,15 +64,31 @@ struct optional_storage
     };
 
     bool _engaged;
-    
+
+    constexpr optional_storage() noexcept : _dummy(0), _engaged(false)
+    {}
+
+    template<class... Args>
+    constexpr explicit optional_storage(in_place_t, Args&&... args) : _val(std::forward<Args>(args)...), _engaged(true)
+    {}
+
     ~optional_storage() 
     {
         if(_engaged) _val.~T();
     }
+
+    void reset() noexcept
+    {
+        if(_engaged)
+        {
+            _val.~T();
+            _engaged = false;
+        }
+    }
 };
 
 template<class T>
-struct optional_storage<T, typename std::enable_if<std::is_trivially_destructible<T>::value>::type>
+struct optional_storage<T, true>
 {
     union 
     {
@@ -66,345 +97,419 @@ struct optional_storage<T, typename std::enable_if<std::is_trivially_destructibl
     };
 
     bool _engaged;
-    
-    ~optional_storage() = default;
-};
 
-template<class T>
-struct optional 
-{
-    /**
-     * @brief 
-     */
-    constexpr optional() noexcept : _storage{._dummy = 0, ._engaged = false}
+    constexpr optional_storage() noexcept : _dummy(0), _engaged(false)
     {}
 
-    /**
-     * @brief 
-     */
-    constexpr optional(nullopt_t) noexcept : _storage{._dummy = 0, ._engaged = false}
+    template<class... Args>
+    constexpr explicit optional_storage(in_place_t, Args&&... args) : _val(std::forward<Args>(args)...), _engaged(true)
     {}
 
-    /**
-     * @brief 
-     */
-    template <typename U = T, std::enable_if_t<!std::is_trivially_copy_constructible<U>::value>>
-    optional(const optional& other)
+    ~optional_storage() = default;
+
+    void reset() noexcept
     {
-        if(other._storage._engaged)
-        {
-            new(&_storage._val) T(other._storage._val);
-            _storage._engaged = true;
-        }else
+        _engaged = false;
+    }
+};
+
+/**
+ * @brief Слои optional: каждая специальная функция тривиальна, если она тривиальна у T, и написана руками иначе
+ * @details Так же устроены optional в стандартных библиотеках: optional<int> тривиально копируется, vector
+ * переносит его memcpy, а в функции он передаётся в регистрах.
+ */
+namespace detail
+{
+    template<class T>
+    struct optional_base : optional_storage<T>
+    {
+        using optional_storage<T>::optional_storage;
+
+        template<class... Args>
+        void construct(Args&&... args)
         {
-            _storage._dummy = 0;
-            _storage._engaged = false;
+            new(std::addressof(this->_val)) T(std::forward<Args>(args)...);
+            this->_engaged = true;
         }
-    }
 
-    template <typename U = T, std::enable_if_t<!std::is_copy_constructible<U>::value>>
-    optional(const optional& other) = delete;
+        /**
+         * @brief Присваивание из другого хранилища: значение присваивается, создаётся или разрушается
+         */
+        template<class Other>
+        void assign(Other&& other)
+        {
+            if(!other._engaged)
+                this->reset();
+            else if(this->_engaged)
+                this->_val = std::forward<Other>(other)._val;
+            else
+                construct(std::forward<Other>(other)._val);
+        }
+    };
 
-    optional(const optional& other) = default;
+    template<class T, bool = std::is_trivially_copy_constructible<T>::value>
+    struct optional_copy_base : optional_base<T>
+    {
+        using optional_base<T>::optional_base;
+    };
 
-    /**
-     * @brief 
-     */
-    template <typename U = T, std::enable_if_t<!std::is_trivially_move_constructible<U>::value>>
-    optional(optional&& other) noexcept(std::is_nothrow_move_constructible<U>::value)
+    template<class T>
+    struct optional_copy_base<T, false> : optional_base<T>
     {
-        if(other._storage._engaged)
+        using optional_base<T>::optional_base;
+
+        optional_copy_base() = default;
+
+        optional_copy_base(const optional_copy_base& other)
         {
-            new(&_storage._val) T(std::move(other._storage._val));
-            _storage._engaged = true;
-            other._storage._engaged = false;
-        }else
+            if(other._engaged) this->construct(other._val);
+        }
+
+        optional_copy_base(optional_copy_base&&) = default;
+        optional_copy_base& operator=(const optional_copy_base&) = default;
+        optional_copy_base& operator=(optional_copy_base&&) = default;
+    };
+
+    template<class T, bool = std::is_trivially_move_constructible<T>::value>
+    struct optional_move_base : optional_copy_base<T>
+    {
+        using optional_copy_base<T>::optional_copy_base;
+    };
+
+    template<class T>
+    struct optional_move_base<T, false> : optional_copy_base<T>
+    {
+        using optional_copy_base<T>::optional_copy_base;
+
+        optional_move_base() = default;
+        optional_move_base(const optional_move_base&) = default;
+
+        optional_move_base(optional_move_base&& other) noexcept(std::is_nothrow_move_constructible<T>::value)
         {
-            _storage._dummy = 0;
-            _storage._engaged = false;
+            if(other._engaged) this->construct(std::move(other._val));
         }
-    }
 
-    template <typename U = T, typename std::enable_if_t<!std::is_move_constructible<U>::value, bool> = 0>
-    optional(optional&& other) = delete;
+        optional_move_base& operator=(const optional_move_base&) = default;
+        optional_move_base& operator=(optional_move_base&&) = default;
+    };
 
-    optional(optional&& other) = default;
+    template<class T, bool = std::is_trivially_copy_constructible<T>::value &&
+                             std::is_trivially_copy_assignable<T>::value &&
+                             std::is_trivially_destructible<T>::value>
+    struct optional_copy_assign_base : optional_move_base<T>
+    {
+        using optional_move_base<T>::optional_move_base;
+    };
 
-    /**
-     * @brief 
-     */
-    template<class U, std::enable_if_t<(!detail::convertible<T, U>::value && !detail::constructible<T, U>::value) ||
-                                                                     std::is_constructible<T, const U&>::value>>
-    constexpr optional(const optional<U>& other)
+    template<class T>
+    struct optional_copy_assign_base<T, false> : optional_move_base<T>
     {
-        if(other._storage._engaged)
+        using optional_move_base<T>::optional_move_base;
+
+        optional_copy_assign_base() = default;
+        optional_copy_assign_base(const optional_copy_assign_base&) = default;
+        optional_copy_assign_base(optional_copy_assign_base&&) = default;
+
+        optional_copy_assign_base& operator=(const optional_copy_assign_base& other)
         {
-            new(&_storage._val) T(other._storage._val);
-            _storage._engaged = true;
-        }else
+            if(this != &other) this->assign(other);
+            return *this;
+        }
+
+        optional_copy_assign_base& operator=(optional_copy_assign_base&&) = default;
+    };
+
+    template<class T, bool = std::is_trivially_move_constructible<T>::value &&
+                             std::is_trivially_move_assignable<T>::value &&
+                             std::is_trivially_destructible<T>::value>
+    struct optional_move_assign_base : optional_copy_assign_base<T>
+    {
+        using optional_copy_assign_base<T>::optional_copy_assign_base;
+    };
+
+    template<class T>
+    struct optional_move_assign_base<T, false> : optional_copy_assign_base<T>
+    {
+        using optional_copy_assign_base<T>::optional_copy_assign_base;
+
+        optional_move_assign_base() = default;
+        optional_move_assign_base(const optional_move_assign_base&) = default;
+        optional_move_assign_base(optional_move_assign_base&&) = default;
+        optional_move_assign_base& operator=(const optional_move_assign_base&) = default;
+
+        optional_move_assign_base& operator=(optional_move_assign_base&& other) noexcept(std::is_nothrow_move_assignable<T>::value &&
+                                                                                       std::is_nothrow_move_constructible<T>::value)
         {
-            _storage._dummy = 0;
-            _storage._engaged = false;
+            if(this != &other) this->assign(std::move(other));
+            return *this;
         }
-    }
+    };
 
     /**
-     * @brief
+     * @brief Удаляем специальные функции optional, которых нет у T. Пустые базы не занимают места.
      */
-    template<class U, std::enable_if_t<(!detail::convertible<T, U>::value && !detail::constructible<T, U>::value) ||
-                                                                    std::is_constructible<T, U&&>::value>>
-    constexpr optional(optional<U>&& other)
+    template<bool>
+    struct optional_enable_copy {};
+
+    template<>
+    struct optional_enable_copy<false>
     {
-        if(other._storage._engaged)
-        {
-            new(&_storage._val) T(std::move(other._storage._val));
-            _storage._engaged = true;
-            other._storage._engaged = false;
-        }else
-        {
-            _storage._dummy = 0;
-            _storage._engaged = false;
-        }
-    }
+        optional_enable_copy() = default;
+        optional_enable_copy(const optional_enable_copy&) = delete;
+        optional_enable_copy(optional_enable_copy&&) = default;
+        optional_enable_copy& operator=(const optional_enable_copy&) = default;
+        optional_enable_copy& operator=(optional_enable_copy&&) = default;
+    };
+
+    template<bool>
+    struct optional_enable_move {};
+
+    template<>
+    struct optional_enable_move<false>
+    {
+        optional_enable_move() = default;
+        optional_enable_move(const optional_enable_move&) = default;
+        optional_enable_move(optional_enable_move&&) = delete;
+        optional_enable_move& operator=(const optional_enable_move&) = default;
+        optional_enable_move& operator=(optional_enable_move&&) = default;
+    };
+
+    template<bool>
+    struct optional_enable_copy_assign {};
+
+    template<>
+    struct optional_enable_copy_assign<false>
+    {
+        optional_enable_copy_assign() = default;
+        optional_enable_copy_assign(const optional_enable_copy_assign&) = default;
+        optional_enable_copy_assign(optional_enable_copy_assign&&) = default;
+        optional_enable_copy_assign& operator=(const optional_enable_copy_assign&) = delete;
+        optional_enable_copy_assign& operator=(optional_enable_copy_assign&&) = default;
+    };
+
+    template<bool>
+    struct optional_enable_move_assign {};
 
-    template<class... Args, std::enable_if_t<std::is_constructible<T, Args...>::value>>
-    constexpr explicit optional(in_place_t, Args&&... args)
+    template<>
+    struct optional_enable_move_assign<false>
     {
-        new(&_storage._val) T(std::forward<Args>(args)...);
-        _storage._engaged = true;
+        optional_enable_move_assign() = default;
+        optional_enable_move_assign(const optional_enable_move_assign&) = default;
+        optional_enable_move_assign(optional_enable_move_assign&&) = default;
+        optional_enable_move_assign& operator=(const optional_enable_move_assign&) = default;
+        optional_enable_move_assign& operator=(optional_enable_move_assign&&) = delete;
+    };
+
+    template<class T, class U>
+    using enable_value_ctor = std::enable_if_t<std::is_constructible<T, U&&>::value &&
+                                               !std::is_same<std::decay_t<U>, in_place_t>::value &&
+                                               !std::is_same<std::decay_t<U>, optional<T>>::value, int>;
+
+    template<class T, class U, class From>
+    using enable_convert_ctor = std::enable_if_t<!std::is_same<T, U>::value &&
+                                                 std::is_constructible<T, From>::value &&
+                                                 !constructible<T, U>::value && !convertible<T, U>::value, int>;
+}
+
+/**
+ * @brief Необязательное значение
+ * @details Копирование, перемещение и деструктор тривиальны ровно тогда, когда они тривиальны у T
+ * (см. слои detail::optional_*_base), и удалены, если их нет у T.
+ */
+template<class T>
+struct optional : private detail::optional_move_assign_base<T>,
+                  private detail::optional_enable_copy<std::is_copy_constructible<T>::value>,
+                  private detail::optional_enable_move<std::is_move_constructible<T>::value>,
+                  private detail::optional_enable_copy_assign<std::is_copy_constructible<T>::value && std::is_copy_assignable<T>::value>,
+                  private detail::optional_enable_move_assign<std::is_move_constructible<T>::value && std::is_move_assignable<T>::value>
+{
+private:
+    using base = detail::optional_move_assign_base<T>;
+
+    template<class U>
+    friend struct optional;
+
+public:
+    using value_type = T;
+
+    /**
+     * @brief Создаём пустой объект
+     */
+    constexpr optional() noexcept = default;
+
+    /**
+     * @brief Создаём пустой объект
+     */
+    constexpr optional(nullopt_t) noexcept
+    {}
+
+    optional(const optional& other) = default;
+
+    optional(optional&& other) = default;
+
+    /**
+     * @brief Создаём из optional другого типа
+     */
+    template<class U, detail::enable_convert_ctor<T, U, const U&> = 0>
+    optional(const optional<U>& other)
+    {
+        if(other._engaged) this->construct(other._val);
     }
 
-    template<class U, class... Args, std::enable_if_t<std::is_constructible<T, std::initializer_list<U>&, Args...>::value>>
-    constexpr explicit optional(in_place_t, std::initializer_list<U> il, Args&&... args)
+    template<class U, detail::enable_convert_ctor<T, U, U&&> = 0>
+    optional(optional<U>&& other)
     {
-        new(&_storage._val) T(il, std::forward<Args>(args)...);
-        _storage._engaged = true;
+        if(other._engaged) this->construct(std::move(other._val));
     }
 
     /**
-     * @brief
+     * @brief Создаём значение на месте из аргументов конструктора T
      */
-    template <typename U, std::enable_if_t<
-                                            std::is_constructible<T, U>::value &&
-                                            !std::is_same<optional<T>, typename std::decay_t<U>>::value && 
-                                            !std::is_same<in_place_t, typename std::decay_t<U>>::value &&
-                                            (
-                                                std::is_same<typename std::decay_t<T>, bool>::value && 
-                                                !std::is_same<optional, typename std::decay_t<U>>::value
-                                            )
-                                            >
-            >
-    constexpr optional(U&& value)
-    {
-        new(&_storage._val) T(std::forward<U>(value));
-        _storage._engaged = true;
-    }
+    template<class... Args, std::enable_if_t<std::is_constructible<T, Args...>::value, int> = 0>
+    constexpr explicit optional(in_place_t, Args&&... args) : base(in_place, std::forward<Args>(args)...)
+    {}
+
+    template<class U, class... Args, std::enable_if_t<std::is_constructible<T, std::initializer_list<U>&, Args...>::value, int> = 0>
+    constexpr explicit optional(in_place_t, std::initializer_list<U> il, Args&&... args) : base(in_place, il, std::forward<Args>(args)...)
+    {}
+
+    /**
+     * @brief Создаём из значения. Конструктор неявный, если U неявно приводится к T.
+     */
+    template<class U = T, detail::enable_value_ctor<T, U> = 0, std::enable_if_t<std::is_convertible<U&&, T>::value, int> = 0>
+    constexpr optional(U&& value) : base(in_place, std::forward<U>(value))
+    {}
+
+    template<class U = T, detail::enable_value_ctor<T, U> = 0, std::enable_if_t<!std::is_convertible<U&&, T>::value, int> = 0>
+    constexpr explicit optional(U&& value) : base(in_place, std::forward<U>(value))
+    {}
 
     /**
      * @brief Проверяем, инициализирован ли объект
      */
-    bool has_value() const noexcept
+    constexpr bool has_value() const noexcept
     {
-        return _storage._engaged;
+        return this->_engaged;
     }
 
     template<class... Args>
     T& emplace(Args&&... args)
     {   
-        if(_storage._engaged)
-        {
-            _storage._val.~T();
-            _storage._engaged = false;
-        }
-
-        new(&_storage._val) T(std::forward<Args>(args)...);
-        _storage._engaged = true;
-
-        return _storage._val;
+        this->reset();
+        this->construct(std::forward<Args>(args)...);
+        return this->_val;
     }
 
-    template<class U, class... Args, std::enable_if_t<std::is_constructible<T, std::initializer_list<U>&, Args&&...>::value>>
+    template<class U, class... Args, std::enable_if_t<std::is_constructible<T, std::initializer_list<U>&, Args&&...>::value, int> = 0>
     T& emplace(std::initializer_list<U> il, Args&&... args)
     {
-        if(_storage._engaged)
-        {
-            _storage._val.~T();
-            _storage._engaged = false;
-        }
-
-        new(&_storage._val) T(il, std::forward<Args>(args)...);
-        _storage._engaged = true;
+        this->reset();
+        this->construct(il, std::forward<Args>(args)...);
+        return this->_val;
+    }
 
-        return _storage._val;
+    /**
+     * @brief Разрушаем значение, если оно есть
+     */
+    void reset() noexcept
+    {
+        base::reset();
     }
 
     T& value() &
     {
-        return _storage._engaged ? _storage._val : throw bad_optional_access();
+        return this->_engaged ? this->_val : throw bad_optional_access();
     }
 
     const T& value() const &
     {
-        return _storage._engaged ? _storage._val : throw bad_optional_access();
+        return this->_engaged ? this->_val : throw bad_optional_access();
     }
 
     T&& value() &&
     {
-        return _storage._engaged ? std::move(_storage._val) : throw bad_optional_access();
+        return this->_engaged ? std::move(this->_val) : throw bad_optional_access();
     }
 
     const T&& value() const &&
     {
-        return _storage._engaged ? std::move(_storage._val) : throw bad_optional_access();
+        return this->_engaged ? std::move(this->_val) : throw bad_optional_access();
     }
 
     template<class U>
     T value_or(U&& u) &&
     {
-        return _storage._engaged ? 
-                std::move(_storage._val) : static_cast<T>(std::forward<U>(u));
+        return this->_engaged ? std::move(this->_val) : static_cast<T>(std::forward<U>(u));
     }
 
     template<class U>
-    T value_or(U&& u) const &
+    constexpr T value_or(U&& u) const &
     {
-        return _storage._engaged ? 
-                std::move(_storage._val) : static_cast<T>(std::forward<U>(u));
+        return this->_engaged ? this->_val : static_cast<T>(std::forward<U>(u));
     }
 
     optional& operator=(nullopt_t) noexcept
     {
-        if(_storage._engaged)
-        {
-            _storage._val.~T();
-            _storage._engaged = false;
-        }
-        return *this;
-    }
-
-    template<typename U = T, std::enable_if_t<!std::is_trivially_copy_constructible<U>::value ||
-                                                        !std::is_trivially_copy_assignable<U>::value || 
-                                                        !std::is_trivially_destructible<U>::value>>
-    constexpr optional& operator=(const optional& other)
-    {
-        if(this == &other) return *this;
-
-        if(_storage._engaged && other._storage._engaged)
-        {
-            _storage._val = other._storage._val;
-        }else if(_storage._engaged && !other._storage._engaged)
-        {
-            _storage._val.~T();
-            _storage._engaged = false;
-        }else if(!_storage._engaged && other._storage._engaged)
-        {
-            new(&_storage._val) T(other._storage._val);
-            _storage._engaged = true;
-        }
-
-        return *this;
-    }
-
-    template<typename U = T, std::enable_if_t<!std::is_copy_constructible<U>::value || 
-                                                        !std::is_copy_assignable<U>::value>>
-    constexpr optional& operator=(const optional& other) = delete;
-
-    constexpr optional& operator=(const optional& other) = default;
-
-    template<typename U = T, std::enable_if_t<!std::is_trivially_move_constructible<U>::value ||
-                                                        !std::is_trivially_move_assignable<U>::value || 
-                                                        !std::is_trivially_destructible<U>::value>>
-    constexpr optional& operator=(optional&& other) noexcept(std::is_nothrow_move_assignable<T>::value &&
-                                                             std::is_nothrow_move_constructible<T>::value)
-    {
-        if(*this == &other) return *this;
-        
-        if(_storage._engaged && other._storage._engaged)
-        {
-            _storage._val = std::move(other._storage._val);
-            other._storage._engaged = false;
-        }else if(_storage._engaged && !other._storage._engaged)
-        {
-            _storage._val.~T();
-            _storage._engaged = false;
-        }else if(!_storage._engaged && other._storage._engaged)
-        {
-            new(&_storage._val) T(std::move(other._storage._val));
-            _storage._engaged = true;
-            other._storage._engaged = false;
-        }
+        this->reset();
         return *this;
     }
 
-    template<typename U = T, std::enable_if_t<!std::is_move_constructible<U>::value || 
-                                                        !std::is_move_assignable<U>::value>>
-    constexpr optional& operator=(optional&& other) = delete;
+    optional& operator=(const optional& other) = default;
 
-    constexpr optional& operator=(optional&& other) = default;
+    optional& operator=(optional&& other) = default;
 
-    template <typename U,
+    template <typename U = T,
         std::enable_if_t<
             !std::is_same<optional, typename std::decay_t<U>>::value && 
             std::is_constructible<T, U>::value &&                          
             std::is_assignable<T&, U>::value &&                          
             (!std::is_scalar<T>::value ||                               
-            !std::is_same<typename std::decay_t<U>, T>::value)      
-        >>
-    optional& operator=(U&& other)
-    {
-        if (_storage._engaged) {
-            _storage._val = std::forward<U>(value); 
-        } else {
-            new (&_storage._val) T(std::forward<U>(value)); 
-            _storage._engaged = true;
-        }
+            !std::is_same<typename std::decay_t<U>, T>::value), int> = 0>
+    optional& operator=(U&& value)
+    {
+        if(this->_engaged)
+            this->_val = std::forward<U>(value);
+        else
+            this->construct(std::forward<U>(value));
         return *this;
     }
 
-    template<class U, std::enable_if_t<!detail::ctor_convert_assign<T, U>::value || 
-                        std::is_constructible<T, const U&>::value && std::is_assignable<T&, const U&>::value>>
-    optional& operator=(const optional<U>& other)
+    /**
+     * @brief Скаляр присваиваем без проверки: перегрузка выше исключает его, чтобы opt = {} не выбирала её
+     */
+    template<typename U = T, std::enable_if_t<std::is_scalar<U>::value, int> = 0>
+    optional& operator=(const T& value) noexcept
     {
-        if (this == &other)
-            return *this;
-
-        if(_storage._engaged && other._storage._engaged)
-        {
-            _storage._val = other._storage._val;
-        }else if(_storage._engaged && !other._storage._engaged)
-        {
-            _storage._val.~T();
-            _storage._engaged = false;
-        }else if(!_storage._engaged && other._storage._engaged)
-        {
-            new(&_storage._val) T(other._storage._val);
-            _storage._engaged = true;
-        }
+        if(this->_engaged)
+            this->_val = value;
+        else
+            this->construct(value);
+        return *this;
+    }
 
+    template<class U, std::enable_if_t<!std::is_same<T, U>::value && !detail::ctor_convert_assign<T, U>::value &&
+                                       std::is_constructible<T, const U&>::value && std::is_assignable<T&, const U&>::value, int> = 0>
+    optional& operator=(const optional<U>& other)
+    {
+        if(!other)
+            this->reset();
+        else if(this->_engaged)
+            this->_val = *other;
+        else
+            this->construct(*other);
         return *this;
     }
  
-    template<class U, std::enable_if_t<!detail::ctor_convert_assign<T, U>::value ||
-                        std::is_constructible<T, U>::value && std::is_assignable<T&, U>::value>>
+    template<class U, std::enable_if_t<!std::is_same<T, U>::value && !detail::ctor_convert_assign<T, U>::value &&
+                                       std::is_constructible<T, U>::value && std::is_assignable<T&, U>::value, int> = 0>
     optional& operator=(optional<U>&& other)
     {
-        if(*this == &other) return *this;
-
-        if(_storage._engaged && other._storage._engaged)
-        {
-            _storage._val = std::move(other._storage._val);
-            other._storage._engaged = false;
-        }else if(_storage._engaged && !other._storage._engaged)
-        {
-            _storage._val.~T();
-            _storage._engaged = false;
-        }else if(!_storage._engaged && other._storage._engaged)
-        {
-            new(&_storage._val) T(std::move(other._storage._val));
-            _storage._engaged = true;
-            other._storage._engaged = false;
-        }
-
+        if(!other)
+            this->reset();
+        else if(this->_engaged)
+            this->_val = std::move(*other);
+        else
+            this->construct(std::move(*other));
         return *this;
     }
     
@@ -414,7 +519,7 @@ struct optional
      */
     constexpr T& operator*() & noexcept
     {
-        return _storage._val;
+        return this->_val;
     }
 
     /**
@@ -423,7 +528,7 @@ struct optional
      */
     constexpr const T& operator*() const& noexcept
     {
-        return _storage._val;
+        return this->_val;
     }
 
     /**
@@ -432,7 +537,7 @@ struct optional
      */
     constexpr T&& operator*() && noexcept
     {
-        return std::move(_storage._val);
+        return std::move(this->_val);
     }
 
     /**
@@ -441,7 +546,7 @@ struct optional
      */
     constexpr const T&& operator*() const&& noexcept
     {
-        return std::move(_storage._val);
+        return std::move(this->_val);
     }
 
     /**
@@ -450,7 +555,7 @@ struct optional
      */
     constexpr T* operator->() noexcept
     {
-        return &_storage._val;
+        return std::addressof(this->_val);
     }
 
     /**
@@ -459,27 +564,30 @@ struct optional
      */
     constexpr const T* operator->() const noexcept
     {
-        return _storage._val;
+        return std::addressof(this->_val);
     }
 
     /**
      * @brief Оператор приведения к bool
      */
-    explicit operator bool() const noexcept
+    constexpr explicit operator bool() const noexcept
     {
-        return _storage._engaged;
+        return this->_engaged;
     }
 
     /**
      * @brief Деструктор
-     * @details По стандарту деструктор обязан быть тривиальным
+     * @details Тривиален, если тривиален деструктор T
      */
     ~optional() = default;
-
-private:
-    optional_storage<T> _storage;
 };
 
+/**
+ * @brief optional перемещается тривиально, если тривиально перемещается T
+ */
+template<class T>
+struct is_trivially_relocatable<optional<T>> : is_trivially_relocatable<T> {};
+
 namespace detail
 {
     template <typename T, typename U>
@@ -520,8 +628,7 @@ namespace detail
 template< class T, class U >
 constexpr bool operator==( const optional<T>& lhs, const optional<U>& rhs )
 {
-    return (!lhs && !rhs) || 
-            (lhs && rhs && *lhs == *rhs);
+    return lhs.has_value() == rhs.has_value() && (!lhs || *lhs == *rhs);
 }
 
 template< class T, class U >
@@ -533,172 +640,171 @@ constexpr bool operator!=( const optional<T>& lhs, const optional<U>& rhs )
 template< class T, class U >
 constexpr bool operator<( const optional<T>& lhs, const optional<U>& rhs )
 {
-    return !lhs ? rhs : (rhs && *lhs < *rhs);
+    return rhs && (!lhs || *lhs < *rhs);
 }
 
 template< class T, class U >
 constexpr bool operator<=( const optional<T>& lhs, const optional<U>& rhs )
 {
-    return !lhs ? rhs : (rhs && *lhs <= *rhs);
+    return !lhs || (rhs && *lhs <= *rhs);
 }
 
 template< class T, class U >
 constexpr bool operator>( const optional<T>& lhs, const optional<U>& rhs )
 {
-    return !rhs ? lhs : (lhs && *rhs < *lhs);
+    return lhs && (!rhs || *lhs > *rhs);
 }
 
 template< class T, class U >
 constexpr bool operator>=( const optional<T>& lhs, const optional<U>& rhs )
 {
-    return !rhs ? lhs : (lhs && *rhs <= *lhs);
+    return !rhs || (lhs && *lhs >= *rhs);
 }
 
 
-
 //optional vs nullopt
 template< class T >
 constexpr bool operator==( const optional<T>& opt, nullopt_t ) noexcept
 {
-    return !opt._storage._engaged;
+    return !opt;
 }
 
 template< class T >
 constexpr bool operator==( nullopt_t, const optional<T>& opt ) noexcept
 {
-    return !opt._storage._engaged;
+    return !opt;
 }
 
 template< class T >
 constexpr bool operator!=( const optional<T>& opt, nullopt_t ) noexcept
 {
-    return opt._storage._engaged;
+    return opt.has_value();
 }
 
 template< class T >
 constexpr bool operator!=( nullopt_t, const optional<T>& opt ) noexcept
 {
-    return opt._storage._engaged;
+    return opt.has_value();
 }
 
 template< class T >
-constexpr bool operator<( const optional<T>& opt, nullopt_t ) noexcept
+constexpr bool operator<( const optional<T>&, nullopt_t ) noexcept
 {
-    return !opt._storage._engaged;
+    return false;
 }
 
 template< class T >
 constexpr bool operator<( nullopt_t, const optional<T>& opt ) noexcept
 {
-    return opt._storage._engaged;
+    return opt.has_value();
 }
 
 template< class T >
 constexpr bool operator<=( const optional<T>& opt, nullopt_t ) noexcept
 {
-    return !opt._storage._engaged;
+    return !opt;
 }
 
 template< class T >
-constexpr bool operator<=( nullopt_t, const optional<T>& opt ) noexcept
+constexpr bool operator<=( nullopt_t, const optional<T>& ) noexcept
 {
-    return opt._storage._engaged;
+    return true;
 }
 
 template< class T >
 constexpr bool operator>( const optional<T>& opt, nullopt_t ) noexcept
 {
-    return opt._storage._engaged;
+    return opt.has_value();
 }
 
 template< class T >
-constexpr bool operator>( nullopt_t, const optional<T>& opt ) noexcept
+constexpr bool operator>( nullopt_t, const optional<T>& ) noexcept
 {
-    return !opt._storage._engaged;
+    return false;
 }
 
 template< class T >
-constexpr bool operator>=( const optional<T>& opt, nullopt_t ) noexcept
+constexpr bool operator>=( const optional<T>&, nullopt_t ) noexcept
 {
-    return opt._storage._engaged;
+    return true;
 }
 
 template< class T >
 constexpr bool operator>=( nullopt_t, const optional<T>& opt ) noexcept
 {
-    return !opt._storage._engaged;
+    return !opt;
 }
 
 
-/////////////////////////////////////////////////////////////////////
+//optional vs значение
 template< class T, class U >
 constexpr bool operator==( const optional<T>& opt, const U& value )
 {
-    return opt._storage._engaged && opt._storage._val == value;
+    return opt && *opt == value;
 }
 
 template< class U, class T >
 constexpr bool operator==( const U& value, const optional<T>& opt )
 {
-    return opt._storage._engaged && opt._storage._val == value;
+    return opt && value == *opt;
 }
 
 template< class T, class U >
 constexpr bool operator!=( const optional<T>& opt, const U& value )
 {
-    return !opt._storage._engaged || opt._storage._val != value;
+    return !opt || *opt != value;
 }
 
 template< class U, class T >
 constexpr bool operator!=( const U& value, const optional<T>& opt )
 {
-    return !opt._storage._engaged || opt._storage._val != value;
+    return !opt || value != *opt;
 }
 
 template< class T, class U >
 constexpr bool operator<( const optional<T>& opt, const U& value )
 {
-    return !opt._storage._engaged || opt._storage._val < value;
+    return !opt || *opt < value;
 }
 
 template< class U, class T >
 constexpr bool operator<( const U& value, const optional<T>& opt )
 {
-    return opt._storage._engaged || value < opt._storage._val;
+    return opt && value < *opt;
 }
 
 template< class T, class U >
 constexpr bool operator<=( const optional<T>& opt, const U& value )
 {
-    return !opt._storage._engaged || opt._storage._val <= value;
+    return !opt || *opt <= value;
 }
 
 template< class U, class T >
 constexpr bool operator<=( const U& value, const optional<T>& opt )
 {
-    return opt._storage._engaged || value <= opt._storage._val;
+    return opt && value <= *opt;
 }
 
 template< class T, class U >
 constexpr bool operator>( const optional<T>& opt, const U& value )
 {
-    return opt._storage._engaged || opt._storage._val > value;
+    return opt && *opt > value;
 }
 
 template< class U, class T >
 constexpr bool operator>( const U& value, const optional<T>& opt )
 {
-    return !opt._storage._engaged || value > opt._storage._val;
+    return !opt || value > *opt;
 }
 
 template< class T, class U >
 constexpr bool operator>=( const optional<T>& opt, const U& value )
 {
-    return opt._storage._engaged || opt._storage._val >= value;
+    return opt && *opt >= value;
 }
 
 template< class U, class T >
 constexpr bool operator>=( const U& value, const optional<T>& opt )
 {
-    return !opt._storage._engaged || value >= opt._storage._val;
+    return !opt || value >= *opt;
 }
@@ -0,0 +1,485 @@
+#pragma once
+
+#include <bits/stdc++.h>
+#include "aligned_allocator.hpp"
+#include "bitmask.hpp"
+#include "bitwords.hpp"
+
+
+namespace detail
+{
+	/**
+	 * @brief Условие поиска по упакованным маскам, размноженное на все поля 64-битного слова
+	 * @details Поле подходит, если (поле ^ required) & checked == 0 и, когда any_used, поле & any != 0.
+	 * Проверка поля на ноль без ветвлений (SWAR): к младшим bits - 1 битам поля прибавляем столько же единиц -
+	 * перенос доходит до старшего бита поля, только если младшие биты не нулевые, и за поле не выходит.
+	 * Результат - слово, в котором у каждого подходящего поля выставлен его старший бит.
+	 */
+	struct packed_mask_predicate
+	{
+		std::uint64_t required;
+		std::uint64_t checked;
+		std::uint64_t any;
+		std::uint64_t low;
+		std::uint64_t high;
+		bool any_used;
+
+		inline std::uint64_t nonzero(std::uint64_t x) const noexcept
+		{
+			return (((x & low) + low) | x) & high;
+		}
+
+		inline std::uint64_t match(std::uint64_t word) const noexcept
+		{
+			std::uint64_t result = high & ~nonzero((word ^ required) & checked);
+			if(any_used) result &= nonzero(word & any);
+			return result;
+		}
+
+#if defined(__AVX2__)
+		inline __m256i nonzero(__m256i x, __m256i vlow, __m256i vhigh) const noexcept
+		{
+			return _mm256_and_si256(_mm256_or_si256(_mm256_add_epi64(_mm256_and_si256(x, vlow), vlow), x), vhigh);
+		}
+
+		inline __m256i match(__m256i word) const noexcept
+		{
+			const __m256i vlow = _mm256_set1_epi64x(static_cast<long long>(low));
+			const __m256i vhigh = _mm256_set1_epi64x(static_cast<long long>(high));
+			const __m256i x = _mm256_and_si256(_mm256_xor_si256(word, _mm256_set1_epi64x(static_cast<long long>(required))),
+											   _mm256_set1_epi64x(static_cast<long long>(checked)));
+			__m256i result = _mm256_andnot_si256(nonzero(x, vlow, vhigh), vhigh);
+			if(any_used)
+				result = _mm256_and_si256(result, nonzero(_mm256_and_si256(word, _mm256_set1_epi64x(static_cast<long long>(any))), vlow, vhigh));
+			return result;
+		}
+#endif
+
+#if defined(__AVX512F__) && defined(__AVX512VPOPCNTDQ__)
+		inline __m512i nonzero(__m512i x, __m512i vlow, __m512i vhigh) const noexcept
+		{
+			return _mm512_and_si512(_mm512_or_si512(_mm512_add_epi64(_mm512_and_si512(x, vlow), vlow), x), vhigh);
+		}
+
+		inline __m512i match(__m512i word) const noexcept
+		{
+			const __m512i vlow = _mm512_set1_epi64(static_cast<long long>(low));
+			const __m512i vhigh = _mm512_set1_epi64(static_cast<long long>(high));
+			const __m512i x = _mm512_and_si512(_mm512_xor_si512(word, _mm512_set1_epi64(static_cast<long long>(required))),
+											   _mm512_set1_epi64(static_cast<long long>(checked)));
+			//nonzero уже лежит внутри vhigh, поэтому xor - это andnot без _mm512_undefined_epi32 и ложного -Wuninitialized в GCC 12
+			__m512i result = _mm512_xor_si512(nonzero(x, vlow, vhigh), vhigh);
+			if(any_used)
+				result = _mm512_and_si512(result, nonzero(_mm512_and_si512(word, _mm512_set1_epi64(static_cast<long long>(any))), vlow, vhigh));
+			return result;
+		}
+#endif
+	};
+
+	/**
+	 * @brief Количество подходящих полей в полных словах [0, n)
+	 */
+	inline std::size_t packed_count(const std::uint64_t* words, std::size_t n, const packed_mask_predicate& p) noexcept
+	{
+		std::size_t result = 0;
+		std::size_t i = 0;
+#if defined(__AVX512F__) && defined(__AVX512VPOPCNTDQ__)
+		__m512i acc = _mm512_setzero_si512();
+		for(; i < n / 8 * 8; i += 8)
+			acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(p.match(_mm512_loadu_si512(words + i))));
+		//без _mm512_reduce_add_epi64: в GCC 12 он даёт ложные -Wuninitialized, см. popcount_avx512_sum
+		const __m256i half = _mm256_add_epi64(_mm512_maskz_extracti64x4_epi64(0xFF, acc, 0), _mm512_maskz_extracti64x4_epi64(0xFF, acc, 1));
+		result += static_cast<std::size_t>(_mm256_extract_epi64(half, 0)) + static_cast<std::size_t>(_mm256_extract_epi64(half, 1)) +
+				  static_cast<std::size_t>(_mm256_extract_epi64(half, 2)) + static_cast<std::size_t>(_mm256_extract_epi64(half, 3));
+#elif defined(__AVX2__)
+		__m256i acc = _mm256_setzero_si256();
+		for(; i < n / 4 * 4; i += 4)
+			acc = _mm256_add_epi64(acc, popcount256(p.match(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i)))));
+		result += static_cast<std::size_t>(_mm256_extract_epi64(acc, 0)) + static_cast<std::size_t>(_mm256_extract_epi64(acc, 1)) +
+				  static_cast<std::size_t>(_mm256_extract_epi64(acc, 2)) + static_cast<std::size_t>(_mm256_extract_epi64(acc, 3));
+#endif
+		for(; i < n; ++i)
+			result += word_popcount(p.match(words[i]));
+		return result;
+	}
+
+	/**
+	 * @brief Первое слово из [from, n) с подходящим полем или n
+	 */
+	inline std::size_t packed_find_word(const std::uint64_t* words, std::size_t from, std::size_t n, const packed_mask_predicate& p) noexcept
+	{
+		std::size_t i = from;
+#if defined(__AVX512F__) && defined(__AVX512VPOPCNTDQ__)
+		for(; i + 8 <= n; i += 8)
+		{
+			if(_mm512_test_epi64_mask(p.match(_mm512_loadu_si512(words + i)), _mm512_set1_epi64(-1))) break;
+		}
+#elif defined(__AVX2__)
+		for(; i + 4 <= n; i += 4)
+		{
+			const __m256i m = p.match(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i)));
+			if(!_mm256_testz_si256(m, m)) break;
+		}
+#endif
+		for(; i < n; ++i)
+		{
+			if(p.match(words[i])) return i;
+		}
+		return n;
+	}
+}
+
+/**
+ * @brief Массив узких масок, упакованных вплотную по bit_count бит на маску
+ * @details В каждом 64-битном слове лежит 64 / N масок, маска не пересекает границу слова: get/set - одно слово,
+ * сдвиг и маска, а условие поиска одинаково для всех слов. Для BitMask из 3 элементов это 21 маска на слово
+ * вместо байта на маску. Поиск (count_where, find_where, query) проверяет все поля слова несколькими
+ * побитовыми операциями и сложением без ветвлений и идёт по словам векторами AVX2/AVX-512,
+ * поэтому упирается в пропускную способность памяти, а не в предсказание переходов.
+ * Неиспользуемые поля последнего слова всегда нулевые.
+ * @tparam Enum Перечисление маски
+ * @tparam N Количество значений перечисления, как у BitMask, от 1 до 64
+ */
+template<typename Enum, typename std::underlying_type<Enum>::type N = static_cast<typename std::underlying_type<Enum>::type>(enum_size<Enum>)>
+struct PackedBitMaskArray
+{
+	using mask_t = BitMask<Enum, N>;
+	using word_t = std::uint64_t;
+
+	static_assert(N >= 1 && N <= 64, "PackedBitMaskArray packs masks of 1..64 bits");
+
+	/**
+	 * @brief Бит на одну маску
+	 */
+	static constexpr std::size_t field_bits = N;
+
+	/**
+	 * @brief Масок в одном слове
+	 */
+	static constexpr std::size_t per_word = 64 / field_bits;
+
+	static constexpr word_t field_mask = field_bits == 64 ? ~word_t(0) : (word_t(1) << field_bits) - 1;
+
+	/**
+	 * @brief Запрос к массиву: маска подходит, если в ней выставлены все значения из has(),
+	 * хотя бы одно из has_any() (если оно задано) и ни одного из has_none()
+	 */
+	struct Query
+	{
+		explicit Query(const PackedBitMaskArray& array) noexcept : _array(&array) {}
+
+		/**
+		 * @brief Требуем, чтобы в маске были выставлены все перечисленные значения
+		 */
+		template<typename... Args, typename = typename std::enable_if<all_same<Enum, std::decay_t<Args>...>::value>::type>
+		inline Query& has(Args&&... values) noexcept
+		{
+			(_all.set(values), ...);
+			return *this;
+		}
+
+		inline Query& has(const mask_t& mask) noexcept
+		{
+			_all |= mask;
+			return *this;
+		}
+
+		/**
+		 * @brief Требуем, чтобы в маске было выставлено хотя бы одно из перечисленных значений
+		 */
+		template<typename... Args, typename = typename std::enable_if<all_same<Enum, std::decay_t<Args>...>::value>::type>
+		inline Query& has_any(Args&&... values) noexcept
+		{
+			(_any.set(values), ...);
+			return *this;
+		}
+
+		inline Query& has_any(const mask_t& mask) noexcept
+		{
+			_any |= mask;
+			return *this;
+		}
+
+		/**
+		 * @brief Требуем, чтобы в маске не было ни одного из перечисленных значений
+		 */
+		template<typename... Args, typename = typename std::enable_if<all_same<Enum, std::decay_t<Args>...>::value>::type>
+		inline Query& has_none(Args&&... values) noexcept
+		{
+			(_none.set(values), ...);
+			return *this;
+		}
+
+		inline Query& has_none(const mask_t& mask) noexcept
+		{
+			_none |= mask;
+			return *this;
+		}
+
+		/**
+		 * @brief Требуем точного совпадения маски
+		 */
+		inline Query& equals(const mask_t& mask) noexcept
+		{
+			_all |= mask;
+			_none |= ~mask;
+			return *this;
+		}
+
+		/**
+		 * @brief Считаем количество подходящих масок
+		 */
+		std::size_t count() const noexcept
+		{
+			const auto p = predicate();
+			const std::size_t full = _array->size() / per_word;
+			std::size_t result = detail::packed_count(_array->data(), full, p);
+			if(full != _array->word_count())
+				result += detail::word_popcount(p.match(_array->data()[full]) & tail_high());
+			return result;
+		}
+
+		/**
+		 * @brief Номер первой подходящей маски, начиная с from
+		 * @return Номер маски или size(), если подходящих нет
+		 */
+		std::size_t find(std::size_t from = 0) const noexcept
+		{
+			const std::size_t size = _array->size();
+			if(from >= size) return size;
+
+			const auto p = predicate();
+			const word_t* words = _array->data();
+			const std::size_t full = size / per_word;
+
+			//в первом слове пропускаем поля до from
+			std::size_t word = from / per_word;
+			word_t match = p.match(words[word]) & ~low_fields(from % per_word);
+			if(word == full) match &= tail_high();
+
+			while(!match)
+			{
+				if(++word >= _array->word_count()) return size;
+				word = detail::packed_find_word(words, word, full, p);
+				if(word >= _array->word_count()) return size;
+				match = p.match(words[word]);
+				if(word == full) match &= tail_high();
+			}
+			return word * per_word + detail::word_ctz(match) / field_bits;
+		}
+
+		/**
+		 * @brief Вызываем функцию для номера каждой подходящей маски по возрастанию
+		 * @param f Функция вида void(std::size_t index)
+		 */
+		template<typename F>
+		void for_each(F&& f) const
+		{
+			for(std::size_t i = find(); i < _array->size(); i = find(i + 1))
+				f(i);
+		}
+
+		/**
+		 * @brief Номера подходящих масок по возрастанию
+		 */
+		std::vector<std::size_t> rows() const
+		{
+			std::vector<std::size_t> result;
+			for_each([&result](std::size_t index) { result.push_back(index); });
+			return result;
+		}
+
+	private:
+
+		const PackedBitMaskArray* _array;
+		mask_t _all;
+		mask_t _any;
+		mask_t _none;
+
+		detail::packed_mask_predicate predicate() const noexcept
+		{
+			return {replicate(_all.value()), replicate(_all.value() | _none.value()), replicate(_any.value()),
+					replicate(field_mask >> 1), replicate(word_t(1) << (field_bits - 1)), _any.any()};
+		}
+
+		/**
+		 * @brief Старшие биты полей последнего, неполного слова, в которых есть маски
+		 */
+		word_t tail_high() const noexcept
+		{
+			return replicate(word_t(1) << (field_bits - 1)) & low_fields(_array->size() % per_word);
+		}
+	};
+
+	/**
+	 * @brief Конструктор по умолчанию. Создает пустой массив.
+	 */
+	PackedBitMaskArray() = default;
+
+	/**
+	 * @brief Создаём массив из size пустых масок
+	 */
+	explicit PackedBitMaskArray(std::size_t size)
+		: _words(words_for(size)), _size(size) {}
+
+	/**
+	 * @brief Создаём массив из диапазона масок
+	 */
+	template<typename It>
+	PackedBitMaskArray(It first, It last)
+	{
+		for(; first != last; ++first)
+			push_back(*first);
+	}
+
+	/**
+	 * @brief Маска по номеру
+	 */
+	inline mask_t get(std::size_t index) const noexcept
+	{
+		return mask_t(static_cast<typename mask_t::type_t>((_words[index / per_word] >> shift(index)) & field_mask));
+	}
+
+	inline mask_t operator[](std::size_t index) const noexcept
+	{
+		return get(index);
+	}
+
+	/**
+	 * @brief Записываем маску по номеру
+	 */
+	inline void set(std::size_t index, const mask_t& mask) noexcept
+	{
+		word_t& word = _words[index / per_word];
+		word = (word & ~(field_mask << shift(index))) | (static_cast<word_t>(mask.value()) << shift(index));
+	}
+
+	/**
+	 * @brief Добавляем маску в конец массива
+	 */
+	void push_back(const mask_t& mask)
+	{
+		if(_size % per_word == 0) _words.push_back(0);
+		set(_size++, mask);
+	}
+
+	/**
+	 * @brief Меняем размер массива; новые маски пустые
+	 */
+	void resize(std::size_t size)
+	{
+		if(size < _size)
+		{
+			_words.resize(words_for(size));
+			//обнуляем освободившиеся поля последнего слова, чтобы они не попадали в поиск
+			if(size % per_word) _words.back() &= low_fields(size % per_word);
+		}
+		else
+		{
+			_words.resize(words_for(size), 0);
+		}
+		_size = size;
+	}
+
+	/**
+	 * @brief Удаляем все маски
+	 */
+	void clear() noexcept
+	{
+		_words.clear();
+		_size = 0;
+	}
+
+	/**
+	 * @brief Начинаем запрос к массиву
+	 */
+	inline Query query() const noexcept
+	{
+		return Query(*this);
+	}
+
+	/**
+	 * @brief Считаем маски, в которых выставлены все значения required и не выставлено ни одного из excluded
+	 */
+	inline std::size_t count_where(const mask_t& required, const mask_t& excluded = mask_t()) const noexcept
+	{
+		return query().has(required).has_none(excluded).count();
+	}
+
+	/**
+	 * @brief Номер первой маски, начиная с from, в которой выставлены все значения required и ни одного из excluded
+	 * @return Номер маски или size(), если подходящих нет
+	 */
+	inline std::size_t find_where(const mask_t& required, const mask_t& excluded = mask_t(), std::size_t from = 0) const noexcept
+	{
+		return query().has(required).has_none(excluded).find(from);
+	}
+
+	/**
+	 * @brief Количество масок
+	 */
+	inline std::size_t size() const noexcept
+	{
+		return _size;
+	}
+
+	inline bool empty() const noexcept
+	{
+		return _size == 0;
+	}
+
+	/**
+	 * @brief Количество слов, в которых лежат маски
+	 */
+	inline std::size_t word_count() const noexcept
+	{
+		return _words.size();
+	}
+
+	inline const word_t* data() const noexcept
+	{
+		return _words.data();
+	}
+
+	/**
+	 * @brief Объём памяти под маски в байтах
+	 */
+	inline std::size_t size_in_bytes() const noexcept
+	{
+		return _words.size() * sizeof(word_t);
+	}
+
+private:
+
+	std::vector<word_t, aligned_allocator<word_t>> _words;
+	std::size_t _size = 0;
+
+	static constexpr std::size_t words_for(std::size_t size) noexcept
+	{
+		return (size + per_word - 1) / per_word;
+	}
+
+	static constexpr std::size_t shift(std::size_t index) noexcept
+	{
+		return index % per_word * field_bits;
+	}
+
+	/**
+	 * @brief Значение, повторённое во всех полях слова
+	 */
+	static constexpr word_t replicate(word_t value) noexcept
+	{
+		word_t result = 0;
+		for(std::size_t i = 0; i < per_word; ++i)
+			result |= (value & field_mask) << (i * field_bits);
+		return result;
+	}
+
+	/**
+	 * @brief Биты первых fields полей слова
+	 */
+	static constexpr word_t low_fields(std::size_t fields) noexcept
+	{
+		return fields * field_bits >= 64 ? ~word_t(0) : (word_t(1) << (fields * field_bits)) - 1;
+	}
+};
@@ -0,0 +1,351 @@
+#pragma once
+
+#include <bits/stdc++.h>
+#include "bitwords.hpp"
+#include "popcount.hpp"
+
+
+/**
+ * @brief Небольшой пул потоков для массовых операций над наборами битов
+ * @details Планирование динамическое, без кражи задач: run(tasks, f) раздаёт номера задач через общий атомарный
+ * счётчик, освободившийся поток сразу забирает следующую задачу, поэтому медленный поток не задерживает остальных.
+ * Вызывающий поток тоже выполняет задачи. Одновременно выполняется одна run(), остальные ждут.
+ * run(), вызванная из задачи этого же пула, выполняет вложенные задачи в текущем потоке. Вложенные run() разных пулов,
+ * ждущие друг друга, не поддерживаются. Функция задачи не должна бросать исключения.
+ */
+struct ThreadPool
+{
+	/**
+	 * @brief Создаём пул
+	 * @param threads Общее количество потоков, выполняющих задачи, вместе с вызывающим
+	 */
+	explicit ThreadPool(std::size_t threads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1))
+		: _threads(std::max<std::size_t>(threads, 1))
+	{
+		_workers.reserve(_threads - 1);
+		for(std::size_t i = 1; i < _threads; ++i)
+			_workers.emplace_back([this] { work(); });
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stop = true;
+		}
+		_wake.notify_all();
+		for(auto& worker : _workers)
+			worker.join();
+	}
+
+	/**
+	 * @brief Общий пул на все ядра
+	 */
+	static ThreadPool& shared()
+	{
+		static ThreadPool pool;
+		return pool;
+	}
+
+	/**
+	 * @brief Количество потоков вместе с вызывающим
+	 */
+	inline std::size_t thread_count() const noexcept
+	{
+		return _threads;
+	}
+
+	/**
+	 * @brief Выполняем f(i) для каждого i из [0, tasks) и ждём завершения всех задач
+	 * @details Из задачи этого же пула задачи выполняются последовательно в текущем потоке: иначе run() ждала бы
+	 * собственного задания на _run_mutex
+	 */
+	template<typename F>
+	void run(std::size_t tasks, F&& f)
+	{
+		if(tasks == 0) return;
+		if(tasks == 1 || _threads == 1 || current() == this)
+		{
+			for(std::size_t i = 0; i < tasks; ++i)
+				f(i);
+			return;
+		}
+
+		std::lock_guard<std::mutex> job(_run_mutex);
+		{
+			//поток, опоздавший к прошлому заданию, мог ещё не выйти из execute(): ждём его, прежде чем менять задание
+			std::unique_lock<std::mutex> lock(_mutex);
+			_done.wait(lock, [this] { return _active == 0; });
+			_context = const_cast<void*>(static_cast<const void*>(std::addressof(f)));
+			_invoke = [](void* context, std::size_t i) { (*static_cast<std::remove_reference_t<F>*>(context))(i); };
+			_tasks = tasks;
+			_next.store(0, std::memory_order_relaxed);
+			_finished.store(0, std::memory_order_relaxed);
+			++_generation;
+		}
+		_wake.notify_all();
+
+		execute();
+
+		//ждём и задачи, и выход всех потоков из задания, чтобы следующее задание не смешалось с этим
+		std::unique_lock<std::mutex> lock(_mutex);
+		_done.wait(lock, [this] { return _finished.load(std::memory_order_acquire) == _tasks && _active == 0; });
+	}
+
+private:
+
+	std::size_t _threads;
+	std::vector<std::thread> _workers;
+
+	std::mutex _run_mutex;
+	std::mutex _mutex;
+	std::condition_variable _wake;
+	std::condition_variable _done;
+
+	void* _context = nullptr;
+	void (*_invoke)(void*, std::size_t) = nullptr;
+	std::size_t _tasks = 0;
+	std::size_t _generation = 0;
+	std::size_t _active = 0;
+	bool _stop = false;
+
+	std::atomic<std::size_t> _next{0};
+	std::atomic<std::size_t> _finished{0};
+
+	/**
+	 * @brief Пул, задачу которого сейчас выполняет этот поток
+	 */
+	static const ThreadPool*& current() noexcept
+	{
+		thread_local const ThreadPool* pool = nullptr;
+		return pool;
+	}
+
+	/**
+	 * @brief Забираем задачи текущего задания, пока они не кончатся
+	 */
+	void execute() noexcept
+	{
+		std::size_t finished = 0;
+		const ThreadPool* outer = std::exchange(current(), this);
+		for(std::size_t i = _next.fetch_add(1, std::memory_order_relaxed); i < _tasks; i = _next.fetch_add(1, std::memory_order_relaxed))
+		{
+			_invoke(_context, i);
+			++finished;
+		}
+		current() = outer;
+		if(finished && _finished.fetch_add(finished, std::memory_order_acq_rel) + finished == _tasks)
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_done.notify_all();
+		}
+	}
+
+	void work() noexcept
+	{
+		std::size_t seen = 0;
+		std::unique_lock<std::mutex> lock(_mutex);
+		for(;;)
+		{
+			_wake.wait(lock, [this, seen] { return _stop || _generation != seen; });
+			if(_stop) return;
+
+			seen = _generation;
+			++_active;
+			lock.unlock();
+
+			execute();
+
+			lock.lock();
+			if(--_active == 0) _done.notify_all();
+		}
+	}
+};
+
+/**
+ * @brief Параллельные массовые операции над большими наборами битов (DynamicBitSet, BitSet, MappedBitSet)
+ * @details Слова набора режутся на куски по grain слов, куски выполняются задачами ThreadPool.
+ * Каждый кусок пишет свой частичный результат в отдельную ячейку, результаты складываются после run():
+ * для count - сумма, для find_nth - префиксные суммы по кускам, после чего нужный кусок просматривается последовательно.
+ * Если набор меньше одного куска, операция выполняется в вызывающем потоке без пула.
+ */
+struct ParallelBits
+{
+	/**
+	 * @brief Размер куска по умолчанию: 32768 слов, 256 КБ для 64-битных слов
+	 */
+	static constexpr std::size_t default_grain = 1 << 15;
+
+	/**
+	 * @brief Создаём исполнителя
+	 * @param pool Пул потоков; его размер задаёт количество потоков
+	 * @param grain Размер куска в словах
+	 */
+	explicit ParallelBits(ThreadPool& pool = ThreadPool::shared(), std::size_t grain = default_grain) noexcept
+		: _pool(&pool), _grain(std::max<std::size_t>(grain, 1)) {}
+
+	inline std::size_t grain() const noexcept
+	{
+		return _grain;
+	}
+
+	inline void set_grain(std::size_t grain) noexcept
+	{
+		_grain = std::max<std::size_t>(grain, 1);
+	}
+
+	inline ThreadPool& pool() const noexcept
+	{
+		return *_pool;
+	}
+
+	/**
+	 * @brief Количество выставленных бит массива слов
+	 */
+	template<typename W>
+	std::size_t count(const W* words, std::size_t n) const
+	{
+		std::vector<std::size_t> partial(chunks(n));
+		for_chunks(n, [&](std::size_t chunk, std::size_t first, std::size_t last)
+		{
+			partial[chunk] = detail::bytes_popcount(words + first, (last - first) * sizeof(W));
+		});
+		return std::accumulate(partial.begin(), partial.end(), static_cast<std::size_t>(0));
+	}
+
+	/**
+	 * @brief Количество выставленных бит набора
+	 */
+	template<typename Set>
+	std::size_t count(const Set& set) const
+	{
+		return count(set.data(), words_of(set));
+	}
+
+	/**
+	 * @brief dest = a & b по словам
+	 */
+	template<typename W>
+	void and_into(W* dest, const W* a, const W* b, std::size_t n) const
+	{
+		for_chunks(n, [=](std::size_t, std::size_t first, std::size_t last)
+		{
+			for(std::size_t i = first; i < last; ++i)
+				dest[i] = a[i] & b[i];
+		});
+	}
+
+	/**
+	 * @brief dest = a | b по словам
+	 */
+	template<typename W>
+	void or_into(W* dest, const W* a, const W* b, std::size_t n) const
+	{
+		for_chunks(n, [=](std::size_t, std::size_t first, std::size_t last)
+		{
+			for(std::size_t i = first; i < last; ++i)
+				dest[i] = a[i] | b[i];
+		});
+	}
+
+	/**
+	 * @brief dest = a & b. dest может совпадать с a или b.
+	 * @throw std::invalid_argument Если размеры наборов различаются
+	 */
+	template<typename Set>
+	void and_into(Set& dest, const Set& a, const Set& b) const
+	{
+		check_size(dest, a, b);
+		and_into(dest.data(), a.data(), b.data(), words_of(dest));
+	}
+
+	/**
+	 * @brief dest = a | b. dest может совпадать с a или b.
+	 * @throw std::invalid_argument Если размеры наборов различаются
+	 */
+	template<typename Set>
+	void or_into(Set& dest, const Set& a, const Set& b) const
+	{
+		check_size(dest, a, b);
+		or_into(dest.data(), a.data(), b.data(), words_of(dest));
+	}
+
+	/**
+	 * @brief Номер выставленного бита, перед которым ровно k выставленных бит (k-я единица, с нуля)
+	 * @return Номер бита или n * (бит в слове), если единиц не больше k
+	 */
+	template<typename W>
+	std::size_t find_nth(const W* words, std::size_t n, std::size_t k) const
+	{
+		constexpr std::size_t bits = sizeof(W) * 8;
+
+		std::vector<std::size_t> partial(chunks(n));
+		for_chunks(n, [&](std::size_t chunk, std::size_t first, std::size_t last)
+		{
+			partial[chunk] = detail::bytes_popcount(words + first, (last - first) * sizeof(W));
+		});
+
+		std::size_t chunk = 0;
+		for(; chunk < partial.size() && k >= partial[chunk]; ++chunk)
+			k -= partial[chunk];
+		if(chunk == partial.size()) return n * bits;
+
+		for(std::size_t i = chunk * _grain;; ++i)
+		{
+			const std::size_t in_word = detail::word_popcount(words[i]);
+			if(k < in_word) return i * bits + detail::word_select(static_cast<std::uint64_t>(words[i]), k);
+			k -= in_word;
+		}
+	}
+
+	/**
+	 * @brief k-я единица набора (с нуля)
+	 * @return Номер бита или size(), если единиц не больше k
+	 */
+	template<typename Set>
+	std::size_t find_nth(const Set& set, std::size_t k) const
+	{
+		return std::min(find_nth(set.data(), words_of(set), k), set.size());
+	}
+
+private:
+
+	ThreadPool* _pool;
+	std::size_t _grain;
+
+	inline std::size_t chunks(std::size_t n) const noexcept
+	{
+		return (n + _grain - 1) / _grain;
+	}
+
+	/**
+	 * @brief Выполняем f(chunk, first, last) для каждого куска слов [first, last)
+	 */
+	template<typename F>
+	void for_chunks(std::size_t n, F&& f) const
+	{
+		const std::size_t grain = _grain;
+		_pool->run(chunks(n), [&f, grain, n](std::size_t chunk)
+		{
+			f(chunk, chunk * grain, std::min(chunk * grain + grain, n));
+		});
+	}
+
+	template<typename Set>
+	static std::size_t words_of(const Set& set) noexcept
+	{
+		constexpr std::size_t bits = sizeof(typename Set::type_t) * 8;
+		return (set.size() + bits - 1) / bits;
+	}
+
+	template<typename Set>
+	static void check_size(const Set& dest, const Set& a, const Set& b)
+	{
+		if(dest.size() != a.size() || a.size() != b.size())
+			throw std::invalid_argument("ParallelBits: sets have different sizes");
+	}
+};
@@ -0,0 +1,319 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define UTILS_POPCOUNT_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Подсчёт единичных бит в больших массивах с выбором набора инструкций во время выполнения.
+ * @details В отличие от bitwords.hpp, где набор инструкций фиксируется флагами компиляции, здесь
+ * ядра собираются с атрибутом target и выбираются один раз по CPUID: AVX-512 VPOPCNTQ, AVX2 (Harley-Seal),
+ * POPCNT или переносимый вариант. Так сборка без -march=native всё равно использует возможности процессора.
+ * Ядра работают с байтами, поэтому подходят для массивов слов любой ширины.
+ */
+namespace detail
+{
+	/**
+	 * @brief Набор инструкций, которым считаются единичные биты
+	 */
+	enum class popcount_isa
+	{
+		generic,
+		popcnt,
+		avx2,
+		avx512
+	};
+
+	/**
+	 * @brief Начиная с какого размера массива в байтах имеет смысл вызывать ядро через указатель
+	 */
+	constexpr std::size_t popcount_dispatch_min_bytes = 256;
+
+	using popcount_kernel = std::size_t (*)(const unsigned char* a, const unsigned char* b, std::size_t bytes);
+
+	/**
+	 * @brief Пара ядер: подсчёт единиц в массиве и в пересечении двух массивов
+	 */
+	struct popcount_kernels
+	{
+		popcount_isa isa;
+		popcount_kernel count;
+		popcount_kernel count_and;
+	};
+
+	/**
+	 * @brief Читаем 8 байт без требований к выравниванию
+	 */
+	inline std::uint64_t popcount_load64(const unsigned char* p) noexcept
+	{
+		std::uint64_t value;
+		std::memcpy(&value, p, sizeof(value));
+		return value;
+	}
+
+	/**
+	 * @brief Читаем 8 байт массива a (или пересечения a & b, если And)
+	 */
+	template<bool And>
+	inline std::uint64_t popcount_load64(const unsigned char* a, const unsigned char* b, std::size_t i) noexcept
+	{
+		if constexpr (And)
+			return popcount_load64(a + i) & popcount_load64(b + i);
+		else
+			return popcount_load64(a + i);
+	}
+
+	/**
+	 * @brief Досчитываем байты, не поместившиеся в 8-байтные слова
+	 */
+	template<bool And>
+	inline std::size_t popcount_tail(const unsigned char* a, const unsigned char* b, std::size_t i, std::size_t bytes) noexcept
+	{
+		std::size_t result = 0;
+		for(; i < bytes; ++i)
+			result += static_cast<std::size_t>(__builtin_popcount(And ? (a[i] & b[i]) : a[i]));
+		return result;
+	}
+
+	/**
+	 * @brief Переносимое ядро: по 8 байт за раз
+	 */
+	template<bool And>
+	std::size_t popcount_generic(const unsigned char* a, const unsigned char* b, std::size_t bytes) noexcept
+	{
+		std::size_t result = 0;
+		std::size_t i = 0;
+		for(; i < bytes / 8 * 8; i += 8)
+			result += static_cast<std::size_t>(__builtin_popcountll(popcount_load64<And>(a, b, i)));
+		return result + popcount_tail<And>(a, b, i, bytes);
+	}
+
+#if defined(UTILS_POPCOUNT_DISPATCH)
+	/**
+	 * @brief Ядро на инструкции POPCNT: четыре независимых счётчика, чтобы не упираться в задержку popcnt
+	 */
+	template<bool And>
+	__attribute__((target("popcnt"))) std::size_t popcount_popcnt(const unsigned char* a, const unsigned char* b, std::size_t bytes) noexcept
+	{
+		std::uint64_t c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+		std::size_t i = 0;
+		for(; i < bytes / 32 * 32; i += 32)
+		{
+			c0 += static_cast<std::uint64_t>(__builtin_popcountll(popcount_load64<And>(a, b, i)));
+			c1 += static_cast<std::uint64_t>(__builtin_popcountll(popcount_load64<And>(a, b, i + 8)));
+			c2 += static_cast<std::uint64_t>(__builtin_popcountll(popcount_load64<And>(a, b, i + 16)));
+			c3 += static_cast<std::uint64_t>(__builtin_popcountll(popcount_load64<And>(a, b, i + 24)));
+		}
+		for(; i < bytes / 8 * 8; i += 8)
+			c0 += static_cast<std::uint64_t>(__builtin_popcountll(popcount_load64<And>(a, b, i)));
+		return static_cast<std::size_t>(c0 + c1 + c2 + c3) + popcount_tail<And>(a, b, i, bytes);
+	}
+
+	/**
+	 * @brief Подсчёт единиц в 256-битном векторе по таблице полубайтов, результат - четыре 64-битные суммы
+	 */
+	__attribute__((target("avx2"))) inline __m256i popcount_avx2_vec(__m256i v) noexcept
+	{
+		const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+												0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+		const __m256i low_mask = _mm256_set1_epi8(0x0F);
+		const __m256i lo = _mm256_and_si256(v, low_mask);
+		const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+		const __m256i cnt = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+		return _mm256_sad_epu8(cnt, _mm256_setzero_si256());
+	}
+
+	template<bool And>
+	__attribute__((target("avx2"))) inline __m256i popcount_avx2_load(const unsigned char* a, const unsigned char* b, std::size_t i) noexcept
+	{
+		const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+		if constexpr (And)
+			return _mm256_and_si256(va, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+		else
+			return va;
+	}
+
+	/**
+	 * @brief Сумматор с сохранением переноса: h - разряд переноса, l - разряд суммы трёх векторов
+	 */
+	__attribute__((target("avx2"))) inline void popcount_avx2_csa(__m256i& h, __m256i& l, __m256i a, __m256i b, __m256i c) noexcept
+	{
+		const __m256i u = _mm256_xor_si256(a, b);
+		h = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(u, c));
+		l = _mm256_xor_si256(u, c);
+	}
+
+	/**
+	 * @brief Ядро AVX2 по схеме Harley-Seal: 16 векторов сводятся сумматорами в разряды 1/2/4/8/16,
+	 * и таблица полубайтов применяется только к разряду 16, т.е. один раз на 512 байт
+	 */
+	template<bool And>
+	__attribute__((target("avx2"))) std::size_t popcount_avx2(const unsigned char* a, const unsigned char* b, std::size_t bytes) noexcept
+	{
+		constexpr std::size_t step = sizeof(__m256i);
+		constexpr std::size_t block = 16 * step;
+
+		__m256i total = _mm256_setzero_si256();
+		__m256i ones = _mm256_setzero_si256();
+		__m256i twos = _mm256_setzero_si256();
+		__m256i fours = _mm256_setzero_si256();
+		__m256i eights = _mm256_setzero_si256();
+		__m256i sixteens, twos_a, twos_b, fours_a, fours_b, eights_a, eights_b;
+
+		std::size_t i = 0;
+		for(; i < bytes / block * block; i += block)
+		{
+			popcount_avx2_csa(twos_a, ones, ones, popcount_avx2_load<And>(a, b, i), popcount_avx2_load<And>(a, b, i + step));
+			popcount_avx2_csa(twos_b, ones, ones, popcount_avx2_load<And>(a, b, i + 2 * step), popcount_avx2_load<And>(a, b, i + 3 * step));
+			popcount_avx2_csa(fours_a, twos, twos, twos_a, twos_b);
+			popcount_avx2_csa(twos_a, ones, ones, popcount_avx2_load<And>(a, b, i + 4 * step), popcount_avx2_load<And>(a, b, i + 5 * step));
+			popcount_avx2_csa(twos_b, ones, ones, popcount_avx2_load<And>(a, b, i + 6 * step), popcount_avx2_load<And>(a, b, i + 7 * step));
+			popcount_avx2_csa(fours_b, twos, twos, twos_a, twos_b);
+			popcount_avx2_csa(eights_a, fours, fours, fours_a, fours_b);
+			popcount_avx2_csa(twos_a, ones, ones, popcount_avx2_load<And>(a, b, i + 8 * step), popcount_avx2_load<And>(a, b, i + 9 * step));
+			popcount_avx2_csa(twos_b, ones, ones, popcount_avx2_load<And>(a, b, i + 10 * step), popcount_avx2_load<And>(a, b, i + 11 * step));
+			popcount_avx2_csa(fours_a, twos, twos, twos_a, twos_b);
+			popcount_avx2_csa(twos_a, ones, ones, popcount_avx2_load<And>(a, b, i + 12 * step), popcount_avx2_load<And>(a, b, i + 13 * step));
+			popcount_avx2_csa(twos_b, ones, ones, popcount_avx2_load<And>(a, b, i + 14 * step), popcount_avx2_load<And>(a, b, i + 15 * step));
+			popcount_avx2_csa(fours_b, twos, twos, twos_a, twos_b);
+			popcount_avx2_csa(eights_b, fours, fours, fours_a, fours_b);
+			popcount_avx2_csa(sixteens, eights, eights, eights_a, eights_b);
+
+			total = _mm256_add_epi64(total, popcount_avx2_vec(sixteens));
+		}
+
+		total = _mm256_slli_epi64(total, 4);
+		total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount_avx2_vec(eights), 3));
+		total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount_avx2_vec(fours), 2));
+		total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount_avx2_vec(twos), 1));
+		total = _mm256_add_epi64(total, popcount_avx2_vec(ones));
+
+		for(; i < bytes / step * step; i += step)
+			total = _mm256_add_epi64(total, popcount_avx2_vec(popcount_avx2_load<And>(a, b, i)));
+
+		std::size_t result = static_cast<std::size_t>(_mm256_extract_epi64(total, 0)) + static_cast<std::size_t>(_mm256_extract_epi64(total, 1)) +
+							 static_cast<std::size_t>(_mm256_extract_epi64(total, 2)) + static_cast<std::size_t>(_mm256_extract_epi64(total, 3));
+		for(; i < bytes / 8 * 8; i += 8)
+			result += static_cast<std::size_t>(__builtin_popcountll(popcount_load64<And>(a, b, i)));
+		return result + popcount_tail<And>(a, b, i, bytes);
+	}
+
+	template<bool And>
+	__attribute__((target("avx512f,avx512vpopcntdq"))) inline __m512i popcount_avx512_vec(const unsigned char* a, const unsigned char* b, std::size_t i) noexcept
+	{
+		const __m512i va = _mm512_loadu_si512(a + i);
+		if constexpr (And)
+			return _mm512_popcnt_epi64(_mm512_and_si512(va, _mm512_loadu_si512(b + i)));
+		else
+			return _mm512_popcnt_epi64(va);
+	}
+
+	/**
+	 * @brief Сумма 64-битных полос через две 256-битные половины
+	 * @details Не _mm512_reduce_add_epi64 и не обычный extract: в GCC 12 они берут _mm256_undefined_si256 и дают
+	 * ложные -Wuninitialized. Извлечение с полной маской нулями ничего не заменяет и компилируется в тот же vextracti64x4.
+	 */
+	__attribute__((target("avx512f"))) inline std::size_t popcount_avx512_sum(__m512i v) noexcept
+	{
+		const __m256i half = _mm256_add_epi64(_mm512_maskz_extracti64x4_epi64(0xFF, v, 0), _mm512_maskz_extracti64x4_epi64(0xFF, v, 1));
+		const __m128i quarter = _mm_add_epi64(_mm256_castsi256_si128(half), _mm256_extracti128_si256(half, 1));
+		return static_cast<std::size_t>(_mm_cvtsi128_si64(quarter)) + static_cast<std::size_t>(_mm_extract_epi64(quarter, 1));
+	}
+
+	/**
+	 * @brief Ядро AVX-512 на VPOPCNTQ: две независимые суммы по 64-битным полосам
+	 */
+	template<bool And>
+	__attribute__((target("avx512f,avx512vpopcntdq"))) std::size_t popcount_avx512(const unsigned char* a, const unsigned char* b, std::size_t bytes) noexcept
+	{
+		constexpr std::size_t step = sizeof(__m512i);
+
+		__m512i acc0 = _mm512_setzero_si512();
+		__m512i acc1 = _mm512_setzero_si512();
+
+		std::size_t i = 0;
+		for(; i < bytes / (2 * step) * (2 * step); i += 2 * step)
+		{
+			acc0 = _mm512_add_epi64(acc0, popcount_avx512_vec<And>(a, b, i));
+			acc1 = _mm512_add_epi64(acc1, popcount_avx512_vec<And>(a, b, i + step));
+		}
+		for(; i < bytes / step * step; i += step)
+			acc0 = _mm512_add_epi64(acc0, popcount_avx512_vec<And>(a, b, i));
+
+		std::size_t result = popcount_avx512_sum(_mm512_add_epi64(acc0, acc1));
+		for(; i < bytes / 8 * 8; i += 8)
+			result += static_cast<std::size_t>(__builtin_popcountll(popcount_load64<And>(a, b, i)));
+		return result + popcount_tail<And>(a, b, i, bytes);
+	}
+#endif
+
+	/**
+	 * @brief Лучший набор инструкций, поддерживаемый процессором
+	 */
+	inline popcount_isa popcount_best_isa() noexcept
+	{
+#if defined(UTILS_POPCOUNT_DISPATCH)
+		__builtin_cpu_init();
+		if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vpopcntdq")) return popcount_isa::avx512;
+		if(__builtin_cpu_supports("avx2")) return popcount_isa::avx2;
+		if(__builtin_cpu_supports("popcnt")) return popcount_isa::popcnt;
+#endif
+		return popcount_isa::generic;
+	}
+
+	/**
+	 * @brief Ядра для заданного набора инструкций. Процессор должен его поддерживать.
+	 */
+	inline popcount_kernels popcount_select(popcount_isa isa) noexcept
+	{
+		switch(isa)
+		{
+#if defined(UTILS_POPCOUNT_DISPATCH)
+		case popcount_isa::avx512:
+			return {isa, &popcount_avx512<false>, &popcount_avx512<true>};
+		case popcount_isa::avx2:
+			return {isa, &popcount_avx2<false>, &popcount_avx2<true>};
+		case popcount_isa::popcnt:
+			return {isa, &popcount_popcnt<false>, &popcount_popcnt<true>};
+#endif
+		default:
+			return {popcount_isa::generic, &popcount_generic<false>, &popcount_generic<true>};
+		}
+	}
+
+	/**
+	 * @brief Ядра, выбранные для текущего процессора. CPUID опрашивается один раз за время работы программы.
+	 */
+	inline const popcount_kernels& popcount_dispatch() noexcept
+	{
+		static const popcount_kernels kernels = popcount_select(popcount_best_isa());
+		return kernels;
+	}
+
+	/**
+	 * @brief Считаем количество единичных бит в массиве
+	 * @param data Начало массива
+	 * @param bytes Размер массива в байтах
+	 */
+	inline std::size_t bytes_popcount(const void* data, std::size_t bytes) noexcept
+	{
+		const auto* p = static_cast<const unsigned char*>(data);
+		return popcount_dispatch().count(p, p, bytes);
+	}
+
+	/**
+	 * @brief Считаем количество единичных бит в пересечении двух массивов одинакового размера, не сохраняя его
+	 * @param a Начало первого массива
+	 * @param b Начало второго массива
+	 * @param bytes Размер каждого массива в байтах
+	 */
+	inline std::size_t bytes_popcount_and(const void* a, const void* b, std::size_t bytes) noexcept
+	{
+		return popcount_dispatch().count_and(static_cast<const unsigned char*>(a), static_cast<const unsigned char*>(b), bytes);
+	}
+}
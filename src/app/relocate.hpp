@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Тип тривиально перемещаем (trivially relocatable): перенос объекта на новое место и окончание жизни
+ * старого можно заменить копированием байт. Перемещающий конструктор и деструктор при этом не вызываются.
+ * @details Верно для тривиально копируемых типов и для типов, которые не хранят указателей на самих себя:
+ * unique_ptr, shared_ptr, vector. Неверно для std::string в libstdc++: короткая строка хранится внутри
+ * объекта, и объект указывает сам на себя.
+ * Свой тип объявляется перемещаемым либо специализацией is_trivially_relocatable, либо членом
+ * using trivially_relocatable = std::true_type;
+ */
+template<typename T, typename = void>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template<typename T>
+struct is_trivially_relocatable<T, std::void_t<typename T::trivially_relocatable>> : T::trivially_relocatable {};
+
+template<typename T>
+constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+template<typename T>
+struct is_trivially_relocatable<std::unique_ptr<T>> : std::true_type {};
+
+template<typename T>
+struct is_trivially_relocatable<std::shared_ptr<T>> : std::true_type {};
+
+template<typename T>
+struct is_trivially_relocatable<std::weak_ptr<T>> : std::true_type {};
+
+template<typename T>
+struct is_trivially_relocatable<std::vector<T>> : std::true_type {};
+
+template<typename A, typename B>
+struct is_trivially_relocatable<std::pair<A, B>> : std::bool_constant<is_trivially_relocatable_v<A> && is_trivially_relocatable_v<B>> {};
+
+/**
+ * @brief Переносим объекты [first, last) в неинициализированную память dest. Исходные объекты после переноса мертвы.
+ * @details Для тривиально перемещаемых типов - один memcpy, иначе перемещение и разрушение по одному.
+ * Диапазоны не должны пересекаться.
+ * @return Конец перенесённого диапазона в dest
+ */
+template<typename T>
+T* relocate(T* first, T* last, T* dest) noexcept(is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible<T>::value)
+{
+    if constexpr (is_trivially_relocatable_v<T>)
+    {
+        const std::size_t n = static_cast<std::size_t>(last - first);
+        if(n) std::memcpy(static_cast<void*>(dest), static_cast<const void*>(first), n * sizeof(T));
+        return dest + n;
+    }
+    else
+    {
+        for(; first != last; ++first, ++dest)
+        {
+            ::new(static_cast<void*>(dest)) T(std::move(*first));
+            first->~T();
+        }
+        return dest;
+    }
+}
+
+/**
+ * @brief Переносим один объект из src в неинициализированную память dest
+ */
+template<typename T>
+T* relocate_at(T* src, T* dest) noexcept(is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible<T>::value)
+{
+    return relocate(src, src + 1, dest) - 1;
+}
@@ -0,0 +1,996 @@
+#pragma once
+
+#include <bits/stdc++.h>
+#include "bitset.hpp"
+
+
+namespace detail
+{
+	/**
+	 * @brief Интервал значений [start, last] в run-контейнере
+	 */
+	struct roaring_run
+	{
+		uint16_t start;
+		uint16_t last;
+	};
+
+	/**
+	 * @brief Контейнер для 2^16 младших значений одного старшего ключа roaring-битмапа
+	 * @details Хранит значения в одном из трёх видов:
+	 * array - отсортированный массив uint16_t, пока значений не больше array_max;
+	 * bitmap - плотный BitSet на 65536 бит (8 КБ);
+	 * run - отсортированный массив интервалов, используется после run_optimize, если он компактнее двух других.
+	 */
+	struct roaring_container
+	{
+		using bitmap_t = BitSet<uint64_t, 65536>;
+
+		enum class kind : uint8_t
+		{
+			array,
+			bitmap,
+			run,
+		};
+
+		/**
+		 * @brief Максимальная мощность array-контейнера. При 4096 значениях массив занимает столько же, сколько bitmap.
+		 */
+		static constexpr uint32_t array_max = 4096;
+
+		static constexpr std::size_t bitmap_words = bitmap_t::word_count;
+
+		kind type{kind::array};
+		uint32_t cardinality{0};
+		std::vector<uint16_t> array;
+		std::unique_ptr<bitmap_t> bitmap;
+		std::vector<roaring_run> runs;
+
+		roaring_container() = default;
+
+		roaring_container(const roaring_container& other)
+			: type(other.type), cardinality(other.cardinality), array(other.array),
+			  bitmap(other.bitmap ? std::make_unique<bitmap_t>(*other.bitmap) : nullptr), runs(other.runs) {}
+
+		roaring_container(roaring_container&& other) noexcept = default;
+
+		roaring_container& operator=(const roaring_container& other)
+		{
+			if(this != &other) *this = roaring_container(other);
+			return *this;
+		}
+
+		roaring_container& operator=(roaring_container&& other) noexcept = default;
+
+		/**
+		 * @brief Контейнер из отсортированного массива значений, вид выбирается по мощности
+		 */
+		static roaring_container from_array(std::vector<uint16_t>&& values)
+		{
+			roaring_container result;
+			result.cardinality = static_cast<uint32_t>(values.size());
+			result.array = std::move(values);
+			if(result.cardinality > array_max) result.to_bitmap_kind();
+			return result;
+		}
+
+		/**
+		 * @brief Контейнер из плотного набора, вид выбирается по мощности
+		 */
+		static roaring_container from_bitmap(std::unique_ptr<bitmap_t>&& bits)
+		{
+			roaring_container result;
+			result.type = kind::bitmap;
+			result.cardinality = static_cast<uint32_t>(bits->count());
+			result.bitmap = std::move(bits);
+			if(result.cardinality <= array_max) result.to_array_kind();
+			return result;
+		}
+
+		/**
+		 * @brief Контейнер из отсортированных непересекающихся интервалов
+		 * @details Интервалы оставляем, только если они компактнее массива и bitmap
+		 */
+		static roaring_container from_runs(std::vector<roaring_run>&& intervals)
+		{
+			roaring_container result;
+			result.type = kind::run;
+			result.runs = std::move(intervals);
+			for(const auto& run : result.runs)
+				result.cardinality += static_cast<uint32_t>(run.last - run.start) + 1;
+			if(!result.runs_are_smaller(result.runs.size())) result.to_expanded_kind();
+			return result;
+		}
+
+		inline bool empty() const noexcept
+		{
+			return !cardinality;
+		}
+
+		/**
+		 * @brief Проверяем, есть ли значение в контейнере
+		 */
+		inline bool contains(uint16_t value) const noexcept
+		{
+			switch(type)
+			{
+			case kind::array:
+				return std::binary_search(array.begin(), array.end(), value);
+			case kind::bitmap:
+				return (*bitmap)[value];
+			case kind::run:
+			{
+				//ищем последний интервал, начинающийся не позже value
+				auto it = std::upper_bound(runs.begin(), runs.end(), value,
+										   [](uint16_t v, const roaring_run& run) { return v < run.start; });
+				return it != runs.begin() && value <= (it - 1)->last;
+			}
+			}
+			return false;
+		}
+
+		/**
+		 * @brief Добавляем значение
+		 * @return true, если значения в контейнере не было
+		 */
+		bool add(uint16_t value)
+		{
+			switch(type)
+			{
+			case kind::array:
+			{
+				auto it = std::lower_bound(array.begin(), array.end(), value);
+				if(it != array.end() && *it == value) return false;
+				array.insert(it, value);
+				if(++cardinality > array_max) to_bitmap_kind();
+				return true;
+			}
+			case kind::bitmap:
+			{
+				if((*bitmap)[value]) return false;
+				*bitmap += value;
+				++cardinality;
+				return true;
+			}
+			case kind::run:
+				return add_to_runs(value);
+			}
+			return false;
+		}
+
+		/**
+		 * @brief Удаляем значение
+		 * @return true, если значение было в контейнере
+		 */
+		bool remove(uint16_t value)
+		{
+			switch(type)
+			{
+			case kind::array:
+			{
+				auto it = std::lower_bound(array.begin(), array.end(), value);
+				if(it == array.end() || *it != value) return false;
+				array.erase(it);
+				--cardinality;
+				return true;
+			}
+			case kind::bitmap:
+			{
+				if(!(*bitmap)[value]) return false;
+				*bitmap -= value;
+				if(--cardinality <= array_max) to_array_kind();
+				return true;
+			}
+			case kind::run:
+				return remove_from_runs(value);
+			}
+			return false;
+		}
+
+		/**
+		 * @brief Количество значений контейнера в диапазоне [first, last]
+		 */
+		uint32_t count_range(uint16_t first, uint16_t last) const noexcept
+		{
+			switch(type)
+			{
+			case kind::array:
+				return static_cast<uint32_t>(std::upper_bound(array.begin(), array.end(), last) -
+											 std::lower_bound(array.begin(), array.end(), first));
+			case kind::bitmap:
+				return bitmap_count_range(bitmap->data(), first, last);
+			case kind::run:
+			{
+				uint32_t result = 0;
+				for(const auto& run : runs)
+				{
+					if(run.start > last) break;
+					if(run.last < first) continue;
+					result += static_cast<uint32_t>(std::min(run.last, last) - std::max(run.start, first)) + 1;
+				}
+				return result;
+			}
+			}
+			return 0;
+		}
+
+		/**
+		 * @brief Плотная копия контейнера любого вида
+		 */
+		std::unique_ptr<bitmap_t> make_bitmap() const
+		{
+			auto result = std::make_unique<bitmap_t>();
+			switch(type)
+			{
+			case kind::array:
+				for(const uint16_t value : array)
+					*result += value;
+				break;
+			case kind::bitmap:
+				*result = *bitmap;
+				break;
+			case kind::run:
+				for(const auto& run : runs)
+					bitmap_set_range(result->data(), run.start, run.last);
+				break;
+			}
+			return result;
+		}
+
+		/**
+		 * @brief Вызываем f для каждого значения контейнера по возрастанию
+		 */
+		template<typename F>
+		void for_each(F&& f) const
+		{
+			switch(type)
+			{
+			case kind::array:
+				for(const uint16_t value : array)
+					f(value);
+				break;
+			case kind::bitmap:
+				for(const std::size_t value : *bitmap)
+					f(static_cast<uint16_t>(value));
+				break;
+			case kind::run:
+				for(const auto& run : runs)
+					for(uint32_t value = run.start; value <= run.last; ++value)
+						f(static_cast<uint16_t>(value));
+				break;
+			}
+		}
+
+		/**
+		 * @brief Переводим контейнер в наиболее компактный вид, включая run
+		 */
+		void optimize()
+		{
+			const std::size_t run_count = count_runs();
+			if(type != kind::run && runs_are_smaller(run_count))
+			{
+				std::vector<roaring_run> intervals;
+				intervals.reserve(run_count);
+				for_each([&intervals](uint16_t value)
+				{
+					if(!intervals.empty() && intervals.back().last + 1u == value)
+						intervals.back().last = value;
+					else
+						intervals.push_back({value, value});
+				});
+				array = {};
+				bitmap.reset();
+				runs = std::move(intervals);
+				type = kind::run;
+			}
+			else if(type == kind::run && !runs_are_smaller(run_count))
+			{
+				to_expanded_kind();
+			}
+		}
+
+		/**
+		 * @brief Размер данных контейнера в байтах
+		 */
+		std::size_t size_in_bytes() const noexcept
+		{
+			switch(type)
+			{
+			case kind::array:
+				return array.size() * sizeof(uint16_t);
+			case kind::bitmap:
+				return sizeof(bitmap_t);
+			case kind::run:
+				return runs.size() * sizeof(roaring_run);
+			}
+			return 0;
+		}
+
+		/**
+		 * @brief Выставляем биты [first, last] в плотном наборе
+		 */
+		static void bitmap_set_range(uint64_t* words, uint32_t first, uint32_t last) noexcept
+		{
+			const uint32_t first_word = first / 64;
+			const uint32_t last_word = last / 64;
+			const uint64_t first_mask = ~0ull << (first % 64);
+			const uint64_t last_mask = ~0ull >> (63 - last % 64);
+			if(first_word == last_word)
+			{
+				words[first_word] |= first_mask & last_mask;
+				return;
+			}
+			words[first_word] |= first_mask;
+			for(uint32_t i = first_word + 1; i < last_word; ++i)
+				words[i] = ~0ull;
+			words[last_word] |= last_mask;
+		}
+
+		/**
+		 * @brief Сбрасываем биты [first, last] в плотном наборе
+		 */
+		static void bitmap_reset_range(uint64_t* words, uint32_t first, uint32_t last) noexcept
+		{
+			const uint32_t first_word = first / 64;
+			const uint32_t last_word = last / 64;
+			const uint64_t first_mask = ~0ull << (first % 64);
+			const uint64_t last_mask = ~0ull >> (63 - last % 64);
+			if(first_word == last_word)
+			{
+				words[first_word] &= ~(first_mask & last_mask);
+				return;
+			}
+			words[first_word] &= ~first_mask;
+			for(uint32_t i = first_word + 1; i < last_word; ++i)
+				words[i] = 0;
+			words[last_word] &= ~last_mask;
+		}
+
+		/**
+		 * @brief Считаем выставленные биты [first, last] в плотном наборе
+		 */
+		static uint32_t bitmap_count_range(const uint64_t* words, uint32_t first, uint32_t last) noexcept
+		{
+			const uint32_t first_word = first / 64;
+			const uint32_t last_word = last / 64;
+			const uint64_t first_mask = ~0ull << (first % 64);
+			const uint64_t last_mask = ~0ull >> (63 - last % 64);
+			if(first_word == last_word)
+				return static_cast<uint32_t>(word_popcount(words[first_word] & first_mask & last_mask));
+			std::size_t result = word_popcount(words[first_word] & first_mask);
+			result += words_count(words + first_word + 1, last_word - first_word - 1);
+			result += word_popcount(words[last_word] & last_mask);
+			return static_cast<uint32_t>(result);
+		}
+
+	private:
+
+		/**
+		 * @brief Количество интервалов, на которые разбиваются значения контейнера
+		 */
+		std::size_t count_runs() const noexcept
+		{
+			switch(type)
+			{
+			case kind::array:
+			{
+				std::size_t result = array.empty() ? 0 : 1;
+				for(std::size_t i = 1; i < array.size(); ++i)
+					result += array[i] != array[i - 1] + 1;
+				return result;
+			}
+			case kind::bitmap:
+			{
+				//интервал начинается там, где бит выставлен, а предыдущий нет
+				std::size_t result = 0;
+				uint64_t carry = 0;
+				const uint64_t* words = bitmap->data();
+				for(std::size_t i = 0; i < bitmap_words; ++i)
+				{
+					result += word_popcount(words[i] & ~((words[i] << 1) | carry));
+					carry = words[i] >> 63;
+				}
+				return result;
+			}
+			case kind::run:
+				return runs.size();
+			}
+			return 0;
+		}
+
+		/**
+		 * @brief Выгоднее ли хранить контейнер интервалами
+		 */
+		bool runs_are_smaller(std::size_t run_count) const noexcept
+		{
+			const std::size_t run_bytes = run_count * sizeof(roaring_run);
+			const std::size_t expanded_bytes = cardinality <= array_max ? cardinality * sizeof(uint16_t) : sizeof(bitmap_t);
+			return run_bytes < expanded_bytes;
+		}
+
+		void to_bitmap_kind()
+		{
+			auto bits = make_bitmap();
+			array = {};
+			runs = {};
+			bitmap = std::move(bits);
+			type = kind::bitmap;
+		}
+
+		void to_array_kind()
+		{
+			std::vector<uint16_t> values;
+			values.reserve(cardinality);
+			for_each([&values](uint16_t value) { values.push_back(value); });
+			bitmap.reset();
+			runs = {};
+			array = std::move(values);
+			type = kind::array;
+		}
+
+		/**
+		 * @brief Переводим run-контейнер в array или bitmap в зависимости от мощности
+		 */
+		void to_expanded_kind()
+		{
+			if(cardinality <= array_max)
+				to_array_kind();
+			else
+				to_bitmap_kind();
+		}
+
+		bool add_to_runs(uint16_t value)
+		{
+			auto next = std::upper_bound(runs.begin(), runs.end(), value,
+										 [](uint16_t v, const roaring_run& run) { return v < run.start; });
+			if(next != runs.begin())
+			{
+				auto prev = next - 1;
+				if(value <= prev->last) return false;
+				if(prev->last + 1u == value)
+				{
+					prev->last = value;
+					//склеиваем с соседним интервалом
+					if(next != runs.end() && next->start == value + 1u)
+					{
+						prev->last = next->last;
+						runs.erase(next);
+					}
+					++cardinality;
+					return true;
+				}
+			}
+			if(next != runs.end() && next->start == value + 1u)
+				next->start = value;
+			else
+				runs.insert(next, {value, value});
+			++cardinality;
+			return true;
+		}
+
+		bool remove_from_runs(uint16_t value)
+		{
+			auto it = std::upper_bound(runs.begin(), runs.end(), value,
+									   [](uint16_t v, const roaring_run& run) { return v < run.start; });
+			if(it == runs.begin() || value > (it - 1)->last) return false;
+			auto run = it - 1;
+			if(run->start == run->last)
+				runs.erase(run);
+			else if(run->start == value)
+				++run->start;
+			else if(run->last == value)
+				--run->last;
+			else
+			{
+				const roaring_run tail{static_cast<uint16_t>(value + 1), run->last};
+				run->last = static_cast<uint16_t>(value - 1);
+				runs.insert(run + 1, tail);
+			}
+			--cardinality;
+			return true;
+		}
+	};
+
+	/**
+	 * @brief Объединение двух контейнеров
+	 */
+	inline roaring_container container_or(const roaring_container& a, const roaring_container& b)
+	{
+		using kind = roaring_container::kind;
+
+		if(a.type == kind::array && b.type == kind::array)
+		{
+			std::vector<uint16_t> values;
+			values.reserve(a.array.size() + b.array.size());
+			std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), std::back_inserter(values));
+			return roaring_container::from_array(std::move(values));
+		}
+
+		if(a.type == kind::run && b.type == kind::run)
+		{
+			//сливаем отсортированные интервалы, склеивая пересекающиеся и соседние
+			std::vector<roaring_run> intervals;
+			intervals.reserve(a.runs.size() + b.runs.size());
+			std::size_t i = 0, j = 0;
+			while(i < a.runs.size() || j < b.runs.size())
+			{
+				const bool take_a = j == b.runs.size() || (i < a.runs.size() && a.runs[i].start <= b.runs[j].start);
+				const roaring_run run = take_a ? a.runs[i++] : b.runs[j++];
+				if(!intervals.empty() && run.start <= intervals.back().last + 1u)
+					intervals.back().last = std::max(intervals.back().last, run.last);
+				else
+					intervals.push_back(run);
+			}
+			return roaring_container::from_runs(std::move(intervals));
+		}
+
+		//в остальных случаях результат собираем в плотном наборе, начиная с bitmap-операнда
+		const roaring_container& dense = b.type == kind::bitmap ? b : a;
+		const roaring_container& other = &dense == &a ? b : a;
+		auto bits = dense.make_bitmap();
+		switch(other.type)
+		{
+		case kind::array:
+			for(const uint16_t value : other.array)
+				*bits += value;
+			break;
+		case kind::bitmap:
+			*bits |= *other.bitmap;
+			break;
+		case kind::run:
+			for(const auto& run : other.runs)
+				roaring_container::bitmap_set_range(bits->data(), run.start, run.last);
+			break;
+		}
+		return roaring_container::from_bitmap(std::move(bits));
+	}
+
+	/**
+	 * @brief Пересечение двух контейнеров
+	 */
+	inline roaring_container container_and(const roaring_container& a, const roaring_container& b)
+	{
+		using kind = roaring_container::kind;
+
+		if(a.type == kind::array && b.type == kind::array)
+		{
+			const auto& small = a.array.size() <= b.array.size() ? a.array : b.array;
+			const auto& large = &small == &a.array ? b.array : a.array;
+			std::vector<uint16_t> values;
+			values.reserve(small.size());
+			if(small.size() * 64 < large.size())
+			{
+				//сильно разные размеры: ищем элементы меньшего массива двоичным поиском, сужая диапазон
+				auto from = large.begin();
+				for(const uint16_t value : small)
+				{
+					from = std::lower_bound(from, large.end(), value);
+					if(from == large.end()) break;
+					if(*from == value) values.push_back(value);
+				}
+			}
+			else
+			{
+				std::set_intersection(small.begin(), small.end(), large.begin(), large.end(), std::back_inserter(values));
+			}
+			return roaring_container::from_array(std::move(values));
+		}
+
+		if(a.type == kind::array || b.type == kind::array)
+		{
+			const roaring_container& arr = a.type == kind::array ? a : b;
+			const roaring_container& other = &arr == &a ? b : a;
+			std::vector<uint16_t> values;
+			values.reserve(arr.array.size());
+			for(const uint16_t value : arr.array)
+				if(other.contains(value)) values.push_back(value);
+			return roaring_container::from_array(std::move(values));
+		}
+
+		if(a.type == kind::run && b.type == kind::run)
+		{
+			std::vector<roaring_run> intervals;
+			std::size_t i = 0, j = 0;
+			while(i < a.runs.size() && j < b.runs.size())
+			{
+				const uint16_t start = std::max(a.runs[i].start, b.runs[j].start);
+				const uint16_t last = std::min(a.runs[i].last, b.runs[j].last);
+				if(start <= last) intervals.push_back({start, last});
+				if(a.runs[i].last < b.runs[j].last) ++i; else ++j;
+			}
+			return roaring_container::from_runs(std::move(intervals));
+		}
+
+		//bitmap & bitmap или bitmap & run
+		const roaring_container& dense = a.type == kind::bitmap ? a : b;
+		const roaring_container& other = &dense == &a ? b : a;
+		auto bits = other.make_bitmap();
+		*bits &= *dense.bitmap;
+		return roaring_container::from_bitmap(std::move(bits));
+	}
+
+	/**
+	 * @brief Разность контейнеров a \ b
+	 */
+	inline roaring_container container_andnot(const roaring_container& a, const roaring_container& b)
+	{
+		using kind = roaring_container::kind;
+
+		if(a.type == kind::array)
+		{
+			std::vector<uint16_t> values;
+			values.reserve(a.array.size());
+			for(const uint16_t value : a.array)
+				if(!b.contains(value)) values.push_back(value);
+			return roaring_container::from_array(std::move(values));
+		}
+
+		auto bits = a.make_bitmap();
+		switch(b.type)
+		{
+		case kind::array:
+			for(const uint16_t value : b.array)
+				*bits -= value;
+			break;
+		case kind::bitmap:
+			bits->and_not(*b.bitmap);
+			break;
+		case kind::run:
+			for(const auto& run : b.runs)
+				roaring_container::bitmap_reset_range(bits->data(), run.start, run.last);
+			break;
+		}
+		return roaring_container::from_bitmap(std::move(bits));
+	}
+
+	/**
+	 * @brief Мощность пересечения контейнеров без построения результата
+	 */
+	inline uint32_t container_and_count(const roaring_container& a, const roaring_container& b) noexcept
+	{
+		using kind = roaring_container::kind;
+
+		if(a.type == kind::array && b.type == kind::array)
+		{
+			uint32_t result = 0;
+			auto i = a.array.begin();
+			auto j = b.array.begin();
+			while(i != a.array.end() && j != b.array.end())
+			{
+				if(*i < *j) ++i;
+				else if(*j < *i) ++j;
+				else { ++result; ++i; ++j; }
+			}
+			return result;
+		}
+
+		if(a.type == kind::array || b.type == kind::array)
+		{
+			const roaring_container& arr = a.type == kind::array ? a : b;
+			const roaring_container& other = &arr == &a ? b : a;
+			uint32_t result = 0;
+			for(const uint16_t value : arr.array)
+				result += other.contains(value);
+			return result;
+		}
+
+		if(a.type == kind::run || b.type == kind::run)
+		{
+			const roaring_container& run = a.type == kind::run ? a : b;
+			const roaring_container& other = &run == &a ? b : a;
+			uint32_t result = 0;
+			for(const auto& interval : run.runs)
+				result += other.count_range(interval.start, interval.last);
+			return result;
+		}
+
+		std::size_t result = 0;
+		const uint64_t* lhs = a.bitmap->data();
+		const uint64_t* rhs = b.bitmap->data();
+		for(std::size_t i = 0; i < roaring_container::bitmap_words; ++i)
+			result += word_popcount(lhs[i] & rhs[i]);
+		return static_cast<uint32_t>(result);
+	}
+
+	/**
+	 * @brief Сравниваем содержимое контейнеров независимо от их вида
+	 */
+	inline bool container_equal(const roaring_container& a, const roaring_container& b)
+	{
+		using kind = roaring_container::kind;
+
+		if(a.cardinality != b.cardinality) return false;
+		if(a.type == kind::array && b.type == kind::array) return a.array == b.array;
+		if(a.type == kind::bitmap && b.type == kind::bitmap) return *a.bitmap == *b.bitmap;
+		return *a.make_bitmap() == *b.make_bitmap();
+	}
+}
+
+/**
+ * @brief Сжатый битмап для множеств uint32_t (по схеме Roaring)
+ * @details Значения делятся по старшим 16 битам на блоки по 2^16, каждый блок хранится в своём контейнере:
+ * отсортированном массиве для разреженных блоков, плотном BitSet для плотных и интервалами для блоков из длинных серий
+ * (см. run_optimize). Память расходуется пропорционально данным, а операции над множествами выполняются поблочно,
+ * с отдельной реализацией для каждой пары видов контейнеров.
+ */
+struct RoaringBitmap
+{
+	RoaringBitmap() = default;
+
+	/**
+	 * @brief Конструктор со списком значений
+	 * @param values Значения, которые нужно добавить в битмап
+	 */
+	RoaringBitmap(std::initializer_list<uint32_t> values)
+	{
+		for(const uint32_t value : values)
+			add(value);
+	}
+
+	/**
+	 * @brief Добавляем значение
+	 * @return true, если значения в битмапе не было
+	 */
+	bool add(uint32_t value)
+	{
+		const uint16_t key = high(value);
+		auto it = std::lower_bound(_keys.begin(), _keys.end(), key);
+		const std::size_t index = static_cast<std::size_t>(it - _keys.begin());
+		if(it == _keys.end() || *it != key)
+		{
+			_keys.insert(it, key);
+			_containers.insert(_containers.begin() + index, detail::roaring_container());
+		}
+		return _containers[index].add(low(value));
+	}
+
+	/**
+	 * @brief Удаляем значение
+	 * @return true, если значение было в битмапе
+	 */
+	bool remove(uint32_t value)
+	{
+		const std::size_t index = find_key(high(value));
+		if(index == _keys.size()) return false;
+		const bool removed = _containers[index].remove(low(value));
+		if(_containers[index].empty())
+		{
+			_keys.erase(_keys.begin() + index);
+			_containers.erase(_containers.begin() + index);
+		}
+		return removed;
+	}
+
+	/**
+	 * @brief Проверяем, есть ли значение в битмапе
+	 */
+	inline bool contains(uint32_t value) const noexcept
+	{
+		const std::size_t index = find_key(high(value));
+		return index != _keys.size() && _containers[index].contains(low(value));
+	}
+
+	/**
+	 * @brief Количество значений в битмапе
+	 */
+	inline uint64_t count() const noexcept
+	{
+		uint64_t result = 0;
+		for(const auto& container : _containers)
+			result += container.cardinality;
+		return result;
+	}
+
+	inline bool empty() const noexcept
+	{
+		return _keys.empty();
+	}
+
+	inline bool any() const noexcept
+	{
+		return !_keys.empty();
+	}
+
+	/**
+	 * @brief Удаляем все значения
+	 */
+	inline void reset() noexcept
+	{
+		_keys.clear();
+		_containers.clear();
+	}
+
+	/**
+	 * @brief Переводим контейнеры из длинных серий в run-вид, если так компактнее
+	 */
+	void run_optimize()
+	{
+		for(auto& container : _containers)
+			container.optimize();
+	}
+
+	/**
+	 * @brief Объём памяти под данные контейнеров и ключи в байтах
+	 */
+	std::size_t size_in_bytes() const noexcept
+	{
+		std::size_t result = _keys.size() * (sizeof(uint16_t) + sizeof(detail::roaring_container));
+		for(const auto& container : _containers)
+			result += container.size_in_bytes();
+		return result;
+	}
+
+	/**
+	 * @brief Вызываем f для каждого значения битмапа по возрастанию
+	 */
+	template<typename F>
+	void for_each(F&& f) const
+	{
+		for(std::size_t i = 0; i < _keys.size(); ++i)
+		{
+			const uint32_t base = static_cast<uint32_t>(_keys[i]) << 16;
+			_containers[i].for_each([&f, base](uint16_t value) { f(base | value); });
+		}
+	}
+
+	/**
+	 * @brief Объединение
+	 */
+	RoaringBitmap& operator|=(const RoaringBitmap& other)
+	{
+		*this = *this | other;
+		return *this;
+	}
+
+	/**
+	 * @brief Пересечение
+	 */
+	RoaringBitmap& operator&=(const RoaringBitmap& other)
+	{
+		*this = *this & other;
+		return *this;
+	}
+
+	/**
+	 * @brief Разность: убираем из текущего битмапа все значения другого
+	 */
+	RoaringBitmap& and_not(const RoaringBitmap& other)
+	{
+		RoaringBitmap result;
+		std::size_t j = 0;
+		for(std::size_t i = 0; i < _keys.size(); ++i)
+		{
+			while(j < other._keys.size() && other._keys[j] < _keys[i]) ++j;
+			if(j < other._keys.size() && other._keys[j] == _keys[i])
+				result.append(_keys[i], detail::container_andnot(_containers[i], other._containers[j]));
+			else
+				result.append(_keys[i], std::move(_containers[i]));
+		}
+		*this = std::move(result);
+		return *this;
+	}
+
+	friend RoaringBitmap operator|(const RoaringBitmap& lhs, const RoaringBitmap& rhs)
+	{
+		RoaringBitmap result;
+		std::size_t i = 0, j = 0;
+		while(i < lhs._keys.size() || j < rhs._keys.size())
+		{
+			if(j == rhs._keys.size() || (i < lhs._keys.size() && lhs._keys[i] < rhs._keys[j]))
+			{
+				result.append(lhs._keys[i], lhs._containers[i]);
+				++i;
+			}
+			else if(i == lhs._keys.size() || rhs._keys[j] < lhs._keys[i])
+			{
+				result.append(rhs._keys[j], rhs._containers[j]);
+				++j;
+			}
+			else
+			{
+				result.append(lhs._keys[i], detail::container_or(lhs._containers[i], rhs._containers[j]));
+				++i;
+				++j;
+			}
+		}
+		return result;
+	}
+
+	friend RoaringBitmap operator&(const RoaringBitmap& lhs, const RoaringBitmap& rhs)
+	{
+		RoaringBitmap result;
+		std::size_t i = 0, j = 0;
+		while(i < lhs._keys.size() && j < rhs._keys.size())
+		{
+			if(lhs._keys[i] < rhs._keys[j]) ++i;
+			else if(rhs._keys[j] < lhs._keys[i]) ++j;
+			else
+			{
+				result.append(lhs._keys[i], detail::container_and(lhs._containers[i], rhs._containers[j]));
+				++i;
+				++j;
+			}
+		}
+		return result;
+	}
+
+	/**
+	 * @brief Мощность пересечения без построения результата
+	 */
+	friend uint64_t and_count(const RoaringBitmap& lhs, const RoaringBitmap& rhs) noexcept
+	{
+		uint64_t result = 0;
+		std::size_t i = 0, j = 0;
+		while(i < lhs._keys.size() && j < rhs._keys.size())
+		{
+			if(lhs._keys[i] < rhs._keys[j]) ++i;
+			else if(rhs._keys[j] < lhs._keys[i]) ++j;
+			else result += detail::container_and_count(lhs._containers[i++], rhs._containers[j++]);
+		}
+		return result;
+	}
+
+	/**
+	 * @brief Мощность объединения без построения результата
+	 */
+	friend uint64_t or_count(const RoaringBitmap& lhs, const RoaringBitmap& rhs) noexcept
+	{
+		return lhs.count() + rhs.count() - and_count(lhs, rhs);
+	}
+
+	/**
+	 * @brief Мощность разности lhs \ rhs без построения результата
+	 */
+	friend uint64_t and_not_count(const RoaringBitmap& lhs, const RoaringBitmap& rhs) noexcept
+	{
+		return lhs.count() - and_count(lhs, rhs);
+	}
+
+	friend bool operator==(const RoaringBitmap& lhs, const RoaringBitmap& rhs)
+	{
+		if(lhs._keys != rhs._keys) return false;
+		for(std::size_t i = 0; i < lhs._containers.size(); ++i)
+			if(!detail::container_equal(lhs._containers[i], rhs._containers[i])) return false;
+		return true;
+	}
+
+	friend bool operator!=(const RoaringBitmap& lhs, const RoaringBitmap& rhs)
+	{
+		return !(lhs == rhs);
+	}
+
+private:
+
+	std::vector<uint16_t> _keys;
+	std::vector<detail::roaring_container> _containers;
+
+	static constexpr uint16_t high(uint32_t value) noexcept
+	{
+		return static_cast<uint16_t>(value >> 16);
+	}
+
+	static constexpr uint16_t low(uint32_t value) noexcept
+	{
+		return static_cast<uint16_t>(value & 0xFFFF);
+	}
+
+	/**
+	 * @brief Ищем контейнер по старшему ключу
+	 * @return Номер контейнера или _keys.size(), если его нет
+	 */
+	inline std::size_t find_key(uint16_t key) const noexcept
+	{
+		auto it = std::lower_bound(_keys.begin(), _keys.end(), key);
+		return it != _keys.end() && *it == key ? static_cast<std::size_t>(it - _keys.begin()) : _keys.size();
+	}
+
+	/**
+	 * @brief Добавляем контейнер в конец, ключ должен быть больше всех имеющихся. Пустые контейнеры пропускаем.
+	 */
+	inline void append(uint16_t key, detail::roaring_container container)
+	{
+		if(container.empty()) return;
+		_keys.push_back(key);
+		_containers.push_back(std::move(container));
+	}
+};
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <bits/stdc++.h>
+#include "atomic_bitset.hpp"
+
+
+/**
+ * @brief Выдача номеров слотов (соединений, объектов) без блокировок по карте занятости в AtomicBitSet
+ * @details acquire() ищет слово со сброшенным битом и захватывает бит через fetch_or: если другой поток успел раньше,
+ * попытка повторяется на том же слове по значению, которое вернул fetch_or. release() сбрасывает бит через fetch_and.
+ * Каждый поток начинает поиск со своего слова (подсказка в thread_local), поэтому потоки почти не делят кэш-линии,
+ * а с Padded каждое слово карты лежит в отдельной кэш-линии.
+ * Со сводкой (Summary) для каждого слова карты хранится бит "слово заполнено", и поиск пропускает сразу по 64 полных слова.
+ * Сводка - только подсказка: если по ней свободного слова не нашлось, карта просматривается целиком, так что слот не теряется.
+ * @tparam N Количество слотов
+ * @tparam Padded Размещать каждое слово карты в отдельной кэш-линии
+ * @tparam Summary Вести сводку заполненных слов
+ */
+template<std::size_t N, bool Padded = true, bool Summary = true>
+struct SlotAllocator
+{
+	using type_t = std::uint64_t;
+	using bitset_t = AtomicBitSet<type_t, N, Padded>;
+
+	static constexpr std::size_t word_bits = bitset_t::word_bits;
+	static constexpr std::size_t word_count = bitset_t::word_count;
+	static constexpr std::size_t summary_words = (word_count + word_bits - 1) / word_bits;
+
+	SlotAllocator() = default;
+
+	SlotAllocator(const SlotAllocator&) = delete;
+
+	SlotAllocator& operator=(const SlotAllocator&) = delete;
+
+	/**
+	 * @brief Захватываем любой свободный слот
+	 * @return Номер слота или capacity(), если свободных слотов нет
+	 */
+	std::size_t acquire() noexcept
+	{
+		std::size_t& hint = thread_hint();
+
+		if constexpr (Summary)
+		{
+			//сначала по сводке пропускаем заполненные слова
+			for(std::size_t i = 0; i < summary_words; ++i)
+			{
+				const std::size_t s = (hint / word_bits + i) % summary_words;
+				const type_t not_full = ~_full[s].load(std::memory_order_relaxed) & summary_mask(s);
+
+				//в слове сводки с подсказкой начинаем с бита подсказки и потом переходим к младшим,
+				//иначе все потоки начинали бы с первого незаполненного слова
+				const type_t from_hint = i ? not_full : static_cast<type_t>(not_full & (~static_cast<type_t>(0) << (hint % word_bits)));
+				std::size_t id = acquire_in_summary(s, from_hint, hint);
+				if(id == N) id = acquire_in_summary(s, static_cast<type_t>(not_full & ~from_hint), hint);
+				if(id != N) return id;
+			}
+		}
+
+		for(std::size_t i = 0; i < word_count; ++i)
+		{
+			const std::size_t w = (hint + i) % word_count;
+			const std::size_t id = acquire_in_word(w);
+			if(id != N)
+			{
+				hint = w;
+				return id;
+			}
+		}
+		return N;
+	}
+
+	/**
+	 * @brief Захватываем конкретный слот
+	 * @return true, если слот был свободен и теперь принадлежит вызывающему
+	 */
+	bool try_acquire(std::size_t id) noexcept
+	{
+		const std::size_t w = id / word_bits;
+		const type_t mask = static_cast<type_t>(1) << (id % word_bits);
+		const type_t previous = _slots.word(w).fetch_or(mask, std::memory_order_acq_rel);
+		if(previous & mask) return false;
+
+		if((previous | mask) == valid_mask(w)) mark_full(w);
+		return true;
+	}
+
+	/**
+	 * @brief Освобождаем слот, захваченный acquire() или try_acquire()
+	 */
+	void release(std::size_t id) noexcept
+	{
+		const std::size_t w = id / word_bits;
+		const type_t mask = static_cast<type_t>(1) << (id % word_bits);
+		const type_t previous = _slots.word(w).fetch_and(static_cast<type_t>(~mask), std::memory_order_release);
+
+		if constexpr (Summary)
+		{
+			if(previous == valid_mask(w))
+				_full[w / word_bits].fetch_and(static_cast<type_t>(~(static_cast<type_t>(1) << (w % word_bits))), std::memory_order_relaxed);
+		}
+	}
+
+	/**
+	 * @brief Проверяем, занят ли слот
+	 */
+	inline bool in_use(std::size_t id) const noexcept
+	{
+		return _slots.test(id, std::memory_order_acquire);
+	}
+
+	/**
+	 * @brief Количество занятых слотов. При одновременных изменениях - приблизительное.
+	 */
+	inline std::size_t count() const noexcept
+	{
+		return _slots.count(std::memory_order_relaxed);
+	}
+
+	inline constexpr std::size_t capacity() const noexcept
+	{
+		return N;
+	}
+
+private:
+
+	bitset_t _slots;
+	std::atomic<type_t> _full[Summary ? summary_words : 1]{};
+
+	/**
+	 * @brief Слово карты, с которого поток начинает поиск. Изначально - по хешу номера потока, чтобы разнести потоки.
+	 */
+	static std::size_t& thread_hint() noexcept
+	{
+		thread_local std::size_t hint = std::hash<std::thread::id>()(std::this_thread::get_id()) % word_count;
+		return hint;
+	}
+
+	static constexpr type_t valid_mask(std::size_t w) noexcept
+	{
+		return w + 1 == word_count && N % word_bits ? (static_cast<type_t>(1) << (N % word_bits)) - 1 : ~static_cast<type_t>(0);
+	}
+
+	static constexpr type_t summary_mask(std::size_t s) noexcept
+	{
+		return s + 1 == summary_words && word_count % word_bits ? (static_cast<type_t>(1) << (word_count % word_bits)) - 1 : ~static_cast<type_t>(0);
+	}
+
+	/**
+	 * @brief Захватываем свободный бит слова w
+	 * @return Номер слота или N, если слово заполнено
+	 */
+	std::size_t acquire_in_word(std::size_t w) noexcept
+	{
+		auto& word = _slots.word(w);
+		const type_t valid = valid_mask(w);
+
+		type_t current = word.load(std::memory_order_relaxed);
+		while(const type_t free = ~current & valid)
+		{
+			const type_t mask = free & (~free + 1);
+			current = word.fetch_or(mask, std::memory_order_acq_rel);
+			if(current & mask) continue;
+
+			if((current | mask) == valid) mark_full(w);
+			return w * word_bits + detail::word_ctz(mask);
+		}
+		return N;
+	}
+
+	/**
+	 * @brief Захватываем слот в одном из слов, отмеченных в candidates битами слова сводки s
+	 * @return Номер слота или N; при успехе hint указывает на слово, где слот найден
+	 */
+	std::size_t acquire_in_summary(std::size_t s, type_t candidates, std::size_t& hint) noexcept
+	{
+		for(; candidates; candidates &= candidates - 1)
+		{
+			const std::size_t w = s * word_bits + detail::word_ctz(candidates);
+			const std::size_t id = acquire_in_word(w);
+			if(id != N)
+			{
+				hint = w;
+				return id;
+			}
+		}
+		return N;
+	}
+
+	/**
+	 * @brief Отмечаем слово заполненным в сводке. Если слово успели освободить, пока мы ставили бит, снимаем его обратно.
+	 */
+	void mark_full(std::size_t w) noexcept
+	{
+		if constexpr (Summary)
+		{
+			const type_t bit = static_cast<type_t>(1) << (w % word_bits);
+			_full[w / word_bits].fetch_or(bit);
+			if(_slots.word(w).load() != valid_mask(w))
+				_full[w / word_bits].fetch_and(static_cast<type_t>(~bit));
+		}
+	}
+};
@@ -0,0 +1,344 @@
+#pragma once
+
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include "relocate.hpp"
+
+/**
+ * @brief Вектор с буфером на N элементов внутри объекта
+ * @details Пока элементов не больше N, память не выделяется. При росте элементы переносятся через relocate:
+ * для тривиально перемещаемых T (в том числе optional<unique_ptr<...>>) это один memcpy всего буфера
+ * вместо перемещения и разрушения каждого элемента.
+ * @tparam T Тип элемента
+ * @tparam N Размер встроенного буфера в элементах
+ */
+template<typename T, std::size_t N = 8>
+struct small_vector
+{
+    using value_type = T;
+    using size_type = std::size_t;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    small_vector() noexcept = default;
+
+    explicit small_vector(size_type count)
+    {
+        resize(count);
+    }
+
+    small_vector(std::initializer_list<T> il)
+    {
+        reserve(il.size());
+        for(const T& value : il)
+            emplace_back(value);
+    }
+
+    small_vector(const small_vector& other)
+    {
+        reserve(other.size());
+        std::uninitialized_copy(other.begin(), other.end(), _data);
+        _size = other._size;
+    }
+
+    /**
+     * @brief Перемещение: кучу забираем целиком, элементы встроенного буфера переносим
+     */
+    small_vector(small_vector&& other) noexcept(is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible<T>::value)
+    {
+        take(other);
+    }
+
+    small_vector& operator=(const small_vector& other)
+    {
+        if(this != &other)
+        {
+            small_vector copy(other);
+            clear();
+            release();
+            take(copy);
+        }
+        return *this;
+    }
+
+    small_vector& operator=(small_vector&& other) noexcept(is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible<T>::value)
+    {
+        if(this != &other)
+        {
+            clear();
+            release();
+            take(other);
+        }
+        return *this;
+    }
+
+    ~small_vector()
+    {
+        clear();
+        release();
+    }
+
+    template<class... Args>
+    T& emplace_back(Args&&... args)
+    {
+        if(_size == _capacity)
+        {
+            //аргумент может ссылаться на элемент самого вектора: создаём новый элемент до переноса старых
+            const size_type capacity = grown(_size + 1);
+            T* data = allocate(capacity);
+            T* slot = nullptr;
+            try
+            {
+                slot = ::new(static_cast<void*>(data + _size)) T(std::forward<Args>(args)...);
+                move_to(data, capacity);
+            }
+            catch(...)
+            {
+                if(slot) slot->~T();
+                std::allocator<T>().deallocate(data, capacity);
+                throw;
+            }
+            ++_size;
+            return *slot;
+        }
+        T* slot = ::new(static_cast<void*>(_data + _size)) T(std::forward<Args>(args)...);
+        ++_size;
+        return *slot;
+    }
+
+    void push_back(const T& value)
+    {
+        emplace_back(value);
+    }
+
+    void push_back(T&& value)
+    {
+        emplace_back(std::move(value));
+    }
+
+    void pop_back() noexcept
+    {
+        _data[--_size].~T();
+    }
+
+    /**
+     * @brief Выделяем память под capacity элементов
+     */
+    void reserve(size_type capacity)
+    {
+        if(capacity <= _capacity) return;
+        T* data = allocate(capacity);
+        try
+        {
+            move_to(data, capacity);
+        }
+        catch(...)
+        {
+            std::allocator<T>().deallocate(data, capacity);
+            throw;
+        }
+    }
+
+    /**
+     * @brief Меняем размер; новые элементы создаются конструктором по умолчанию
+     */
+    void resize(size_type count)
+    {
+        if(count < _size)
+        {
+            std::destroy(_data + count, _data + _size);
+            _size = count;
+            return;
+        }
+        if(count > _capacity) reserve(grown(count));
+        std::uninitialized_value_construct(_data + _size, _data + count);
+        _size = count;
+    }
+
+    void clear() noexcept
+    {
+        std::destroy(_data, _data + _size);
+        _size = 0;
+    }
+
+    T& operator[](size_type index) noexcept
+    {
+        return _data[index];
+    }
+
+    const T& operator[](size_type index) const noexcept
+    {
+        return _data[index];
+    }
+
+    T& at(size_type index)
+    {
+        if(index >= _size) throw std::out_of_range("small_vector: index out of range");
+        return _data[index];
+    }
+
+    const T& at(size_type index) const
+    {
+        if(index >= _size) throw std::out_of_range("small_vector: index out of range");
+        return _data[index];
+    }
+
+    T& back() noexcept
+    {
+        return _data[_size - 1];
+    }
+
+    const T& back() const noexcept
+    {
+        return _data[_size - 1];
+    }
+
+    T* data() noexcept
+    {
+        return _data;
+    }
+
+    const T* data() const noexcept
+    {
+        return _data;
+    }
+
+    iterator begin() noexcept
+    {
+        return _data;
+    }
+
+    iterator end() noexcept
+    {
+        return _data + _size;
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return _data;
+    }
+
+    const_iterator end() const noexcept
+    {
+        return _data + _size;
+    }
+
+    size_type size() const noexcept
+    {
+        return _size;
+    }
+
+    size_type capacity() const noexcept
+    {
+        return _capacity;
+    }
+
+    bool empty() const noexcept
+    {
+        return _size == 0;
+    }
+
+    /**
+     * @brief Элементы лежат во встроенном буфере
+     */
+    bool is_inline() const noexcept
+    {
+        return _data == inline_data();
+    }
+
+private:
+    alignas(T) unsigned char _inline[N ? N * sizeof(T) : 1];
+    T* _data = inline_data();
+    size_type _size = 0;
+    size_type _capacity = N;
+
+    T* inline_data() noexcept
+    {
+        return std::launder(reinterpret_cast<T*>(_inline));
+    }
+
+    const T* inline_data() const noexcept
+    {
+        return std::launder(reinterpret_cast<const T*>(_inline));
+    }
+
+    size_type grown(size_type required) const noexcept
+    {
+        return std::max(required, _capacity * 2);
+    }
+
+    static T* allocate(size_type capacity)
+    {
+        return std::allocator<T>().allocate(capacity);
+    }
+
+    void release() noexcept
+    {
+        if(!is_inline()) std::allocator<T>().deallocate(_data, _capacity);
+        _data = inline_data();
+        _capacity = N;
+    }
+
+    /**
+     * @brief Переносим элементы в новый буфер и освобождаем старый
+     * @details Если перемещение T может бросить и T не перемещается тривиально, элементы копируются,
+     * чтобы при исключении вектор остался прежним; новый буфер тогда освобождает вызывающий.
+     */
+    void move_to(T* data, size_type capacity)
+    {
+        if constexpr (is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible<T>::value || !std::is_copy_constructible<T>::value)
+        {
+            transfer(_data, _data + _size, data);
+        }
+        else
+        {
+            std::uninitialized_copy(_data, _data + _size, data);
+            std::destroy(_data, _data + _size);
+        }
+        if(!is_inline()) std::allocator<T>().deallocate(_data, _capacity);
+        _data = data;
+        _capacity = capacity;
+    }
+
+    /**
+     * @brief Переносим [first, last) в неинициализированную память dest
+     * @details Если перемещение T может бросить, как в std::vector сначала перемещаем все элементы и только потом
+     * разрушаем исходные: при исключении созданные элементы разрушает uninitialized_move, а исходные остаются живыми
+     * (возможно, перемещёнными), и размер вектора по-прежнему верен.
+     */
+    static void transfer(T* first, T* last, T* dest)
+    {
+        if constexpr (is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible<T>::value)
+        {
+            relocate(first, last, dest);
+        }
+        else
+        {
+            std::uninitialized_move(first, last, dest);
+            std::destroy(first, last);
+        }
+    }
+
+    /**
+     * @brief Забираем содержимое other, other остаётся пустым
+     */
+    void take(small_vector& other)
+    {
+        if(other.is_inline())
+        {
+            transfer(other._data, other._data + other._size, _data);
+        }
+        else
+        {
+            _data = other._data;
+            _capacity = other._capacity;
+            other._data = other.inline_data();
+            other._capacity = N;
+        }
+        _size = other._size;
+        other._size = 0;
+    }
+};
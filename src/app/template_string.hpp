@@ -27,13 +27,13 @@ struct SuperBase
     virtual ~SuperBase() {}
 };
 
-template<uint8_t value, typename...>
+template<uint8_t Value, typename...>
 struct Base;
 
-template<uint8_t value, char... elements, typename Payload>
-struct Base<value, str_t<elements...>, Payload> : public SuperBase
+template<uint8_t Value, char... elements, typename Payload>
+struct Base<Value, str_t<elements...>, Payload> : public SuperBase
 {
-    Base() : SuperBase(value) {}
+    Base() : SuperBase(Value) {}
     virtual ~Base() {}
 
     virtual void pureVirtualFunc() override {}
@@ -47,10 +47,10 @@ struct Base<value, str_t<elements...>, Payload> : public SuperBase
     Payload payload;
 };
 
-template<uint8_t value, char... elements>
-struct Base<value, str_t<elements...>> : public SuperBase
+template<uint8_t Value, char... elements>
+struct Base<Value, str_t<elements...>> : public SuperBase
 {
-    Base() : SuperBase(value) {}
+    Base() : SuperBase(Value) {}
     virtual ~Base() {}
 
     virtual void pureVirtualFunc() override {}
@@ -62,13 +62,13 @@ struct Base<value, str_t<elements...>> : public SuperBase
     }
 };
 
-template<uint8_t value, typename...>
+template<uint8_t Value, typename...>
 struct Derived;
 
-template<uint8_t value, char... elements, typename Payload>
-struct Derived<value, str_t<elements...>, Payload> : public Base<value, str_t<elements...>, Payload>
+template<uint8_t Value, char... elements, typename Payload>
+struct Derived<Value, str_t<elements...>, Payload> : public Base<Value, str_t<elements...>, Payload>
 {
-    Derived() : Base<value, str_t<elements...>, Payload>() {}
+    Derived() : Base<Value, str_t<elements...>, Payload>() {}
     virtual ~Derived() {}
 
     virtual void pureVirtualFunc() override final {}
@@ -76,10 +76,10 @@ struct Derived<value, str_t<elements...>, Payload> : public Base<value, str_t<el
     Payload payload;
 };
 
-template<uint8_t value, char... elements>
-struct Derived<value, str_t<elements...>> : public Base<value, str_t<elements...>>
+template<uint8_t Value, char... elements>
+struct Derived<Value, str_t<elements...>> : public Base<Value, str_t<elements...>>
 {
-    Derived() : Base<value, str_t<elements...>>() {}
+    Derived() : Base<Value, str_t<elements...>>() {}
     virtual ~Derived() {}
 
     virtual void pureVirtualFunc() override final {}
@@ -37,8 +37,8 @@ void func()
 
 int main()
 {    
-    BitMask<PowerMode, PowerMode::MaxValue> pwrMode;
-    BitMask<Color, static_cast<unsigned char>(Color::MaxValue)> color;
+    BitMask<PowerMode> pwrMode;
+    BitMask<Color> color;
     // BitMask<Suit, 8> suit;
     BitSet<uint8_t, 8> mask;
     optional<int> opt;
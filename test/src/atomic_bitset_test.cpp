@@ -0,0 +1,68 @@
+#include "gtest/gtest.h"
+
+#include <thread>
+#include "atomic_bitset.hpp"
+
+namespace
+{
+    TEST(AtomicBitSetTest, SetResetFlip)
+    {
+        AtomicBitSet<uint64_t, 200> set;
+
+        EXPECT_FALSE(set.set(5));
+        EXPECT_TRUE(set.set(5));
+        EXPECT_TRUE(set.test(5));
+        EXPECT_FALSE(set.flip(130, std::memory_order_relaxed));
+        EXPECT_TRUE(set[130]);
+        EXPECT_TRUE(set.reset(5, std::memory_order_release));
+        EXPECT_FALSE(set.reset(5));
+        EXPECT_EQ(set.count(), 1);
+
+        set.reset_all();
+
+        EXPECT_TRUE(set.empty());
+    }
+
+    TEST(AtomicBitSetTest, TestAndSet)
+    {
+        AtomicBitSet<uint32_t> set;
+
+        EXPECT_FALSE(set.test_and_set(3, std::memory_order_acq_rel));
+        EXPECT_TRUE(set.test_and_set(3, std::memory_order_acq_rel));
+    }
+
+    TEST(AtomicBitSetTest, LoadStore)
+    {
+        BitSet<uint64_t, 100> bits;
+        bits.set(1u, 99u);
+
+        AtomicBitSet<uint64_t, 100, true> set(bits);
+
+        EXPECT_EQ(alignof(decltype(set)), 64);
+        EXPECT_EQ(sizeof(set), 2 * 64);
+        EXPECT_EQ(set.load(), bits);
+    }
+
+    TEST(AtomicBitSetTest, ConcurrentSet)
+    {
+        constexpr std::size_t threads_count = 4;
+        AtomicBitSet<uint64_t, 4096, true> set;
+        std::atomic<std::size_t> winners{0};
+
+        //каждый поток пытается занять все биты, каждый бит должен достаться ровно одному потоку
+        std::vector<std::thread> threads;
+        for(std::size_t t = 0; t < threads_count; ++t)
+        {
+            threads.emplace_back([&set, &winners]
+            {
+                for(std::size_t i = 0; i < 4096; ++i)
+                    if(!set.test_and_set(i, std::memory_order_acq_rel)) winners.fetch_add(1, std::memory_order_relaxed);
+            });
+        }
+        for(auto& thread : threads)
+            thread.join();
+
+        EXPECT_EQ(winners.load(), 4096);
+        EXPECT_EQ(set.count(), 4096);
+    }
+}
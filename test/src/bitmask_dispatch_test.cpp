@@ -0,0 +1,68 @@
+#include "gtest/gtest.h"
+
+#include "bitmask_dispatch.hpp"
+
+namespace
+{
+    enum class Job : unsigned char
+    {
+        Parse,
+        Load,
+        Save,
+        Flush,
+        MaxValue
+    };
+
+    using Mask = BitMask<Job>;
+
+    TEST(BitMaskDispatchTest, HandlerPerEnumerator)
+    {
+        std::string log;
+        for_each_set(Mask(Job::Save, Job::Parse),
+                     [&] { log += "parse "; },
+                     [&] { log += "load "; },
+                     [&](Job job) { log += std::string(enum_name(job)) + " "; },
+                     [&] { log += "flush "; });
+
+        EXPECT_EQ(log, "parse Save ");
+    }
+
+    TEST(BitMaskDispatchTest, GenericHandler)
+    {
+        std::vector<Job> seen;
+        int compile_time = 0;
+        for_each_set(Mask(Job::Load, Job::Flush, Job::Parse), [&](auto job)
+        {
+            //значение известно при компиляции
+            if constexpr (decltype(job)::value == Job::Flush)
+                ++compile_time;
+            seen.push_back(job);
+        });
+
+        EXPECT_EQ(seen, (std::vector<Job>{Job::Parse, Job::Load, Job::Flush}));
+        EXPECT_EQ(compile_time, 1);
+
+        int calls = 0;
+        for_each_set(Mask(), [&](Job) { ++calls; });
+        EXPECT_EQ(calls, 0);
+    }
+
+    enum class Wide : unsigned char
+    {
+        First,
+        Middle = 70,
+        Last = 129,
+        MaxValue
+    };
+
+    TEST(BitMaskDispatchTest, Dispatcher)
+    {
+        std::vector<std::size_t> seen;
+        auto dispatcher = make_dispatcher<BitMask<Wide>>([&](Wide value) { seen.push_back(static_cast<std::size_t>(value)); });
+
+        dispatcher(BitMask<Wide>(Wide::Last, Wide::First, Wide::Middle));
+        dispatcher(BitMask<Wide>(Wide::Middle));
+
+        EXPECT_EQ(seen, (std::vector<std::size_t>{0, 70, 129, 70}));
+    }
+}
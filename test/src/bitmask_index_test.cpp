@@ -0,0 +1,85 @@
+#include "gtest/gtest.h"
+
+#include "bitmask_index.hpp"
+
+namespace
+{
+    enum Color : unsigned char
+    {
+        Red,
+        Green,
+        Blue,
+        Alpha,
+        MaxColor
+    };
+
+    using ColorMask = BitMask<Color, Color::MaxColor>;
+
+    std::vector<ColorMask> make_rows(std::size_t size)
+    {
+        std::mt19937 rng(7);
+        std::vector<ColorMask> rows;
+        rows.reserve(size);
+        for(std::size_t i = 0; i < size; ++i)
+            rows.emplace_back(static_cast<unsigned char>(rng() & 0x0F));
+        return rows;
+    }
+
+    TEST(BitMaskIndexTest, BuildAndRestore)
+    {
+        const auto rows = make_rows(1000);
+        BitMaskIndex<Color, Color::MaxColor> index(rows.begin(), rows.end());
+
+        EXPECT_EQ(index.size(), 1000);
+
+        //часть строк добавлена поштучно до выравнивания на слово, часть - транспонированием блоков
+        index.push_back(ColorMask(Color::Red));
+        index.append(rows.begin(), rows.begin() + 100);
+
+        EXPECT_EQ(index.size(), 1101);
+        for(std::size_t i = 0; i < rows.size(); ++i)
+            EXPECT_EQ(index[i], rows[i]);
+        EXPECT_EQ(index[1000], ColorMask(Color::Red));
+        EXPECT_EQ(index[1100], rows[99]);
+    }
+
+    TEST(BitMaskIndexTest, QueryMatchesRowScan)
+    {
+        const auto rows = make_rows(40000);
+        BitMaskIndex<Color, Color::MaxColor> index(rows.begin(), rows.end());
+
+        std::vector<std::size_t> expected;
+        for(std::size_t i = 0; i < rows.size(); ++i)
+            if(rows[i].has(Color::Red, Color::Green) && !rows[i].has(Color::Blue)) expected.push_back(i);
+
+        auto query = index.query().has(Color::Red, Color::Green).has_none(Color::Blue);
+
+        EXPECT_EQ(query.rows(), expected);
+        EXPECT_EQ(query.count(), expected.size());
+        EXPECT_EQ(index.count(ColorMask(Color::Red, Color::Green), ColorMask(Color::Blue)), expected.size());
+        EXPECT_EQ(query.bitmap().count(), expected.size());
+    }
+
+    TEST(BitMaskIndexTest, AnyAndNoneOnly)
+    {
+        const auto rows = make_rows(333);
+        BitMaskIndex<Color, Color::MaxColor> index(rows.begin(), rows.end());
+
+        std::size_t any = 0;
+        std::size_t none = 0;
+        for(const auto& row : rows)
+        {
+            if(row.has(Color::Blue) || row.has(Color::Alpha)) ++any;
+            if(!row.has(Color::Red)) ++none;
+        }
+
+        EXPECT_EQ(index.query().has_any(Color::Blue, Color::Alpha).count(), any);
+        EXPECT_EQ(index.query().has_none(Color::Red).count(), none);
+        EXPECT_EQ(index.query().count(), rows.size());
+
+        index.clear();
+
+        EXPECT_TRUE(index.empty());
+        EXPECT_EQ(index.query().count(), 0);
+    }
+}
@@ -242,4 +242,223 @@ namespace
             EXPECT_EQ(en.value(), 0b00000000); 
         }
     }
+
+    TEST(BitMaskTest, FindFirstNextLast)
+    {
+        BitMask<StronglyTypedEnum, StronglyTypedEnum::stMaxValue> en(0b00000101);
+
+        EXPECT_EQ(en.find_first(), StronglyTypedEnum::stFirstValue);
+        EXPECT_EQ(en.find_next(StronglyTypedEnum::stFirstValue), StronglyTypedEnum::stThirdValue);
+        EXPECT_EQ(en.find_next(StronglyTypedEnum::stThirdValue), StronglyTypedEnum::stMaxValue);
+        EXPECT_EQ(en.find_last(), StronglyTypedEnum::stThirdValue);
+
+        en.reset();
+
+        EXPECT_EQ(en.find_first(), StronglyTypedEnum::stMaxValue);
+    }
+
+    TEST(BitMaskTest, RangeFor)
+    {
+        BitMask<StronglyTypedEnum, StronglyTypedEnum::stMaxValue> en(0b00000110);
+
+        std::vector<StronglyTypedEnum> values;
+        for(StronglyTypedEnum value : en)
+            values.push_back(value);
+
+        EXPECT_EQ(values, (std::vector<StronglyTypedEnum>{StronglyTypedEnum::stSecondValue, StronglyTypedEnum::stThirdValue}));
+    }
+
+    TEST(BitMaskTest, FusedExpression)
+    {
+        BitMask<StronglyTypedEnum, StronglyTypedEnum::stMaxValue> a(0b00000011);
+        BitMask<StronglyTypedEnum, StronglyTypedEnum::stMaxValue> b(0b00000110);
+        BitMask<StronglyTypedEnum, StronglyTypedEnum::stMaxValue> c(0b00000100);
+
+        BitMask<StronglyTypedEnum, StronglyTypedEnum::stMaxValue> result = (a | b) & ~c;
+
+        EXPECT_EQ(result.value(), 0b00000011);
+        EXPECT_EQ((a ^ b).count(), 2);
+        EXPECT_EQ((~a).count(), 1);
+        EXPECT_TRUE(a.has(a & b));
+        EXPECT_FALSE(a.has(b & c));
+
+        result |= c;
+        EXPECT_TRUE(result.all());
+
+        result.and_not(a);
+        EXPECT_EQ(result, c);
+
+        //одиночные значения перечисления по-прежнему работают
+        EXPECT_TRUE(b.has(StronglyTypedEnum::stThirdValue));
+    }
+
+    TEST(BitMaskTest, ToFromChars)
+    {
+        BitMask<StronglyTypedEnum, StronglyTypedEnum::stMaxValue> en(0b00000110);
+
+        char buffer[8];
+        EXPECT_EQ(en.to_chars(std::begin(buffer), std::end(buffer)).ptr, std::end(buffer));
+        EXPECT_EQ(std::string(buffer, sizeof(buffer)), "00000110");
+
+        BitMask<StronglyTypedEnum, StronglyTypedEnum::stMaxValue> parsed;
+        const std::string bits = "011";
+        EXPECT_EQ(parsed.from_chars(bits.data(), bits.data() + bits.size()).ec, std::errc());
+        EXPECT_EQ(parsed.value(), 0b00000011);
+
+        //бит, которого нет в перечислении
+        const std::string extra = "1000";
+        EXPECT_EQ(parsed.from_chars(extra.data(), extra.data() + extra.size()).ec, std::errc::result_out_of_range);
+
+        const std::string bad = "01x";
+        const auto result = parsed.from_chars(bad.data(), bad.data() + bad.size());
+        EXPECT_EQ(result.ec, std::errc::invalid_argument);
+        EXPECT_EQ(result.ptr, bad.data() + 2);
+        EXPECT_EQ(parsed.value(), 0b00000011);
+    }
+
+    enum class Color : unsigned char
+    {
+        Red,
+        Green,
+        Blue,
+        Alpha,
+    };
+
+    enum WideFlag : std::uint64_t
+    {
+        WideFirst,
+        WideSecond,
+        WideThird
+    };
+
+    TEST(BitMaskTest, EnumReflection)
+    {
+        //MaxValue объявлен - это и есть количество элементов, иначе последнее значение + 1
+        static_assert(enum_size<Enum> == Enum::MaxValue);
+        static_assert(enum_size<Color> == 4);
+        static_assert(enum_size<WideFlag> == 3);
+        static_assert(enum_name(Color::Blue) == "Blue");
+        static_assert(enum_name(SecondValue) == "SecondValue");
+        static_assert(std::is_same<BitMask<Color>, BitMask<Color, 4>>::value);
+
+        Color color{};
+        EXPECT_TRUE(enum_traits<Color>::from_name("Alpha", color));
+        EXPECT_EQ(color, Color::Alpha);
+        EXPECT_FALSE(enum_traits<Color>::from_name("Purple", color));
+        EXPECT_FALSE(enum_traits<Color>::from_name("", color));
+        EXPECT_TRUE(enum_name(static_cast<Color>(7)).empty());
+    }
+
+    TEST(BitMaskTest, ToNamesParse)
+    {
+        BitMask<Color> mask(Color::Red, Color::Blue);
+
+        char buffer[16];
+        const auto written = mask.to_names(std::begin(buffer), std::end(buffer));
+        EXPECT_EQ(written.ec, std::errc());
+        EXPECT_EQ(std::string(buffer, written.ptr), "Red|Blue");
+        EXPECT_EQ(mask.to_names(), "Red|Blue");
+        EXPECT_EQ(BitMask<Color>().to_names(), "");
+
+        char small[5];
+        EXPECT_EQ(mask.to_names(std::begin(small), std::end(small)).ec, std::errc::value_too_large);
+
+        EXPECT_EQ(BitMask<Color>::parse("Red|Blue"), mask);
+        EXPECT_EQ(BitMask<Color>::parse(" Blue | Red "), mask);
+        EXPECT_EQ(BitMask<Color>::parse("0|2"), mask);
+        EXPECT_TRUE(BitMask<Color>::parse("").empty());
+        EXPECT_THROW(BitMask<Color>::parse("Red|Purple"), std::invalid_argument);
+        EXPECT_THROW(BitMask<Color>::parse("Red||Blue"), std::invalid_argument);
+        EXPECT_THROW(BitMask<Color>::parse("Red|"), std::invalid_argument);
+        EXPECT_THROW(BitMask<Color>::parse("4"), std::invalid_argument);
+
+        //при ошибке маска не меняется, ptr указывает на неизвестное имя
+        const std::string bad = "Green|Bleu";
+        const auto result = mask.from_names(bad.data(), bad.data() + bad.size());
+        EXPECT_EQ(result.ec, std::errc::invalid_argument);
+        EXPECT_EQ(result.ptr, bad.data() + 6);
+        EXPECT_EQ(mask.to_names(), "Red|Blue");
+    }
+
+    enum class Capability : unsigned char
+    {
+        Read,
+        Write,
+        Word0Last = 63,
+        Word1First,
+        Middle = 130,
+        Last = 199,
+        MaxValue
+    };
+
+    TEST(BitMaskTest, MultiWord)
+    {
+        using Mask = BitMask<Capability>;
+        static_assert(Mask::bit_count == 200);
+        static_assert(Mask::word_count == 4);
+        static_assert(std::is_same<Mask::type_t, std::uint64_t>::value);
+
+        Mask mask(Capability::Read, Capability::Word1First, Capability::Last);
+        EXPECT_EQ(mask.word(0), 1u);
+        EXPECT_EQ(mask.word(1), 1u);
+        EXPECT_EQ(mask.word(3), std::uint64_t(1) << (199 - 192));
+        EXPECT_EQ(mask.count(), 3);
+
+        EXPECT_TRUE(mask.has(Capability::Read, Capability::Word1First, Capability::Last));
+        EXPECT_FALSE(mask.has(Capability::Read, Capability::Middle));
+        EXPECT_TRUE(mask[Capability::Last]);
+        EXPECT_FALSE(mask.at(Capability::Word0Last));
+
+        mask.set(Capability::Word0Last, Capability::Middle);
+        EXPECT_EQ(mask.count(), 5);
+        mask.reset(Capability::Read, Capability::Last);
+        EXPECT_EQ(mask.count(), 3);
+        mask[Capability::Write] = true;
+        EXPECT_TRUE(mask.has(Capability::Write));
+
+        std::vector<Capability> seen(mask.begin(), mask.end());
+        EXPECT_EQ(seen, (std::vector<Capability>{Capability::Write, Capability::Word0Last, Capability::Word1First, Capability::Middle}));
+        EXPECT_EQ(mask.find_first(), Capability::Write);
+        EXPECT_EQ(mask.find_next(Capability::Word0Last), Capability::Word1First);
+        EXPECT_EQ(mask.find_last(), Capability::Middle);
+
+        const Mask other(Capability::Middle, Capability::Last);
+        EXPECT_EQ(Mask(mask & other), Mask(Capability::Middle));
+        EXPECT_EQ(Mask(mask | other).count(), 5);
+        EXPECT_EQ(Mask(~Mask()).count(), 200);
+        EXPECT_TRUE(Mask(~Mask()).all());
+        EXPECT_FALSE(mask.all());
+
+        EXPECT_EQ(mask.to_names(), "Write|Word0Last|Word1First|Middle");
+        EXPECT_EQ(Mask::parse("Middle|Last|199"), other);
+        EXPECT_THROW(Mask::parse("200"), std::invalid_argument);
+
+        mask.reset();
+        EXPECT_TRUE(mask.empty());
+        EXPECT_EQ(mask.find_first(), Capability::MaxValue);
+    }
+
+    enum class Octet : unsigned char
+    {
+        B0, B1, B2, B3, B4, B5, B6, B7
+    };
+
+    TEST(BitMaskTest, FullWidthWord)
+    {
+        //все биты базового типа значащие: маска хвоста - целое слово
+        using Mask = BitMask<Octet>;
+        static_assert(Mask::bit_count == 8 && Mask::word_count == 1);
+
+        Mask mask(static_cast<unsigned char>(0xFF));
+        EXPECT_EQ(mask.value(), 0xFF);
+        EXPECT_TRUE(mask.all());
+        EXPECT_EQ(mask.count(), 8);
+        EXPECT_EQ(Mask(~Mask()).value(), 0xFF);
+        EXPECT_TRUE(mask.has(Octet::B0, Octet::B7));
+
+        const std::string bits = "10000001";
+        Mask parsed;
+        EXPECT_EQ(parsed.from_chars(bits.data(), bits.data() + bits.size()).ec, std::errc());
+        EXPECT_EQ(parsed, Mask(Octet::B0, Octet::B7));
+    }
 }
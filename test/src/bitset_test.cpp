@@ -0,0 +1,219 @@
+#include "gtest/gtest.h"
+
+#include "bitset.hpp"
+
+namespace
+{
+    TEST(BitSetTest, SingleWordValue)
+    {
+        BitSet<uint8_t, 5> set(static_cast<uint8_t>(0b11110101));
+
+        //лишние биты должны пропасть
+        EXPECT_EQ(set.value(), 0b00010101);
+        EXPECT_EQ(set.count(), 3);
+        EXPECT_EQ(set.size(), 5);
+        EXPECT_EQ(set.to_string(), "10101");
+    }
+
+    TEST(BitSetTest, MultiWordSetReset)
+    {
+        BitSet<uint64_t, 300> set;
+
+        EXPECT_EQ((BitSet<uint64_t, 300>::word_count), 5);
+        EXPECT_TRUE(set.empty());
+
+        set.set(0u, 63u, 64u, 299u);
+
+        EXPECT_TRUE(set.has(0u, 63u, 64u, 299u));
+        EXPECT_FALSE(set.has(1u));
+        EXPECT_EQ(set.count(), 4);
+        EXPECT_EQ(set.word(1), 1u);
+
+        set.reset(63u);
+
+        EXPECT_FALSE(set[63u]);
+        EXPECT_EQ(set.count(), 3);
+
+        set.reset();
+
+        EXPECT_FALSE(set.any());
+    }
+
+    TEST(BitSetTest, MultiWordValueCtor)
+    {
+        BitSet<uint8_t, 20> set(0xFFFFFFFFu);
+
+        //значение раскладывается по словам и обрезается до N
+        EXPECT_EQ(set.word(0), 0xFF);
+        EXPECT_EQ(set.word(1), 0xFF);
+        EXPECT_EQ(set.word(2), 0x0F);
+        EXPECT_EQ(set.count(), 20);
+        EXPECT_TRUE(set.all());
+    }
+
+    TEST(BitSetTest, LogicalOperators)
+    {
+        BitSet<uint64_t, 1024> a;
+        BitSet<uint64_t, 1024> b;
+
+        a.set(1u, 100u, 700u, 1023u);
+        b.set(100u, 500u, 1023u);
+
+        EXPECT_EQ((a & b).count(), 2);
+        EXPECT_EQ((a | b).count(), 5);
+        EXPECT_EQ((a ^ b).count(), 3);
+
+        BitSet<uint64_t, 1024> diff(a);
+        diff.and_not(b);
+
+        EXPECT_TRUE(diff.has(1u, 700u));
+        EXPECT_EQ(diff.count(), 2);
+
+        EXPECT_TRUE(a.has(a & b));
+        EXPECT_FALSE(a.has(b));
+        EXPECT_EQ(a & b, b & a);
+        EXPECT_NE(a, b);
+    }
+
+    TEST(BitSetTest, FusedExpression)
+    {
+        BitSet<uint64_t, 300> a;
+        BitSet<uint64_t, 300> b;
+        BitSet<uint64_t, 300> c;
+
+        a.set(1u, 64u, 200u, 299u);
+        b.set(2u, 200u, 250u);
+        c.set(64u, 250u);
+
+        //выражение вычисляется за один проход при присваивании
+        BitSet<uint64_t, 300> result = (a | b) & ~c;
+
+        EXPECT_EQ(result.count(), 4);
+        EXPECT_TRUE(result.has(1u, 2u, 200u, 299u));
+        EXPECT_EQ(((a | b) & ~c).count(), 4);
+        EXPECT_EQ(and_not(a | b, c), result);
+
+        //дополнение не выходит за границу набора
+        EXPECT_EQ((~a).count(), 296);
+        EXPECT_TRUE((a ^ a).empty());
+        EXPECT_TRUE((a | ~a).all());
+        EXPECT_TRUE(((a | b) & c).test(250));
+
+        EXPECT_TRUE(result.has(a & ~c));
+        EXPECT_FALSE(result.has(c & b));
+
+        result &= a ^ b;
+        EXPECT_EQ(result.count(), 3);
+
+        BitSet<uint8_t, 5> small(0b10101u);
+        uint8_t value = ~small;
+        EXPECT_EQ(value, 0b01010);
+    }
+
+    TEST(BitSetTest, ComplementAndAll)
+    {
+        BitSet<uint32_t, 100> set;
+
+        EXPECT_FALSE(set.all());
+
+        BitSet<uint32_t, 100> full = ~set;
+
+        EXPECT_TRUE(full.all());
+        EXPECT_EQ(full.count(), 100);
+
+        full.reset(50u);
+
+        EXPECT_FALSE(full.all());
+    }
+
+    TEST(BitSetTest, At)
+    {
+        BitSet<uint64_t, 128> set;
+
+        set.at(127u) = true;
+
+        EXPECT_TRUE(set.at(127u));
+        EXPECT_THROW(set.at(128u), std::out_of_range);
+    }
+
+    TEST(BitSetTest, FindFirstNextLast)
+    {
+        BitSet<uint64_t, 200> set;
+
+        EXPECT_EQ(set.find_first(), 200);
+        EXPECT_EQ(set.find_last(), 200);
+
+        set.set(3u, 64u, 199u);
+
+        EXPECT_EQ(set.find_first(), 3);
+        EXPECT_EQ(set.find_next(3), 64);
+        EXPECT_EQ(set.find_next(64), 199);
+        EXPECT_EQ(set.find_next(199), 200);
+        EXPECT_EQ(set.find_last(), 199);
+    }
+
+    TEST(BitSetTest, RangeFor)
+    {
+        BitSet<uint8_t, 30> set;
+
+        set.set(0u, 7u, 8u, 29u);
+
+        std::vector<std::size_t> indexes;
+        for(auto index : set)
+            indexes.push_back(index);
+
+        EXPECT_EQ(indexes, (std::vector<std::size_t>{0, 7, 8, 29}));
+
+        BitSet<uint64_t, 512> empty;
+
+        EXPECT_TRUE(empty.begin() == empty.end());
+    }
+
+    TEST(BitSetTest, ToFromChars)
+    {
+        BitSet<uint8_t, 5> small(static_cast<uint8_t>(0b00011));
+
+        //старший бит первым, как у BitMask и std::bitset
+        EXPECT_EQ(small.to_string(), "00011");
+
+        std::mt19937_64 rng(3);
+        BitSet<uint64_t, 300> set;
+        std::bitset<300> reference;
+        for(std::size_t i = 0; i < 300; ++i)
+            if(rng() & 1)
+            {
+                set.set(static_cast<std::size_t>(i));
+                reference.set(i);
+            }
+
+        char buffer[BitSet<uint64_t, 300>::chars_size];
+        const auto written = set.to_chars(std::begin(buffer), std::end(buffer));
+
+        EXPECT_EQ(written.ec, std::errc());
+        EXPECT_EQ(written.ptr, std::end(buffer));
+        EXPECT_EQ(std::string(buffer, sizeof(buffer)), reference.to_string());
+        EXPECT_EQ(set.to_chars(buffer, buffer + 10).ec, std::errc::value_too_large);
+
+        BitSet<uint64_t, 300> parsed;
+        EXPECT_EQ(parsed.from_chars(std::begin(buffer), std::end(buffer)).ec, std::errc());
+        EXPECT_EQ(parsed, set);
+
+        //короткая строка дополняется нулями слева
+        const std::string bits = "101";
+        EXPECT_EQ(parsed.from_chars(bits.data(), bits.data() + bits.size()).ec, std::errc());
+        EXPECT_EQ(parsed.count(), 2);
+        EXPECT_TRUE(parsed.has(0u, 2u));
+
+        //ошибки не меняют набор
+        std::string bad(200, '1');
+        bad[150] = '2';
+        const auto result = parsed.from_chars(bad.data(), bad.data() + bad.size());
+        EXPECT_EQ(result.ec, std::errc::invalid_argument);
+        EXPECT_EQ(result.ptr, bad.data() + 150);
+        EXPECT_EQ(parsed.count(), 2);
+
+        const std::string longer(301, '0');
+        EXPECT_EQ(parsed.from_chars(longer.data(), longer.data() + longer.size()).ec, std::errc::result_out_of_range);
+        EXPECT_EQ(parsed.from_chars(bits.data(), bits.data()).ec, std::errc::invalid_argument);
+    }
+}
@@ -0,0 +1,122 @@
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include "bloom_filter.hpp"
+
+namespace
+{
+    TEST(BloomFilterTest, NoFalseNegatives)
+    {
+        BloomFilter filter(10000, 0.01);
+
+        for(std::uint64_t i = 0; i < 10000; ++i)
+            filter.insert(i);
+
+        for(std::uint64_t i = 0; i < 10000; ++i)
+            ASSERT_TRUE(filter.contains(i));
+    }
+
+    TEST(BloomFilterTest, FalsePositiveRate)
+    {
+        constexpr std::size_t n = 100000;
+        BloomFilter filter(n, 0.01);
+
+        EXPECT_LE(BloomFilter::estimate_false_positive_rate(filter.block_count(), n), 0.01);
+        EXPECT_GT(BloomFilter::estimate_false_positive_rate(filter.block_count() - 1, n), 0.01);
+
+        //размер считается за O(sqrt(n)) на оценку: сто миллионов ключей - около 10 бит на ключ
+        const std::size_t blocks = BloomFilter::blocks_for(100'000'000, 0.01);
+        EXPECT_GT(blocks * BloomFilter::block_bits, 9.6 * 100'000'000);
+        EXPECT_LT(blocks * BloomFilter::block_bits, 11 * 100'000'000.0);
+
+        //номер блока считается в 64 битах, поэтому блоков не больше 2^32 при любом количестве ключей
+        EXPECT_EQ(BloomFilter::blocks_for(std::size_t(1) << 40, 0.0001), BloomFilter::max_blocks);
+
+        EXPECT_THROW(BloomFilter(n, 0.0), std::invalid_argument);
+        EXPECT_THROW(BloomFilter(n, -0.1), std::invalid_argument);
+        EXPECT_THROW(BloomFilter(n, 1.0), std::invalid_argument);
+        EXPECT_THROW(BloomFilter(n, std::nan("")), std::invalid_argument);
+
+        for(std::uint64_t i = 0; i < n; ++i)
+            filter.insert(i);
+
+        std::size_t positives = 0;
+        for(std::uint64_t i = n; i < 11 * n; ++i)
+            positives += filter.contains(i);
+
+        //фактическая доля ложных срабатываний близка к расчётной
+        EXPECT_LT(static_cast<double>(positives) / (10 * n), 0.015);
+    }
+
+    TEST(BloomFilterTest, ContainsMany)
+    {
+        BloomFilter filter(1000);
+        std::vector<std::uint64_t> hashes;
+        for(std::uint64_t i = 0; i < 1000; ++i)
+        {
+            hashes.push_back(i * 2);
+            if(i % 3 == 0) filter.insert(i * 2);
+        }
+
+        std::unique_ptr<bool[]> result(new bool[hashes.size()]);
+        const std::size_t found = filter.contains_many(hashes.data(), hashes.size(), result.get());
+
+        std::size_t expected = 0;
+        for(std::size_t i = 0; i < hashes.size(); ++i)
+        {
+            EXPECT_EQ(result[i], filter.contains(hashes[i]));
+            if(i % 3 == 0)
+            {
+                EXPECT_TRUE(result[i]);
+            }
+            expected += result[i];
+        }
+        EXPECT_EQ(found, expected);
+    }
+
+    TEST(BloomFilterTest, Merge)
+    {
+        BloomFilter a(1000), b(1000), c(100000);
+
+        a.insert(1);
+        b.insert(2);
+        a.merge(b);
+
+        EXPECT_TRUE(a.contains(1));
+        EXPECT_TRUE(a.contains(2));
+        EXPECT_GE(a.count(), 8u);
+        EXPECT_LE(a.count(), 16u);
+        EXPECT_THROW(a.merge(c), std::invalid_argument);
+    }
+
+    TEST(BloomFilterTest, Serialization)
+    {
+        BloomFilter filter(5000, 0.001);
+        for(std::uint64_t i = 0; i < 5000; ++i)
+            filter.insert(i * 7919);
+
+        std::stringstream stream;
+        filter.write(stream);
+
+        const BloomFilter copy = BloomFilter::read(stream);
+
+        EXPECT_EQ(copy.block_count(), filter.block_count());
+        EXPECT_EQ(copy, filter);
+
+        std::stringstream truncated(stream.str().substr(0, 100));
+        EXPECT_THROW(BloomFilter::read(truncated), std::runtime_error);
+
+        std::stringstream garbage(std::string(64, 'x'));
+        EXPECT_THROW(BloomFilter::read(garbage), std::runtime_error);
+
+        //испорченный заголовок с огромным block_count: обрыв потока, а не попытка выделить терабайты
+        detail::bloom_filter_header header{};
+        std::memcpy(&header, stream.str().data(), sizeof(header));
+        for(const std::uint64_t block_count : {std::uint64_t(BloomFilter::max_blocks), std::uint64_t(BloomFilter::max_blocks) + 1, ~std::uint64_t(0)})
+        {
+            header.block_count = block_count;
+            std::stringstream hostile(std::string(reinterpret_cast<const char*>(&header), sizeof(header)) + std::string(4096, '\0'));
+            EXPECT_THROW(BloomFilter::read(hostile), std::runtime_error);
+        }
+    }
+}
@@ -0,0 +1,147 @@
+#include "gtest/gtest.h"
+
+#include "compact_optional.hpp"
+
+namespace
+{
+    enum class Level : unsigned char
+    {
+        Low,
+        Medium,
+        High,
+    };
+
+    enum class Feature : unsigned char
+    {
+        Fast,
+        Safe,
+        Small,
+    };
+
+    using Id = compact_optional<std::uint32_t, sentinel_policy<std::uint32_t, ~0u>>;
+
+    static_assert(sizeof(Id) == sizeof(std::uint32_t));
+    static_assert(sizeof(compact_optional<double>) == sizeof(double));
+    static_assert(sizeof(compact_optional<float>) == sizeof(float));
+    static_assert(sizeof(compact_optional<int*>) == sizeof(int*));
+    static_assert(sizeof(compact_optional<Level>) == sizeof(Level));
+    static_assert(sizeof(compact_optional<BitMask<Feature>>) == sizeof(BitMask<Feature>));
+    static_assert(std::is_trivially_copyable<compact_optional<double>>::value);
+
+    TEST(CompactOptionalTest, Sentinel)
+    {
+        Id id;
+        EXPECT_FALSE(id.has_value());
+        EXPECT_EQ(id, nullopt);
+        EXPECT_THROW(id.value(), bad_optional_access);
+        EXPECT_EQ(id.value_or(5u), 5u);
+
+        id = 0u;
+        EXPECT_TRUE(id);
+        EXPECT_EQ(id.value(), 0u);
+        EXPECT_EQ(id, 0u);
+        EXPECT_NE(id, nullopt);
+
+        id.emplace(42u);
+        EXPECT_EQ(*id, 42u);
+        id = nullopt;
+        EXPECT_FALSE(id);
+    }
+
+    TEST(CompactOptionalTest, Comparisons)
+    {
+        using Wide = compact_optional<std::uint64_t, sentinel_policy<std::uint64_t, ~0ull>>;
+
+        //пустой объект меньше любого значения, как у std::optional
+        constexpr Id none, one(1u), two(2u);
+        static_assert(none < one && one < two && !(two < one) && !(none < none));
+        static_assert(none <= none && one <= two && !(two <= one));
+        static_assert(two > one && one > none && !(none > none));
+        static_assert(two >= two && one >= none && !(none >= one));
+        static_assert(one == one && one != two && none != one && none == Id());
+
+        static_assert(none == nullopt && nullopt == none && one != nullopt && nullopt != one);
+        static_assert(!(none < nullopt) && nullopt < one && !(one < nullopt));
+        static_assert(none <= nullopt && !(one <= nullopt) && nullopt <= one);
+        static_assert(one > nullopt && !(none > nullopt) && !(nullopt > one));
+        static_assert(one >= nullopt && nullopt >= none && !(nullopt >= one));
+
+        static_assert(one == 1u && 2u == two && none != 1u && 1u != two);
+        static_assert(none < 0u && one < 2u && 1u < two && !(0u < none));
+        static_assert(none <= 0u && one <= 1u && 1u <= one && !(0u <= none));
+        static_assert(two > 1u && 3u > two && 0u > none && !(none > 0u));
+        static_assert(two >= 2u && 2u >= two && 0u >= none && !(none >= 0u));
+
+        //разные типы значений и политики сравниваются через значения
+        const Wide wide(2);
+        EXPECT_EQ(two, wide);
+        EXPECT_NE(one, wide);
+        EXPECT_LT(one, wide);
+        EXPECT_LE(wide, two);
+        EXPECT_GT(wide, none);
+        EXPECT_GE(Wide(), none);
+        EXPECT_NE(Wide(), one);
+        EXPECT_EQ(wide, 2u);
+        EXPECT_LT(compact_optional<double>(1.5), 2);
+    }
+
+    TEST(CompactOptionalTest, RvalueValue)
+    {
+        Id id(7u);
+        static_assert(std::is_same<decltype(std::move(id).value()), std::uint32_t&&>::value);
+        static_assert(std::is_same<decltype(std::move(static_cast<const Id&>(id)).value()), const std::uint32_t&&>::value);
+        static_assert(Id(3u).value() == 3u);
+
+        EXPECT_EQ(std::move(id).value(), 7u);
+        EXPECT_THROW(Id().value(), bad_optional_access);
+    }
+
+    TEST(CompactOptionalTest, Nan)
+    {
+        compact_optional<double> value;
+        EXPECT_FALSE(value);
+
+        //обычный NaN - допустимое значение, пустое значение - только NaN с особой нагрузкой
+        value = std::numeric_limits<double>::quiet_NaN();
+        EXPECT_TRUE(value);
+        EXPECT_TRUE(std::isnan(*value));
+
+        value = 1.5;
+        EXPECT_EQ(value.value(), 1.5);
+        EXPECT_LT(compact_optional<double>(), value);
+        EXPECT_LT(compact_optional<double>(1.0), value);
+        value.reset();
+        EXPECT_EQ(value, compact_optional<double>());
+
+        compact_optional<float> f(2.0f);
+        EXPECT_EQ(f, 2.0f);
+        f = nullopt;
+        EXPECT_FALSE(f);
+    }
+
+    TEST(CompactOptionalTest, PointerEnumBitMask)
+    {
+        int x = 1;
+        compact_optional<int*> ptr;
+        EXPECT_FALSE(ptr);
+        ptr = &x;
+        EXPECT_EQ(*ptr.value(), 1);
+
+        compact_optional<Level> level;
+        EXPECT_FALSE(level);
+        level = Level::High;
+        EXPECT_EQ(level, Level::High);
+        EXPECT_NE(level, compact_optional<Level>(Level::Low));
+
+        compact_optional<BitMask<Feature>> features;
+        EXPECT_FALSE(features);
+        features.emplace(Feature::Fast, Feature::Small);
+        EXPECT_TRUE(features->has(Feature::Small));
+        EXPECT_EQ(features->count(), 2);
+
+        //пустая маска - это значение, а не отсутствие значения
+        features = BitMask<Feature>();
+        EXPECT_TRUE(features);
+        EXPECT_TRUE(features->empty());
+    }
+}
@@ -0,0 +1,115 @@
+#include "gtest/gtest.h"
+
+#include "dynamic_bitset.hpp"
+
+namespace
+{
+    TEST(DynamicBitSetTest, SizeCtor)
+    {
+        DynamicBitSet<> set(1000);
+
+        EXPECT_EQ(set.size(), 1000);
+        EXPECT_EQ(set.word_count(), 16);
+        EXPECT_TRUE(set.empty());
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(set.data()) % 64, 0);
+
+        DynamicBitSet<uint8_t, std::allocator<uint8_t>> full(13, true);
+
+        EXPECT_TRUE(full.all());
+        EXPECT_EQ(full.count(), 13);
+        EXPECT_EQ(full.to_string(), "1111111111111");
+    }
+
+    TEST(DynamicBitSetTest, SetResetHas)
+    {
+        DynamicBitSet<> set(130);
+
+        set.set(0u, 64u, 129u);
+
+        EXPECT_TRUE(set.has(0u, 64u, 129u));
+        EXPECT_FALSE(set.has(1u));
+        EXPECT_EQ(set.count(), 3);
+
+        std::size_t index = 64;
+        set.reset(index);
+
+        EXPECT_FALSE(set[index]);
+        EXPECT_EQ(set.find_next(0), 129);
+        EXPECT_THROW(set.at(130u), std::out_of_range);
+    }
+
+    TEST(DynamicBitSetTest, Resize)
+    {
+        DynamicBitSet<uint32_t> set(10);
+
+        set.set(9u);
+        set.resize(100, true);
+
+        //старые биты сохранились, новые выставлены
+        EXPECT_FALSE(set.has(0u));
+        EXPECT_TRUE(set.has(9u, 10u, 99u));
+        EXPECT_EQ(set.count(), 91);
+
+        set.resize(20);
+
+        EXPECT_EQ(set.count(), 11);
+
+        set.resize(40);
+
+        //при повторном росте обрезанные биты не возвращаются
+        EXPECT_EQ(set.count(), 11);
+        EXPECT_EQ(set.find_last(), 19);
+    }
+
+    TEST(DynamicBitSetTest, LogicalOperators)
+    {
+        DynamicBitSet<> a(5000);
+        DynamicBitSet<> b(5000);
+
+        a.set(1u, 1000u, 4999u);
+        b.set(1000u, 3000u);
+
+        EXPECT_EQ((a & b).count(), 1);
+        EXPECT_EQ((a | b).count(), 4);
+        EXPECT_EQ((a ^ b).count(), 3);
+        EXPECT_EQ((~a).count(), 4997);
+        EXPECT_TRUE(a.has(a & b));
+
+        a.and_not(b);
+
+        EXPECT_FALSE(a.has(1000u));
+
+        DynamicBitSet<> c(10);
+
+        EXPECT_THROW(a &= c, std::invalid_argument);
+    }
+
+    TEST(DynamicBitSetTest, RangeFor)
+    {
+        DynamicBitSet<> set(300);
+
+        set.set(5u, 70u, 299u);
+
+        std::vector<std::size_t> indexes(set.begin(), set.end());
+
+        EXPECT_EQ(indexes, (std::vector<std::size_t>{5, 70, 299}));
+    }
+
+    TEST(DynamicBitSetTest, ToFromChars)
+    {
+        DynamicBitSet<> set(70);
+        set.set(0u, 69u);
+
+        //старший бит первым
+        const std::string str = set.to_string();
+        EXPECT_EQ(str, "1" + std::string(68, '0') + "1");
+
+        DynamicBitSet<> parsed(70);
+        EXPECT_EQ(parsed.from_chars(str.data(), str.data() + str.size()).ec, std::errc());
+        EXPECT_EQ(parsed, set);
+
+        const std::string bad = "1x";
+        EXPECT_EQ(parsed.from_chars(bad.data(), bad.data() + bad.size()).ec, std::errc::invalid_argument);
+        EXPECT_TRUE(parsed.empty());
+    }
+}
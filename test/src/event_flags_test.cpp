@@ -0,0 +1,108 @@
+#include "gtest/gtest.h"
+
+#include <thread>
+#include "event_flags.hpp"
+
+namespace
+{
+    enum class Event : unsigned char
+    {
+        Ready,
+        Data,
+        Error,
+        Stop,
+    };
+
+    using Mask = BitMask<Event>;
+
+    TEST(EventFlagsTest, SetClearGet)
+    {
+        EventFlags<Event> flags;
+
+        EXPECT_TRUE(flags.set(Mask(Event::Ready, Event::Data)).empty());
+        EXPECT_EQ(flags.set(Mask(Event::Data)), Mask(Event::Ready, Event::Data));
+        EXPECT_EQ(flags.clear(Mask(Event::Ready)), Mask(Event::Ready, Event::Data));
+        EXPECT_EQ(flags.get(), Mask(Event::Data));
+        EXPECT_EQ(flags.waiting(), 0u);
+    }
+
+    TEST(EventFlagsTest, AlreadySatisfied)
+    {
+        EventFlags<Event> flags(Mask(Event::Ready, Event::Error));
+
+        EXPECT_EQ(flags.wait_any(Mask(Event::Error, Event::Stop)), Mask(Event::Ready, Event::Error));
+        EXPECT_EQ(flags.wait_all(Mask(Event::Ready, Event::Error), true), Mask(Event::Ready, Event::Error));
+        //clear_on_exit сбросил только ожидаемые флаги
+        EXPECT_TRUE(flags.get().empty());
+    }
+
+    TEST(EventFlagsTest, Timeout)
+    {
+        EventFlags<Event> flags(Mask(Event::Ready));
+
+        const auto start = std::chrono::steady_clock::now();
+        const Mask any = flags.wait_any(Mask(Event::Stop), std::chrono::milliseconds(20));
+        const Mask all = flags.wait_all(Mask(Event::Ready, Event::Data), std::chrono::milliseconds(0));
+
+        EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+        EXPECT_FALSE(any.has(Event::Stop));
+        EXPECT_FALSE(all.has(Event::Ready, Event::Data));
+        EXPECT_EQ(flags.waiting(), 0u);
+    }
+
+    TEST(EventFlagsTest, WakeOnRelevantFlag)
+    {
+        EventFlags<Event> flags;
+        Mask result;
+
+        std::thread waiter([&] { result = flags.wait_all(Mask(Event::Ready, Event::Data), std::chrono::seconds(10)); });
+        while(flags.waiting() == 0)
+            std::this_thread::yield();
+
+        flags.set(Mask(Event::Error));
+        flags.set(Mask(Event::Ready));
+        flags.set(Mask(Event::Data));
+        waiter.join();
+
+        EXPECT_EQ(result, Mask(Event::Ready, Event::Data, Event::Error));
+        EXPECT_EQ(flags.waiting(), 0u);
+    }
+
+    TEST(EventFlagsTest, ClearOnExitHandsEventToOneWaiter)
+    {
+        EventFlags<Event> flags;
+        std::atomic<int> taken{0};
+
+        //ждём без таймаута: задержка запуска потоков не должна ни ронять, ни вешать тест.
+        //Stop тоже сбрасывается при выходе, поэтому получивший его поток передаёт Stop следующему
+        std::vector<std::thread> waiters;
+        for(int i = 0; i < 4; ++i)
+            waiters.emplace_back([&]
+            {
+                for(;;)
+                {
+                    const Mask events = flags.wait_any(Mask(Event::Data, Event::Stop), true);
+                    if(events.has(Event::Data)) ++taken;
+                    if(events.has(Event::Stop))
+                    {
+                        flags.set(Mask(Event::Stop));
+                        return;
+                    }
+                }
+            });
+        while(flags.waiting() < 4)
+            std::this_thread::yield();
+
+        for(int i = 0; i < 100; ++i)
+        {
+            flags.set(Mask(Event::Data));
+            while(flags.get().has(Event::Data))
+                std::this_thread::yield();
+        }
+        flags.set(Mask(Event::Stop));
+        for(auto& waiter : waiters)
+            waiter.join();
+
+        EXPECT_EQ(taken.load(), 100);
+    }
+}
@@ -0,0 +1,86 @@
+#include "gtest/gtest.h"
+
+#include "hierarchical_bitset.hpp"
+
+namespace
+{
+    template<std::size_t N>
+    void check_against_bitset(std::size_t operations)
+    {
+        auto set = std::make_unique<HierarchicalBitSet<N>>();
+        std::bitset<N> reference;
+        std::mt19937_64 rng(N);
+
+        for(std::size_t op = 0; op < operations; ++op)
+        {
+            //короткие серии по соседним битам, чтобы слова заполнялись целиком и освобождались
+            const std::size_t start = rng() % N;
+            const bool value = rng() % 2;
+            for(std::size_t i = start; i < std::min(N, start + rng() % 200); ++i)
+            {
+                if(value)
+                    set->set(i);
+                else
+                    set->reset(i);
+                reference[i] = value;
+            }
+
+            std::size_t first_set = N, first_clear = N;
+            for(std::size_t i = 0; i < N && (first_set == N || first_clear == N); ++i)
+            {
+                if(reference[i] && first_set == N) first_set = i;
+                if(!reference[i] && first_clear == N) first_clear = i;
+            }
+            ASSERT_EQ(set->find_first_set(), first_set);
+            ASSERT_EQ(set->find_first_clear(), first_clear);
+
+            const std::size_t from = rng() % N;
+            std::size_t next_set = from + 1, next_clear = from + 1;
+            while(next_set < N && !reference[next_set]) ++next_set;
+            while(next_clear < N && reference[next_clear]) ++next_clear;
+            ASSERT_EQ(set->find_next(from), std::min(next_set, N));
+            ASSERT_EQ(set->find_next_clear(from), std::min(next_clear, N));
+        }
+
+        EXPECT_EQ(set->count(), reference.count());
+        EXPECT_EQ(set->any(), reference.any());
+        EXPECT_EQ(set->all(), reference.all());
+    }
+
+    TEST(HierarchicalBitSetTest, Levels)
+    {
+        EXPECT_EQ(HierarchicalBitSet<64>::levels, 1);
+        EXPECT_EQ(HierarchicalBitSet<4096>::levels, 1);
+        EXPECT_EQ(HierarchicalBitSet<4097>::levels, 2);
+        EXPECT_EQ(HierarchicalBitSet<(1 << 24)>::levels, 3);
+    }
+
+    TEST(HierarchicalBitSetTest, MatchesLinearScan)
+    {
+        check_against_bitset<50>(200);
+        check_against_bitset<1000>(500);
+        check_against_bitset<300000>(300);
+    }
+
+    TEST(HierarchicalBitSetTest, FullAndEmpty)
+    {
+        HierarchicalBitSet<130> set;
+
+        EXPECT_TRUE(set.empty());
+        EXPECT_EQ(set.find_first_set(), 130);
+        EXPECT_EQ(set.find_first_clear(), 0);
+
+        for(std::size_t i = 0; i < 130; ++i)
+            set.set(i);
+
+        EXPECT_TRUE(set.all());
+        EXPECT_EQ(set.find_first_clear(), 130);
+        EXPECT_EQ(set.find_next_clear(5), 130);
+
+        set.reset(129u);
+
+        EXPECT_FALSE(set.all());
+        EXPECT_EQ(set.find_first_clear(), 129);
+        EXPECT_EQ(set.find_next(128), 130);
+    }
+}
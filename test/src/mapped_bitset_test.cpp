@@ -0,0 +1,105 @@
+#include "gtest/gtest.h"
+
+#include "mapped_bitset.hpp"
+#include "dynamic_bitset.hpp"
+
+namespace
+{
+    std::string temp_path(const char* name)
+    {
+        return (std::filesystem::temp_directory_path() / (std::string(name) + "_" + std::to_string(::getpid()))).string();
+    }
+
+    DynamicBitSet<> make_set()
+    {
+        DynamicBitSet<> set(100000);
+        for(std::size_t i = 3; i < set.size(); i += 7)
+            set.set(i);
+        return set;
+    }
+
+    TEST(MappedBitSetTest, SaveAndMap)
+    {
+        const auto path = temp_path("mapped_bitset_save");
+        const auto set = make_set();
+        MappedBitSet::save(path, set);
+
+        MappedBitSet mapped(path, MappedBitSet::mapping::read_only, true);
+
+        EXPECT_EQ(mapped.size(), set.size());
+        EXPECT_EQ(mapped.count(), set.count());
+        EXPECT_TRUE(mapped.has(3u, 10u, 99999u - (99999u - 3u) % 7u));
+        EXPECT_FALSE(mapped[4]);
+        EXPECT_EQ(mapped.find_first(), 3);
+        EXPECT_EQ(mapped.find_next(3), 10);
+        EXPECT_EQ(mapped.find_last(), set.find_last());
+        EXPECT_EQ(std::distance(mapped.begin(), mapped.end()), static_cast<std::ptrdiff_t>(set.count()));
+        EXPECT_TRUE(mapped.verify());
+        EXPECT_THROW(mapped.set(4u), std::logic_error);
+
+        MappedBitSet moved(std::move(mapped));
+        EXPECT_EQ(moved.count(), set.count());
+
+        std::filesystem::remove(path);
+    }
+
+    TEST(MappedBitSetTest, CopyOnWriteDoesNotTouchFile)
+    {
+        const auto path = temp_path("mapped_bitset_cow");
+        MappedBitSet::save(path, make_set());
+
+        {
+            MappedBitSet mapped(path, MappedBitSet::mapping::copy_on_write);
+            mapped.set(4u);
+            mapped.reset(3u);
+
+            EXPECT_TRUE(mapped.has(4u));
+            EXPECT_FALSE(mapped.has(3u));
+        }
+
+        MappedBitSet reopened(path);
+        EXPECT_FALSE(reopened.has(4u));
+        EXPECT_TRUE(reopened.has(3u));
+
+        std::filesystem::remove(path);
+    }
+
+    TEST(MappedBitSetTest, RejectsBadFiles)
+    {
+        const auto path = temp_path("mapped_bitset_bad");
+
+        EXPECT_THROW(MappedBitSet(path + ".missing"), std::system_error);
+
+        {
+            std::ofstream(path, std::ios::binary) << "not a bitset file at all, definitely longer than sixty-four bytes......";
+        }
+        EXPECT_THROW(MappedBitSet{path}, std::runtime_error);
+
+        //портим одно слово: заголовок верный, но контрольная сумма не сходится
+        MappedBitSet::save(path, make_set());
+        {
+            std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(sizeof(detail::mapped_bitset_header) + 8);
+            file.put('\xFF');
+        }
+        EXPECT_NO_THROW(MappedBitSet{path});
+        EXPECT_FALSE(MappedBitSet(path).verify());
+        EXPECT_THROW(MappedBitSet(path, MappedBitSet::mapping::read_only, true), std::runtime_error);
+
+        //обрезанный файл
+        std::filesystem::resize_file(path, 100);
+        EXPECT_THROW(MappedBitSet{path}, std::runtime_error);
+
+        //размер в заголовке настолько велик, что округление до слов переполняется
+        MappedBitSet::save(path, make_set());
+        {
+            std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+            const std::uint64_t bit_count = ~std::uint64_t(0);
+            file.seekp(offsetof(detail::mapped_bitset_header, bit_count));
+            file.write(reinterpret_cast<const char*>(&bit_count), sizeof(bit_count));
+        }
+        EXPECT_THROW(MappedBitSet{path}, std::runtime_error);
+
+        std::filesystem::remove(path);
+    }
+}
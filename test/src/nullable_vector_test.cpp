@@ -0,0 +1,128 @@
+#include "gtest/gtest.h"
+
+#include "nullable_vector.hpp"
+
+namespace
+{
+    TEST(NullableVectorTest, Access)
+    {
+        nullable_vector<int> values{1, nullopt, 3};
+        EXPECT_EQ(values.size(), 3u);
+        EXPECT_EQ(values[0], 1);
+        EXPECT_EQ(values[1], nullopt);
+        EXPECT_TRUE(values[2].has_value());
+        EXPECT_EQ(values[2].value(), 3);
+        EXPECT_THROW(values[1].value(), bad_optional_access);
+        EXPECT_EQ(values[1].value_or(7), 7);
+        EXPECT_THROW(values.at(3), std::out_of_range);
+
+        values[1] = 2;
+        EXPECT_EQ(values[1], 2);
+        values[0] = nullopt;
+        EXPECT_FALSE(values[0]);
+        values[2].reset();
+        EXPECT_EQ(values.count_valid(), 1u);
+
+        //присваивание прокси копирует элемент вместе с битом маски
+        values[0] = values[1];
+        EXPECT_EQ(values[0], 2);
+        values[1] = values[2];
+        EXPECT_EQ(values[1], nullopt);
+
+        optional<int> copy = values[0];
+        EXPECT_EQ(copy, 2);
+        values[2] = optional<int>();
+        EXPECT_FALSE(values[2]);
+        values[2].emplace(9);
+        EXPECT_EQ(*values[2], 9);
+
+        const nullable_vector<int>& view = values;
+        nullable_vector<int>::const_reference ref = view[2];
+        EXPECT_EQ(ref, 9);
+        EXPECT_EQ(view.at(1), nullopt);
+    }
+
+    TEST(NullableVectorTest, Layout)
+    {
+        nullable_vector<double> values(130);
+        EXPECT_EQ(values.null_count(), 130u);
+        values[0] = 1.0;
+        values[64] = 2.0;
+        values[129] = 3.0;
+
+        //маска в порядке Arrow: младший бит первым, буферы выровнены по 64 байтам
+        EXPECT_EQ(values.validity().word(0), 1u);
+        EXPECT_EQ(values.validity().word(1), 1u);
+        EXPECT_EQ(values.validity().word(2), 2u);
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(values.values()) % 64, 0u);
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(values.validity().data()) % 64, 0u);
+        EXPECT_EQ(values.values()[64], 2.0);
+
+        values.resize(65);
+        EXPECT_EQ(values.count_valid(), 2u);
+        values.push_back(nullopt);
+        values.push_back(4.0);
+        EXPECT_EQ(values.size(), 67u);
+        EXPECT_EQ(values[66], 4.0);
+        EXPECT_EQ(values[65], nullopt);
+
+        values.clear();
+        EXPECT_TRUE(values.empty());
+    }
+
+    TEST(NullableVectorTest, FillNull)
+    {
+        nullable_vector<int> values;
+        for(int i = 0; i < 200; ++i)
+        {
+            if(i % 3) values.push_back(i);
+            else values.push_back(nullopt);
+        }
+        values.fill_null(-1);
+        EXPECT_EQ(values.null_count(), 0u);
+        for(int i = 0; i < 200; ++i)
+            EXPECT_EQ(values[i], i % 3 ? i : -1);
+
+        //биты за пределами size() в маске остаются нулевыми
+        EXPECT_EQ(values.validity().word(3), (std::uint64_t(1) << 8) - 1);
+    }
+
+    TEST(NullableVectorTest, Reductions)
+    {
+        nullable_vector<double> empty(10);
+        EXPECT_EQ(empty.sum(), 0.0);
+        EXPECT_FALSE(empty.min());
+
+        nullable_vector<std::int32_t> values;
+        std::int64_t sum = 0;
+        std::int32_t low = std::numeric_limits<std::int32_t>::max();
+        std::int32_t high = std::numeric_limits<std::int32_t>::min();
+        for(std::int32_t i = 0; i < 1000; ++i)
+        {
+            const std::int32_t value = (i * 7919) % 2001 - 1000;
+            //полные, пустые и смешанные слова маски
+            const bool valid = i < 128 || (i >= 320 && i % 5 != 0);
+            if(!valid)
+            {
+                values.push_back(nullopt);
+                continue;
+            }
+            values.push_back(value);
+            sum += value;
+            low = std::min(low, value);
+            high = std::max(high, value);
+        }
+        //отсутствующие значения не влияют на результат
+        values[200] = std::numeric_limits<std::int32_t>::min();
+        values[200] = nullopt;
+
+        EXPECT_EQ(values.sum(), sum);
+        EXPECT_EQ(values.min(), low);
+        EXPECT_EQ(values.max(), high);
+
+        nullable_vector<float> floats(100, 0.5f);
+        floats[3] = nullopt;
+        EXPECT_EQ(floats.sum(), 49.5f);
+        EXPECT_EQ(floats.max(), 0.5f);
+    }
+}
@@ -0,0 +1,103 @@
+#include "gtest/gtest.h"
+
+#include "packed_bitmask_array.hpp"
+
+namespace
+{
+    enum class Color : unsigned char
+    {
+        Red,
+        Green,
+        Blue,
+    };
+
+    using Mask = BitMask<Color>;
+    using Array = PackedBitMaskArray<Color>;
+
+    std::vector<Mask> random_masks(std::size_t n, unsigned seed)
+    {
+        std::vector<Mask> result(n);
+        std::mt19937 random(seed);
+        for(auto& mask : result)
+            mask = Mask(static_cast<unsigned char>(random() % 8));
+        return result;
+    }
+
+    TEST(PackedBitMaskArrayTest, GetSet)
+    {
+        static_assert(Array::per_word == 21);
+
+        Array array(100);
+        EXPECT_EQ(array.size(), 100u);
+        EXPECT_EQ(array.size_in_bytes(), 5 * sizeof(std::uint64_t));
+
+        //маски на границах слов
+        array.set(20, Mask(Color::Red, Color::Blue));
+        array.set(21, Mask(Color::Green));
+        array.set(99, Mask(Color::Red, Color::Green, Color::Blue));
+
+        EXPECT_EQ(array[20], Mask(Color::Red, Color::Blue));
+        EXPECT_EQ(array[21], Mask(Color::Green));
+        EXPECT_EQ(array[99], Mask(Color::Red, Color::Green, Color::Blue));
+        EXPECT_TRUE(array[22].empty());
+
+        array.set(20, Mask(Color::Green));
+        EXPECT_EQ(array.get(20), Mask(Color::Green));
+        EXPECT_EQ(array.get(21), Mask(Color::Green));
+    }
+
+    TEST(PackedBitMaskArrayTest, CountFindMatchNaive)
+    {
+        for(std::size_t n : {0u, 1u, 20u, 21u, 22u, 1000u, 4099u})
+        {
+            const auto masks = random_masks(n, static_cast<unsigned>(n));
+            const Array array(masks.begin(), masks.end());
+            ASSERT_EQ(array.size(), n);
+
+            const auto matches = [&](const Mask& required, const Mask& excluded)
+            {
+                std::vector<std::size_t> result;
+                for(std::size_t i = 0; i < n; ++i)
+                    if(masks[i].has(required) && !Mask(masks[i] & excluded).any()) result.push_back(i);
+                return result;
+            };
+
+            const Mask red(Color::Red);
+            const Mask blue_green(Color::Blue, Color::Green);
+            for(const auto& [required, excluded] : {std::pair{red, Mask()}, std::pair{red, blue_green}, std::pair{Mask(), red},
+                                                    std::pair{blue_green, Mask()}, std::pair{Mask(), Mask()}})
+            {
+                const auto expected = matches(required, excluded);
+                EXPECT_EQ(array.count_where(required, excluded), expected.size());
+                EXPECT_EQ(array.query().has(required).has_none(excluded).rows(), expected);
+                EXPECT_EQ(array.find_where(required, excluded), expected.empty() ? n : expected.front());
+            }
+
+            std::size_t any = 0;
+            std::size_t exact = 0;
+            for(const auto& mask : masks)
+            {
+                any += mask.has(Color::Red) || mask.has(Color::Blue);
+                exact += mask == blue_green;
+            }
+            EXPECT_EQ(array.query().has_any(Color::Red, Color::Blue).count(), any);
+            EXPECT_EQ(array.query().equals(blue_green).count(), exact);
+        }
+    }
+
+    TEST(PackedBitMaskArrayTest, ResizeClearsTail)
+    {
+        Array array;
+        for(int i = 0; i < 30; ++i)
+            array.push_back(Mask(Color::Green));
+
+        array.resize(25);
+        EXPECT_EQ(array.count_where(Mask(Color::Green)), 25u);
+
+        array.resize(40);
+        EXPECT_EQ(array.count_where(Mask(Color::Green)), 25u);
+        EXPECT_EQ(array.count_where(Mask(), Mask(Color::Green)), 15u);
+        EXPECT_EQ(array.find_where(Mask(), Mask(Color::Green), 3), 25u);
+        EXPECT_EQ(array.find_where(Mask(Color::Red)), 40u);
+    }
+}
@@ -0,0 +1,92 @@
+#include "gtest/gtest.h"
+
+#include "dynamic_bitset.hpp"
+#include "parallel_bitset.hpp"
+
+namespace
+{
+    DynamicBitSet<uint64_t> random_set(std::size_t bits, unsigned seed)
+    {
+        DynamicBitSet<uint64_t> set(bits);
+        std::mt19937_64 random(seed);
+        for(std::size_t i = 0; i < bits / 3; ++i)
+            set.set(static_cast<std::size_t>(random() % bits));
+        return set;
+    }
+
+    TEST(ParallelBitsTest, ThreadPoolRunsEveryTaskOnce)
+    {
+        ThreadPool pool(4);
+        std::vector<std::atomic<int>> hits(1000);
+
+        for(int round = 0; round < 50; ++round)
+            pool.run(hits.size(), [&hits](std::size_t i) { hits[i].fetch_add(1, std::memory_order_relaxed); });
+
+        for(const auto& hit : hits)
+            EXPECT_EQ(hit.load(), 50);
+        EXPECT_EQ(pool.thread_count(), 4u);
+    }
+
+    TEST(ParallelBitsTest, ThreadPoolNestedRun)
+    {
+        ThreadPool pool(4);
+        std::vector<std::atomic<int>> hits(64 * 64);
+
+        //вложенная run() того же пула выполняется в потоке задачи и не ждёт сама себя
+        pool.run(64, [&pool, &hits](std::size_t i)
+        {
+            pool.run(64, [&hits, i](std::size_t j) { hits[i * 64 + j].fetch_add(1, std::memory_order_relaxed); });
+        });
+
+        for(const auto& hit : hits)
+            EXPECT_EQ(hit.load(), 1);
+    }
+
+    TEST(ParallelBitsTest, Count)
+    {
+        const auto set = random_set(1000003, 1);
+        ThreadPool pool(4);
+
+        //мелкие куски, чтобы задач было больше, чем потоков
+        const ParallelBits parallel(pool, 1000);
+
+        EXPECT_EQ(parallel.count(set), set.count());
+        EXPECT_EQ(ParallelBits().count(set), set.count());
+    }
+
+    TEST(ParallelBitsTest, AndOrInto)
+    {
+        const auto a = random_set(500001, 2);
+        const auto b = random_set(500001, 3);
+        DynamicBitSet<uint64_t> dest(500001);
+        ThreadPool pool(3);
+        const ParallelBits parallel(pool, 777);
+
+        parallel.and_into(dest, a, b);
+        EXPECT_EQ(dest, a & b);
+
+        parallel.or_into(dest, a, b);
+        EXPECT_EQ(dest, a | b);
+
+        DynamicBitSet<uint64_t> other(100);
+        EXPECT_THROW(parallel.and_into(other, a, b), std::invalid_argument);
+    }
+
+    TEST(ParallelBitsTest, FindNth)
+    {
+        const auto set = random_set(300007, 4);
+        ThreadPool pool(4);
+        const ParallelBits parallel(pool, 100);
+
+        std::size_t k = 0;
+        for(std::size_t index = set.find_first(); index != set.size(); index = set.find_next(index), ++k)
+        {
+            if(k % 97 == 0)
+            {
+                ASSERT_EQ(parallel.find_nth(set, k), index);
+            }
+        }
+        EXPECT_EQ(parallel.find_nth(set, k), set.size());
+        EXPECT_EQ(parallel.find_nth(DynamicBitSet<uint64_t>(64), 0), 64u);
+    }
+}
@@ -0,0 +1,93 @@
+#include "gtest/gtest.h"
+
+#include "bitset.hpp"
+#include "bitmask.hpp"
+
+namespace
+{
+    std::size_t reference_popcount(const std::vector<unsigned char>& a, const std::vector<unsigned char>* b,
+                                   std::size_t offset, std::size_t bytes)
+    {
+        std::size_t result = 0;
+        for(std::size_t i = offset; i < offset + bytes; ++i)
+            result += std::bitset<8>(b ? (a[i] & (*b)[i]) : a[i]).count();
+        return result;
+    }
+
+    TEST(PopcountTest, KernelsMatchReference)
+    {
+        std::mt19937_64 rng(42);
+        std::vector<unsigned char> a(4096 + 64);
+        std::vector<unsigned char> b(a.size());
+        for(auto& byte : a) byte = static_cast<unsigned char>(rng());
+        for(auto& byte : b) byte = static_cast<unsigned char>(rng());
+
+        const auto best = detail::popcount_best_isa();
+        for(int isa = 0; isa <= static_cast<int>(best); ++isa)
+        {
+            const auto kernels = detail::popcount_select(static_cast<detail::popcount_isa>(isa));
+            EXPECT_EQ(static_cast<int>(kernels.isa), isa);
+
+            //разные длины и невыровненные начала, чтобы пройти по всем хвостам ядер
+            for(std::size_t offset : {0u, 1u, 7u})
+                for(std::size_t bytes : {0u, 1u, 9u, 31u, 64u, 200u, 511u, 512u, 1000u, 4096u})
+                {
+                    EXPECT_EQ(kernels.count(a.data() + offset, a.data() + offset, bytes), reference_popcount(a, nullptr, offset, bytes));
+                    EXPECT_EQ(kernels.count_and(a.data() + offset, b.data() + offset, bytes), reference_popcount(a, &b, offset, bytes));
+                }
+        }
+    }
+
+    TEST(PopcountTest, BitSetArrays)
+    {
+        std::vector<BitSet<uint64_t, 130>> a(1000);
+        std::vector<BitSet<uint64_t, 130>> b(1000);
+
+        for(std::size_t i = 0; i < a.size(); ++i)
+        {
+            a[i].set(i % 130, 129u);
+            b[i].set(i % 130, 0u);
+        }
+
+        //в 7 наборах первого массива бит i % 130 == 129 совпадает со вторым битом
+        EXPECT_EQ(count(a), 1993);
+        EXPECT_EQ(count(a.data(), 10), 20);
+        EXPECT_EQ(count_and(a, b), 1000);
+        EXPECT_EQ(count(b), 1992);
+
+        std::vector<BitSet<uint64_t, 130>> c(3);
+        EXPECT_THROW(count_and(a, c), std::invalid_argument);
+
+        std::array<BitSet<uint8_t, 5>, 100> small;
+        for(auto& set : small) set = BitSet<uint8_t, 5>(0b11111u);
+        EXPECT_EQ(count(small), 500);
+    }
+
+    TEST(PopcountTest, LargeBitSetCount)
+    {
+        BitSet<uint64_t, 65536> set;
+        for(std::size_t i = 0; i < set.size(); i += 3)
+            set.set(static_cast<std::size_t>(i));
+
+        EXPECT_EQ(set.count(), (65536 + 2) / 3);
+        EXPECT_EQ((~set).count(), 65536 - (65536 + 2) / 3);
+    }
+
+    enum WideFlag : uint64_t
+    {
+        wfFirst = 0,
+        wfLast = 63,
+        wfMaxValue = 64
+    };
+
+    TEST(PopcountTest, WideBitMaskCount)
+    {
+        BitMask<WideFlag, WideFlag::wfMaxValue> mask(~0ull);
+
+        //__builtin_popcount обрезал бы значение до 32 бит
+        EXPECT_EQ(mask.count(), 64);
+
+        mask.reset(WideFlag::wfLast);
+        EXPECT_EQ(mask.count(), 63);
+    }
+}
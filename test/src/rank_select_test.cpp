@@ -0,0 +1,71 @@
+#include "gtest/gtest.h"
+
+#include "rank_select.hpp"
+#include "bitset.hpp"
+#include "dynamic_bitset.hpp"
+
+namespace
+{
+    void check_rank_select(const DynamicBitSet<>& set)
+    {
+        RankSelect index(set);
+
+        EXPECT_EQ(index.count(), set.count());
+
+        std::size_t rank = 0;
+        for(std::size_t i = 0; i < set.size(); ++i)
+        {
+            ASSERT_EQ(index.rank(i), rank) << "rank(" << i << ")";
+            if(set[i])
+            {
+                ASSERT_EQ(index.select(rank), i) << "select(" << rank << ")";
+                ++rank;
+            }
+        }
+
+        EXPECT_EQ(index.rank(set.size()), rank);
+        EXPECT_EQ(index.select(rank), set.size());
+    }
+
+    TEST(RankSelectTest, MatchesLinearScan)
+    {
+        std::mt19937_64 rng(11);
+
+        //плотный, разреженный и пустой наборы, размеры на границах блоков и суперблоков
+        for(std::size_t size : {0u, 1u, 64u, 511u, 4096u, 4097u, 70000u})
+            for(unsigned density : {0u, 1u, 50u, 100u})
+            {
+                DynamicBitSet<> set(size);
+                for(std::size_t i = 0; i < size; ++i)
+                    if(rng() % 100 < density) set.set(i);
+                check_rank_select(set);
+            }
+    }
+
+    TEST(RankSelectTest, SparseSelectSamples)
+    {
+        //единицы далеко друг от друга: выборка select указывает на далёкие суперблоки
+        DynamicBitSet<> set(1 << 22);
+        for(std::size_t i = 5; i < set.size(); i += 997)
+            set.set(i);
+
+        RankSelect index(set);
+        for(std::size_t k = 0; k < index.count(); ++k)
+            ASSERT_EQ(index.select(k), 5 + k * 997);
+
+        //каталог занимает несколько процентов от набора
+        EXPECT_LT(index.size_in_bytes() * 100, set.size() / 8 * 6);
+    }
+
+    TEST(RankSelectTest, BitSetStorage)
+    {
+        BitSet<uint64_t, 1000> set;
+        set.set(0u, 100u, 999u);
+
+        RankSelect index(set);
+
+        EXPECT_EQ(index.rank(100), 1);
+        EXPECT_EQ(index.rank(101), 2);
+        EXPECT_EQ(index.select(2), 999);
+    }
+}
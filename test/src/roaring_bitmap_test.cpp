@@ -0,0 +1,127 @@
+#include "gtest/gtest.h"
+
+#include "roaring_bitmap.hpp"
+
+namespace
+{
+    std::vector<uint32_t> values_of(const RoaringBitmap& bitmap)
+    {
+        std::vector<uint32_t> values;
+        bitmap.for_each([&values](uint32_t value) { values.push_back(value); });
+        return values;
+    }
+
+    TEST(RoaringBitmapTest, AddRemoveContains)
+    {
+        RoaringBitmap bitmap{1, 70000, 4000000000u};
+
+        EXPECT_EQ(bitmap.count(), 3);
+        EXPECT_TRUE(bitmap.contains(70000));
+        EXPECT_FALSE(bitmap.contains(2));
+        EXPECT_FALSE(bitmap.add(1));
+        EXPECT_TRUE(bitmap.remove(70000));
+        EXPECT_FALSE(bitmap.remove(70000));
+        EXPECT_EQ(values_of(bitmap), (std::vector<uint32_t>{1, 4000000000u}));
+    }
+
+    TEST(RoaringBitmapTest, ArrayToBitmapAndBack)
+    {
+        RoaringBitmap bitmap;
+
+        //5000 значений в одном блоке - контейнер переходит в bitmap
+        for(uint32_t i = 0; i < 10000; i += 2)
+            bitmap.add(i);
+
+        EXPECT_EQ(bitmap.count(), 5000);
+        EXPECT_TRUE(bitmap.contains(9998));
+        EXPECT_FALSE(bitmap.contains(9999));
+
+        for(uint32_t i = 0; i < 2000; i += 2)
+            bitmap.remove(i);
+
+        EXPECT_EQ(bitmap.count(), 4000);
+        EXPECT_FALSE(bitmap.contains(0));
+        EXPECT_TRUE(bitmap.contains(2000));
+    }
+
+    TEST(RoaringBitmapTest, RunOptimize)
+    {
+        RoaringBitmap bitmap;
+
+        for(uint32_t i = 100; i < 60000; ++i)
+            bitmap.add(i);
+
+        const std::size_t dense_bytes = bitmap.size_in_bytes();
+
+        bitmap.run_optimize();
+
+        EXPECT_LT(bitmap.size_in_bytes(), dense_bytes);
+        EXPECT_EQ(bitmap.count(), 59900);
+
+        //добавление и удаление в run-контейнере
+        EXPECT_TRUE(bitmap.remove(3000));
+        EXPECT_FALSE(bitmap.contains(3000));
+        EXPECT_TRUE(bitmap.add(3000));
+        EXPECT_TRUE(bitmap.add(99));
+        EXPECT_TRUE(bitmap.contains(99));
+        EXPECT_EQ(bitmap.count(), 59901);
+    }
+
+    TEST(RoaringBitmapTest, SetOperations)
+    {
+        RoaringBitmap a;
+        RoaringBitmap b;
+        std::set<uint32_t> ref_a;
+        std::set<uint32_t> ref_b;
+
+        std::mt19937 rng(42);
+        //разреженный блок, плотный блок и блок из серий
+        for(int i = 0; i < 2000; ++i) { uint32_t v = rng() % 65536; a.add(v); ref_a.insert(v); }
+        for(int i = 0; i < 30000; ++i) { uint32_t v = 65536 + rng() % 65536; a.add(v); ref_a.insert(v); }
+        for(uint32_t v = 131072; v < 140000; ++v) { a.add(v); ref_a.insert(v); }
+        for(int i = 0; i < 20000; ++i) { uint32_t v = rng() % 200000; b.add(v); ref_b.insert(v); }
+        for(uint32_t v = 135000; v < 150000; ++v) { b.add(v); ref_b.insert(v); }
+
+        a.run_optimize();
+        b.run_optimize();
+
+        std::vector<uint32_t> expected;
+
+        std::set_union(ref_a.begin(), ref_a.end(), ref_b.begin(), ref_b.end(), std::back_inserter(expected));
+        EXPECT_EQ(values_of(a | b), expected);
+        EXPECT_EQ(or_count(a, b), expected.size());
+
+        expected.clear();
+        std::set_intersection(ref_a.begin(), ref_a.end(), ref_b.begin(), ref_b.end(), std::back_inserter(expected));
+        EXPECT_EQ(values_of(a & b), expected);
+        EXPECT_EQ(and_count(a, b), expected.size());
+
+        expected.clear();
+        std::set_difference(ref_a.begin(), ref_a.end(), ref_b.begin(), ref_b.end(), std::back_inserter(expected));
+        RoaringBitmap diff(a);
+        diff.and_not(b);
+        EXPECT_EQ(values_of(diff), expected);
+        EXPECT_EQ(and_not_count(a, b), expected.size());
+    }
+
+    TEST(RoaringBitmapTest, Equality)
+    {
+        RoaringBitmap a;
+        RoaringBitmap b;
+
+        for(uint32_t v = 0; v < 5000; ++v)
+        {
+            a.add(v);
+            b.add(v);
+        }
+
+        b.run_optimize();
+
+        //одинаковое содержимое в разных видах контейнеров
+        EXPECT_EQ(a, b);
+
+        b.remove(10);
+
+        EXPECT_NE(a, b);
+    }
+}
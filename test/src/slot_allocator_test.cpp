@@ -0,0 +1,123 @@
+#include "gtest/gtest.h"
+
+#include <thread>
+#include "slot_allocator.hpp"
+
+namespace
+{
+    TEST(SlotAllocatorTest, AcquireRelease)
+    {
+        SlotAllocator<130> slots;
+        std::set<std::size_t> ids;
+
+        //лишние биты последнего слова не выдаются
+        for(std::size_t i = 0; i < 130; ++i)
+        {
+            const std::size_t id = slots.acquire();
+            ASSERT_LT(id, 130u);
+            EXPECT_TRUE(ids.insert(id).second);
+        }
+        EXPECT_EQ(slots.acquire(), slots.capacity());
+        EXPECT_EQ(slots.count(), 130u);
+
+        slots.release(77);
+
+        EXPECT_FALSE(slots.in_use(77));
+        EXPECT_EQ(slots.acquire(), 77u);
+        EXPECT_EQ(slots.acquire(), 130u);
+    }
+
+    TEST(SlotAllocatorTest, TryAcquire)
+    {
+        SlotAllocator<64, false, false> slots;
+
+        EXPECT_TRUE(slots.try_acquire(10));
+        EXPECT_FALSE(slots.try_acquire(10));
+        EXPECT_TRUE(slots.in_use(10));
+
+        slots.release(10);
+
+        EXPECT_TRUE(slots.try_acquire(10));
+        EXPECT_EQ(slots.count(), 1u);
+    }
+
+    TEST(SlotAllocatorTest, SummarySkipsFullWords)
+    {
+        SlotAllocator<64 * 100> slots;
+
+        for(std::size_t i = 0; i < 64 * 99; ++i)
+            ASSERT_TRUE(slots.try_acquire(i));
+
+        //свободно только последнее слово
+        EXPECT_GE(slots.acquire(), 64u * 99);
+
+        slots.release(5);
+
+        EXPECT_EQ(slots.try_acquire(5), true);
+        for(std::size_t i = 1; i < 64; ++i)
+            EXPECT_GE(slots.acquire(), 64u * 99);
+        EXPECT_EQ(slots.acquire(), slots.capacity());
+    }
+
+    TEST(SlotAllocatorTest, SummaryStartsAtThreadHint)
+    {
+        //одно слово сводки на 40 слов карты: поиск начинается со слова подсказки потока, а не с первого незаполненного
+        using Slots = SlotAllocator<64 * 40>;
+        Slots slots;
+
+        //в новом потоке подсказка ещё не сдвинута предыдущими тестами
+        std::thread([&slots]
+        {
+            const std::size_t hint = std::hash<std::thread::id>()(std::this_thread::get_id()) % Slots::word_count;
+            EXPECT_EQ(slots.acquire() / Slots::word_bits, hint);
+        }).join();
+    }
+
+    template<typename Slots>
+    void concurrent_acquire_release(Slots& slots)
+    {
+        constexpr std::size_t threads_count = 8;
+        std::vector<std::atomic<int>> owners(slots.capacity());
+        std::atomic<bool> failed{false};
+
+        //слот не должен одновременно принадлежать двум потокам
+        std::vector<std::thread> threads;
+        for(std::size_t t = 0; t < threads_count; ++t)
+        {
+            threads.emplace_back([&]
+            {
+                std::vector<std::size_t> held;
+                for(std::size_t round = 0; round < 2000; ++round)
+                {
+                    for(std::size_t i = 0; i < 16; ++i)
+                    {
+                        const std::size_t id = slots.acquire();
+                        if(id == slots.capacity() || owners[id].fetch_add(1) != 0) failed = true;
+                        else held.push_back(id);
+                    }
+                    for(std::size_t id : held)
+                    {
+                        owners[id].fetch_sub(1);
+                        slots.release(id);
+                    }
+                    held.clear();
+                }
+            });
+        }
+        for(auto& thread : threads)
+            thread.join();
+
+        EXPECT_FALSE(failed);
+        EXPECT_EQ(slots.count(), 0u);
+    }
+
+    TEST(SlotAllocatorTest, ConcurrentAcquireRelease)
+    {
+        //слотов ровно столько, сколько держат все потоки: гонки за последние свободные биты
+        SlotAllocator<128> slots;
+        concurrent_acquire_release(slots);
+
+        SlotAllocator<128, false, false> plain;
+        concurrent_acquire_release(plain);
+    }
+}
@@ -0,0 +1,182 @@
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <set>
+#include <string>
+#include "optional.hpp"
+#include "small_vector.hpp"
+
+namespace
+{
+    struct Handle
+    {
+        using trivially_relocatable = std::true_type;
+
+        explicit Handle(int value) : value(std::make_unique<int>(value)) {}
+
+        std::unique_ptr<int> value;
+    };
+
+    struct SelfPointer
+    {
+        SelfPointer() : self(this) {}
+        SelfPointer(const SelfPointer&) : self(this) {}
+        SelfPointer& operator=(const SelfPointer&) { return *this; }
+
+        SelfPointer* self;
+    };
+
+    //некопируемый тип с бросающим перемещением, помнит адреса живых объектов
+    struct ThrowingMoveOnly
+    {
+        static inline std::set<const ThrowingMoveOnly*> alive;
+        static inline int moves_left = -1;
+
+        explicit ThrowingMoveOnly(int value) : value(value)
+        {
+            alive.insert(this);
+        }
+
+        ThrowingMoveOnly(ThrowingMoveOnly&& other) : value(other.value)
+        {
+            if(moves_left == 0) throw std::runtime_error("move");
+            --moves_left;
+            alive.insert(this);
+        }
+
+        ThrowingMoveOnly(const ThrowingMoveOnly&) = delete;
+
+        ~ThrowingMoveOnly()
+        {
+            alive.erase(this);
+        }
+
+        int value;
+    };
+
+    static_assert(is_trivially_relocatable_v<int>);
+    static_assert(is_trivially_relocatable_v<std::unique_ptr<int>>);
+    static_assert(is_trivially_relocatable_v<std::vector<std::string>>);
+    static_assert(is_trivially_relocatable_v<Handle>);
+    static_assert(!is_trivially_relocatable_v<SelfPointer>);
+    static_assert(!is_trivially_relocatable_v<std::string>);
+
+    //optional наследует свойство от T
+    static_assert(is_trivially_relocatable_v<optional<std::unique_ptr<int>>>);
+    static_assert(is_trivially_relocatable_v<optional<Handle>>);
+    static_assert(!is_trivially_relocatable_v<optional<std::string>>);
+
+    TEST(SmallVectorTest, InlineThenHeap)
+    {
+        small_vector<int, 4> values;
+        for(int i = 0; i < 4; ++i)
+            values.push_back(i);
+        EXPECT_TRUE(values.is_inline());
+
+        values.push_back(4);
+        EXPECT_FALSE(values.is_inline());
+        EXPECT_EQ(values.size(), 5u);
+        EXPECT_EQ(std::vector<int>(values.begin(), values.end()), (std::vector<int>{0, 1, 2, 3, 4}));
+
+        //элемент самого вектора как аргумент при росте
+        values.resize(8);
+        values.push_back(values[1]);
+        EXPECT_EQ(values.back(), 1);
+        EXPECT_THROW(values.at(9), std::out_of_range);
+    }
+
+    TEST(SmallVectorTest, ResizeGrowsGeometrically)
+    {
+        small_vector<int, 2> values;
+        std::size_t reallocations = 0;
+        for(std::size_t i = 1; i <= 1000; ++i)
+        {
+            const int* data = values.data();
+            values.resize(i);
+            reallocations += values.data() != data;
+        }
+        EXPECT_LE(reallocations, 10u);
+    }
+
+    TEST(SmallVectorTest, ThrowingMoveKeepsElements)
+    {
+        using Vector = small_vector<ThrowingMoveOnly, 4>;
+        {
+            Vector values;
+            for(int i = 0; i < 4; ++i)
+                values.emplace_back(i);
+
+            //рост бросает на третьем перемещении: в векторе остаются прежние четыре живых элемента
+            ThrowingMoveOnly::moves_left = 2;
+            EXPECT_THROW(values.emplace_back(4), std::runtime_error);
+            ThrowingMoveOnly::moves_left = -1;
+            ASSERT_EQ(values.size(), 4u);
+            EXPECT_EQ(ThrowingMoveOnly::alive.size(), 4u);
+            for(int i = 0; i < 4; ++i)
+            {
+                ASSERT_TRUE(ThrowingMoveOnly::alive.count(&values[i]));
+                EXPECT_EQ(values[i].value, i);
+            }
+
+            //то же при перемещении вектора со встроенным буфером
+            ThrowingMoveOnly::moves_left = 1;
+            EXPECT_THROW(Vector(std::move(values)), std::runtime_error);
+            ThrowingMoveOnly::moves_left = -1;
+            ASSERT_EQ(values.size(), 4u);
+            for(int i = 0; i < 4; ++i)
+                ASSERT_TRUE(ThrowingMoveOnly::alive.count(&values[i]));
+        }
+        EXPECT_TRUE(ThrowingMoveOnly::alive.empty());
+    }
+
+    TEST(SmallVectorTest, RelocatesOptionals)
+    {
+        small_vector<optional<std::unique_ptr<int>>, 2> values;
+        for(int i = 0; i < 100; ++i)
+        {
+            if(i % 3) values.emplace_back(std::make_unique<int>(i));
+            else values.emplace_back();
+        }
+
+        ASSERT_EQ(values.size(), 100u);
+        for(int i = 0; i < 100; ++i)
+        {
+            ASSERT_EQ(values[i].has_value(), i % 3 != 0);
+            if(values[i])
+            {
+                EXPECT_EQ(**values[i], i);
+            }
+        }
+
+        small_vector<optional<std::unique_ptr<int>>, 2> moved(std::move(values));
+        EXPECT_TRUE(values.empty());
+        EXPECT_EQ(**moved[1], 1);
+    }
+
+    TEST(SmallVectorTest, NonRelocatable)
+    {
+        small_vector<SelfPointer, 2> values;
+        for(int i = 0; i < 10; ++i)
+            values.emplace_back();
+        for(const auto& value : values)
+            EXPECT_EQ(value.self, &value);
+
+        small_vector<std::string, 2> strings{"a", "bb", "a string longer than the small string buffer"};
+        small_vector<std::string, 2> copy;
+        copy = strings;
+        copy.push_back("d");
+        EXPECT_EQ(copy[2], strings[2]);
+        EXPECT_EQ(copy.size(), 4u);
+        copy.pop_back();
+        copy = std::move(strings);
+        EXPECT_EQ(copy[1], "bb");
+
+        std::string buffer[2] = {"x", "y"};
+        alignas(std::string) unsigned char raw[2 * sizeof(std::string)];
+        std::string* moved = relocate(buffer, buffer + 1, reinterpret_cast<std::string*>(raw));
+        EXPECT_EQ(moved, reinterpret_cast<std::string*>(raw) + 1);
+        EXPECT_EQ(*reinterpret_cast<std::string*>(raw), "x");
+        std::destroy_at(reinterpret_cast<std::string*>(raw));
+        ::new(static_cast<void*>(buffer)) std::string();
+    }
+}
@@ -0,0 +1,109 @@
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <string>
+#include "optional.hpp"
+
+namespace
+{
+    struct Trivial
+    {
+        int a;
+        double b;
+    };
+
+    struct CopyOnly
+    {
+        CopyOnly() = default;
+        CopyOnly(const CopyOnly&) {}
+        CopyOnly& operator=(const CopyOnly&) { return *this; }
+    };
+
+    struct NoAssign
+    {
+        NoAssign() = default;
+        NoAssign(const NoAssign&) = default;
+        NoAssign& operator=(const NoAssign&) = delete;
+    };
+
+    //optional тривиален ровно тогда, когда тривиален T
+    template<typename T>
+    constexpr bool same_triviality =
+        std::is_trivially_copyable<optional<T>>::value == std::is_trivially_copyable<T>::value &&
+        std::is_trivially_copy_constructible<optional<T>>::value == std::is_trivially_copy_constructible<T>::value &&
+        std::is_trivially_move_constructible<optional<T>>::value == std::is_trivially_move_constructible<T>::value &&
+        std::is_trivially_destructible<optional<T>>::value == std::is_trivially_destructible<T>::value;
+
+    static_assert(same_triviality<int>);
+    static_assert(same_triviality<double>);
+    static_assert(same_triviality<int*>);
+    static_assert(same_triviality<Trivial>);
+    static_assert(same_triviality<std::string>);
+    static_assert(same_triviality<std::unique_ptr<int>>);
+    static_assert(same_triviality<CopyOnly>);
+
+    static_assert(std::is_trivially_copyable<optional<int>>::value);
+    static_assert(std::is_trivially_copy_assignable<optional<int>>::value);
+    static_assert(std::is_trivially_move_assignable<optional<Trivial>>::value);
+    static_assert(!std::is_trivially_copyable<optional<std::string>>::value);
+    static_assert(!std::is_trivially_destructible<optional<std::string>>::value);
+    static_assert(sizeof(optional<int>) == 2 * sizeof(int));
+
+    //специальных функций, которых нет у T, нет и у optional
+    static_assert(!std::is_copy_constructible<optional<std::unique_ptr<int>>>::value);
+    static_assert(std::is_move_constructible<optional<std::unique_ptr<int>>>::value);
+    static_assert(std::is_nothrow_move_constructible<optional<std::unique_ptr<int>>>::value);
+    static_assert(!std::is_copy_assignable<optional<std::unique_ptr<int>>>::value);
+    static_assert(std::is_move_assignable<optional<std::unique_ptr<int>>>::value);
+    static_assert(std::is_copy_constructible<optional<NoAssign>>::value);
+    static_assert(!std::is_copy_assignable<optional<NoAssign>>::value);
+
+    TEST(OptionalTraitsTest, NonTrivialCopyMove)
+    {
+        optional<std::string> a(std::string("value"));
+        optional<std::string> b(a);
+        EXPECT_EQ(*b, "value");
+
+        optional<std::string> c(std::move(b));
+        EXPECT_EQ(*c, "value");
+
+        optional<std::string> empty;
+        c = empty;
+        EXPECT_FALSE(c);
+        c = a;
+        EXPECT_EQ(c, a);
+
+        optional<std::unique_ptr<int>> p(std::make_unique<int>(5));
+        optional<std::unique_ptr<int>> q;
+        q = std::move(p);
+        EXPECT_EQ(**q, 5);
+        q.reset();
+        EXPECT_FALSE(q);
+
+        optional<long> wide(optional<int>(3));
+        EXPECT_EQ(*wide, 3);
+        wide = optional<int>();
+        EXPECT_FALSE(wide);
+    }
+
+    TEST(OptionalTraitsTest, Comparisons)
+    {
+        const optional<int> empty;
+        const optional<int> one(1);
+        const optional<int> two(2);
+
+        EXPECT_TRUE(empty < one);
+        EXPECT_TRUE(one < two);
+        EXPECT_TRUE(empty <= empty);
+        EXPECT_TRUE(two >= one);
+        EXPECT_TRUE(one >= empty);
+        EXPECT_FALSE(empty > one);
+        EXPECT_TRUE(nullopt <= one);
+        EXPECT_FALSE(nullopt > one);
+        EXPECT_TRUE(one == 1);
+        EXPECT_TRUE(0 < one);
+        EXPECT_FALSE(0 < empty);
+        EXPECT_FALSE(empty > 0);
+        EXPECT_TRUE(empty != 0);
+    }
+}